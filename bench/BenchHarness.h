@@ -0,0 +1,203 @@
+/*
+ * BenchHarness.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Measurement loop shared by the bench programs. A case is a function running its
+ *  operation a given number of times. bhRun() sizes that number so one repetition
+ *  takes at least -minRepMs, runs -warmup repetitions that are thrown away, then
+ *  -reps timed ones, and prints their median and median absolute deviation (MAD)
+ *  as one JSON object per line on stdout:
+ *
+ *    {"bench":"rotateBench","case":"pkRotate180Rgbx","param":"1920x1080","os":"linux","arch":"x86_64",
+ *     "variant":"avx2","reps":15,"iterations":52,"median_ns":385012.1,"mad_ns":1450.3,"items":2073600,
+ *     "median_ns_per_item":0.1857}
+ *
+ *  median_ns and mad_ns are per operation; items is what one operation processes
+ *  (pixels, glyphs, messages). Results that are checked against a reference print a
+ *  MISMATCH line on stderr and make bhFinish() return -1.
+ *
+ *  Header only, as every bench source builds into a program of its own; the functions
+ *  are static inline so that a bench not using one of them builds without warnings.
+ */
+
+#ifndef BENCH_BENCHHARNESS_H_
+#define BENCH_BENCHHARNESS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "PixKernels.h"
+
+#define BH_WARMUP_REPS      3
+#define BH_REPS             15
+#define BH_MIN_REP_MS       20
+#define BH_MAX_REPS         1000
+#define BH_MAX_ITERATIONS   100000000L    /* An operation the compiler removed stays at 0 ns instead of looping for good */
+
+#if defined(__QNX__)
+ #define BH_OS              "qnx"
+#else
+ #define BH_OS              "linux"
+#endif
+#if defined(__aarch64__)
+ #define BH_ARCH            "aarch64"
+#elif defined(__arm__)
+ #define BH_ARCH            "arm"
+#elif defined(__x86_64__)
+ #define BH_ARCH            "x86_64"
+#elif defined(__i386__)
+ #define BH_ARCH            "x86"
+#else
+ #define BH_ARCH            "unknown"
+#endif
+
+/* Runs the operation of a case iterations times */
+typedef void (*bhCaseFn)(void *arg, long iterations);
+
+static struct {
+    const char *bench;
+    int warmup;
+    int reps;
+    uint64_t minRepNs;
+    int mismatches;
+    FILE *out;
+    double samples[BH_MAX_REPS];
+} bh;
+
+static inline uint64_t bhNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Value of a "name=value" argument, NULL if it was not passed
+static inline const char *bhArg(int argc, char *argv[], const char *name) {
+    size_t length = strlen(name);
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strncmp(argv[i], name, length) == 0) && (argv[i][length] == '=')) {
+            return argv[i] + length + 1;
+        }
+    }
+    return NULL;
+}
+
+// Takes -reps=, -warmup= and -minRepMs= off the command line. Results go to a duplicate of stdout,
+// so a bench may point stdout elsewhere while it runs.
+static inline void bhInit(const char *bench, int argc, char *argv[]) {
+    const char *value;
+    int fd;
+
+    bh.bench = bench;
+    bh.warmup = BH_WARMUP_REPS;
+    bh.reps = BH_REPS;
+    bh.minRepNs = (uint64_t)BH_MIN_REP_MS * 1000000u;
+    if ((value = bhArg(argc, argv, "-reps")) != NULL) {
+        bh.reps = atoi(value);
+    }
+    if ((value = bhArg(argc, argv, "-warmup")) != NULL) {
+        bh.warmup = atoi(value);
+    }
+    if ((value = bhArg(argc, argv, "-minRepMs")) != NULL) {
+        bh.minRepNs = (uint64_t)atoi(value) * 1000000u;
+    }
+    if ((bh.reps < 1) || (bh.reps > BH_MAX_REPS)) {
+        bh.reps = BH_REPS;
+    }
+    if (bh.warmup < 0) {
+        bh.warmup = BH_WARMUP_REPS;
+    }
+
+    fd = dup(STDOUT_FILENO);
+    bh.out = (fd >= 0) ? fdopen(fd, "w") : NULL;
+    if (bh.out == NULL) {
+        bh.out = stdout;
+    }
+}
+
+static inline int bhCompareDouble(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+// Median of the count values, which get sorted
+static inline double bhMedian(double *values, int count) {
+    qsort(values, count, sizeof(double), bhCompareDouble);
+    return (count % 2) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2;
+}
+
+static inline uint64_t bhTime(bhCaseFn fn, void *arg, long iterations) {
+    uint64_t start = bhNowNs();
+
+    fn(arg, iterations);
+    return bhNowNs() - start;
+}
+
+// Prints the median and MAD of count samples in ns per operation, for cases that time themselves. Sorts and
+// overwrites samples. iterations is how many operations each sample covers.
+static inline void bhReport(const char *caseName, const char *param, double *samples, int count, long iterations, double items) {
+    double median, mad;
+    int i;
+
+    median = bhMedian(samples, count);
+    for (i = 0; i < count; i++) {
+        samples[i] = (samples[i] > median) ? samples[i] - median : median - samples[i];
+    }
+    mad = bhMedian(samples, count);
+
+    fprintf(bh.out, "{\"bench\":\"%s\",\"case\":\"%s\",\"param\":\"%s\",\"os\":\"%s\",\"arch\":\"%s\",\"variant\":\"%s\","
+                    "\"reps\":%d,\"iterations\":%ld,\"median_ns\":%.1f,\"mad_ns\":%.1f,\"items\":%.0f,\"median_ns_per_item\":%.4f}\n",
+            bh.bench, caseName, param, BH_OS, BH_ARCH, pkKernelVariant(),
+            count, iterations, median, mad, items, (items > 0) ? median / items : 0.0);
+    fflush(bh.out);
+}
+
+// Measures a case. items is what one operation processes, for the per item figure.
+static inline void bhRun(const char *caseName, const char *param, bhCaseFn fn, void *arg, double items) {
+    uint64_t elapsed;
+    long iterations = 1;
+    int rep;
+
+    // Grow the iteration count until a repetition is long enough to time; this also warms caches and clocks
+    elapsed = bhTime(fn, arg, iterations);
+    while ((elapsed < bh.minRepNs) && (iterations < BH_MAX_ITERATIONS)) {
+        if (elapsed * 100 < bh.minRepNs) {
+            iterations = (iterations < BH_MAX_ITERATIONS / 100) ? iterations * 100 : BH_MAX_ITERATIONS;
+        } else {
+            iterations = (long)((double)iterations * bh.minRepNs / elapsed * 1.1) + 1;
+        }
+        elapsed = bhTime(fn, arg, iterations);
+    }
+    for (rep = 0; rep < bh.warmup; rep++) {
+        bhTime(fn, arg, iterations);
+    }
+    for (rep = 0; rep < bh.reps; rep++) {
+        bh.samples[rep] = (double)bhTime(fn, arg, iterations) / iterations;
+    }
+    bhReport(caseName, param, bh.samples, bh.reps, iterations, items);
+}
+
+// Records the result of a correctness check
+static inline void bhCheck(const char *caseName, const char *param, int ok) {
+    if (!ok) {
+        fprintf(stderr, "%s: %s %s: MISMATCH\n", bh.bench, caseName, param);
+        bh.mismatches++;
+    }
+}
+
+// Exit code of the bench: -1 if a check failed
+static inline int bhFinish(void) {
+    fflush(bh.out);
+    return (bh.mismatches > 0) ? -1 : 0;
+}
+
+#endif /* BENCH_BENCHHARNESS_H_ */
@@ -0,0 +1,85 @@
+/*
+ * formatBench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Pixel format paths: pfConvertImage() from every format a decoder can produce into
+ *  the two display formats, as an image is converted once into the window format after
+ *  decoding. Which kernel runs follows from the source format and its bytes per pixel,
+ *  what getBytesPerPixel() reads off a QNX img_t. Output as described in BenchHarness.h;
+ *  items are pixels. Build with BUILD_PROFILE=release.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "PixFormat.h"
+#include "BenchHarness.h"
+
+#define IMG_WIDTH    1280
+#define IMG_HEIGHT   720
+
+typedef struct {
+    const uint8_t *src;
+    ePixFormats srcFmt;
+    void *dst;
+    ePixFormats dstFmt;
+    const uint32_t *palette;
+} formatCase;
+
+static void caseConvert(void *arg, long iterations) {
+    formatCase *pCase = (formatCase *)arg;
+
+    while (iterations-- > 0) {
+        pfConvertImage(pCase->dst, pfRowBytes(pCase->dstFmt, IMG_WIDTH), pCase->dstFmt,
+                       pCase->src, pfRowBytes(pCase->srcFmt, IMG_WIDTH), pCase->srcFmt, IMG_WIDTH, IMG_HEIGHT, pCase->palette);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    static const ePixFormats dstFormats[] = { ePixFmt_XRGB8888, ePixFmt_RGB565 };
+    size_t srcSize = (size_t)IMG_WIDTH * IMG_HEIGHT * 4;
+    uint32_t palette[256];
+    uint8_t *src = malloc(srcSize);
+    void *dst = malloc((size_t)IMG_WIDTH * IMG_HEIGHT * 4);
+    formatCase fmtCase;
+    char param[64];
+    unsigned int d;
+    int fmt;
+    size_t i;
+
+    if ((src == NULL) || (dst == NULL)) {
+        fprintf(stderr, "Buffer allocation failed\n");
+        return -1;
+    }
+    bhInit("formatBench", argc, argv);
+
+    for (i = 0; i < srcSize; i++) {
+        src[i] = (uint8_t)rand();
+    }
+    for (i = 0; i < 256; i++) {
+        palette[i] = ((uint32_t)rand() << 8) ^ (uint32_t)rand();
+    }
+
+    fmtCase.src = src;
+    fmtCase.dst = dst;
+    for (d = 0; d < sizeof(dstFormats) / sizeof(dstFormats[0]); d++) {
+        fmtCase.dstFmt = dstFormats[d];
+        for (fmt = ePixFmt_INVALID + 1; fmt < ePixFmt_COUNT; fmt++) {
+            fmtCase.srcFmt = (ePixFormats)fmt;
+            fmtCase.palette = ((fmt == ePixFmt_PAL8) || (fmt == ePixFmt_PAL4) || (fmt == ePixFmt_PAL1)) ? palette : NULL;
+            if (pfConvertRow(dst, fmtCase.dstFmt, src, fmtCase.srcFmt, 1, fmtCase.palette) != 0) {
+                continue;   //Pair not converted
+            }
+            snprintf(param, sizeof(param), "%s->%s %dbpp", pfFormatName(fmtCase.srcFmt), pfFormatName(fmtCase.dstFmt), pfBitsPerPixel(fmtCase.srcFmt));
+            bhRun("pfConvertImage", param, caseConvert, &fmtCase, (double)IMG_WIDTH * IMG_HEIGHT);
+        }
+    }
+
+    free(src);
+    free(dst);
+    return bhFinish();
+}
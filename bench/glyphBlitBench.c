@@ -0,0 +1,141 @@
+/*
+ * glyphBlitBench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Glyph compositing: the original per-pixel draw_bitmap() loop against the row
+ *  oriented pkCoverageToRgbx() kernel it now uses, and the pkBlendCoverageRgbx()
+ *  kernel of -textMode=BLEND. Output as described in BenchHarness.h; items are
+ *  glyph pixels. draw_bitmap() within ftRender() is timed by textBench.
+ *  Build with BUILD_PROFILE=release.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "PixKernels.h"
+#include "BenchHarness.h"
+
+#define BUF_WIDTH    1280
+#define BUF_HEIGHT   64
+#define BPP          4
+
+typedef struct {
+    int width;
+    int rows;
+    unsigned char *buffer;
+} benchGlyph;
+
+typedef struct {
+    benchGlyph glyph;
+    unsigned char *buf;
+} glyphCase;
+
+// The per-pixel loop as draw_bitmap() had it: index math and 3 source reads per pixel.
+static void legacyBlit(const benchGlyph *glyph, unsigned char *buf, int dest_x, int dest_y) {
+    int x, y;
+    int rgbaVal;
+
+    for (y = 0; y < glyph->rows; y++) {
+        for (x = 0; x < glyph->width; x++) {
+            rgbaVal = 0xff << 24 | glyph->buffer[y*(glyph->width) + x] | glyph->buffer[y*(glyph->width) + x] << 8 | glyph->buffer[y*(glyph->width) + x] << 16;
+            *(int *)&buf[((dest_y + y) * BUF_WIDTH * BPP) + ((dest_x + x) * BPP)] = rgbaVal;
+        }
+    }
+}
+
+static void kernelBlit(const benchGlyph *glyph, unsigned char *buf, int stride, int dest_x, int dest_y) {
+    unsigned char *pDestRow = buf + dest_y * stride + dest_x * BPP;
+    const unsigned char *pSrcRow = glyph->buffer;
+    int y;
+
+    for (y = 0; y < glyph->rows; y++) {
+        pkCoverageToRgbx((uint32_t *)pDestRow, pSrcRow, glyph->width);
+        pDestRow += stride;
+        pSrcRow += glyph->width;
+    }
+}
+
+// Blends the glyph over the buffer as draw_bitmap() does in fr_Compose_Blend mode
+static void blendBlit(const benchGlyph *glyph, unsigned char *buf, int stride, int dest_x, int dest_y) {
+    unsigned char *pDestRow = buf + dest_y * stride + dest_x * BPP;
+    const unsigned char *pSrcRow = glyph->buffer;
+    int y;
+
+    for (y = 0; y < glyph->rows; y++) {
+        pkBlendCoverageRgbx((uint32_t *)pDestRow, pSrcRow, glyph->width, 0x00ffc040);
+        pDestRow += stride;
+        pSrcRow += glyph->width;
+    }
+}
+
+// Glyphs go along the buffer like the characters of a line
+static void caseLegacy(void *arg, long iterations) {
+    glyphCase *pCase = (glyphCase *)arg;
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        legacyBlit(&(pCase->glyph), pCase->buf, (int)((i * pCase->glyph.width) % (BUF_WIDTH - pCase->glyph.width)), 0);
+    }
+}
+
+static void caseKernel(void *arg, long iterations) {
+    glyphCase *pCase = (glyphCase *)arg;
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        kernelBlit(&(pCase->glyph), pCase->buf, BUF_WIDTH * BPP, (int)((i * pCase->glyph.width) % (BUF_WIDTH - pCase->glyph.width)), 0);
+    }
+}
+
+static void caseBlend(void *arg, long iterations) {
+    glyphCase *pCase = (glyphCase *)arg;
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        blendBlit(&(pCase->glyph), pCase->buf, BUF_WIDTH * BPP, (int)((i * pCase->glyph.width) % (BUF_WIDTH - pCase->glyph.width)), 0);
+    }
+}
+
+static void runSize(int glyphWidth, int glyphRows, unsigned char *buf) {
+    glyphCase glCase;
+    double pixels = (double)glyphWidth * glyphRows;
+    char param[32];
+    int i;
+
+    glCase.buf = buf;
+    glCase.glyph.width = glyphWidth;
+    glCase.glyph.rows = glyphRows;
+    glCase.glyph.buffer = malloc(glyphWidth * glyphRows);
+    for (i = 0; i < glyphWidth * glyphRows; i++) {
+        glCase.glyph.buffer[i] = (unsigned char)rand();
+    }
+    snprintf(param, sizeof(param), "%dx%d", glyphWidth, glyphRows);
+
+    bhRun("legacyBlit", param, caseLegacy, &glCase, pixels);
+    bhRun("pkCoverageToRgbx", param, caseKernel, &glCase, pixels);
+    bhRun("pkBlendCoverageRgbx", param, caseBlend, &glCase, pixels);
+
+    free(glCase.glyph.buffer);
+}
+
+int main(int argc, char *argv[]) {
+    unsigned char *buf = calloc(BUF_WIDTH * BUF_HEIGHT, BPP);
+
+    if (buf == NULL) {
+        fprintf(stderr, "Buffer allocation failed\n");
+        return -1;
+    }
+    bhInit("glyphBlitBench", argc, argv);
+
+    runSize(8, 12, buf);
+    runSize(16, 20, buf);
+    runSize(24, 32, buf);
+    runSize(48, 60, buf);
+
+    free(buf);
+    return bhFinish();
+}
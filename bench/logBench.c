@@ -0,0 +1,116 @@
+/*
+ * logBench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Cost of a log_message() call: rejected by the level compare, compiled out (DEBUG in
+ *  the release profile), and written as text or as a binary record, each by the caller
+ *  and through the background writer. The writer is measured with -logQueue=BLOCK, where
+ *  every line is written and the figure is the sustained rate, and with the default DROP:
+ *  the sustained rate, most lines dropped as the queue overruns, and the caller latency,
+ *  each call timed in bursts the queue takes without dropping. Log output goes to
+ *  /dev/null. Output as described in BenchHarness.h; items are messages.
+ *  Build with BUILD_PROFILE=release.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "BenchHarness.h"
+
+#define BURST_LINES     64      /* Well below the 256 queue slots, so a burst is never dropped */
+#define BURST_COUNT     200
+#define BURST_PAUSE_NS  1000000 /* The writer empties the queue before the next burst */
+
+// A typical update loop message: a string and two numbers
+static void caseInfo(void *arg, long iterations) {
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        log_message(LOG_INFO, "%s: frame %ld posted, %d us", (const char *)arg, i, (int)(i & 0xffff));
+    }
+}
+
+static void caseDebug(void *arg, long iterations) {
+    long i;
+
+    for (i = 0; i < iterations; i++) {
+        log_message(LOG_DEBUG, "%s: frame %ld posted, %d us", (const char *)arg, i, (int)(i & 0xffff));
+    }
+}
+
+// Caller latency: each call timed on its own, less the cost of reading the clock
+static void runCallerLatency(const char *param, const char *source) {
+    static double samples[BURST_LINES * BURST_COUNT];
+    struct timespec pause = { 0, BURST_PAUSE_NS };
+    uint64_t start, clockNs, elapsed;
+    int burst, i, count = 0;
+
+    start = bhNowNs();
+    for (i = 0; i < 1000; i++) {
+        bhNowNs();
+    }
+    clockNs = (bhNowNs() - start) / 1000;
+
+    for (burst = 0; burst < BURST_COUNT; burst++) {
+        for (i = 0; i < BURST_LINES; i++) {
+            start = bhNowNs();
+            log_message(LOG_INFO, "%s: frame %ld posted, %d us", source, (long)i, burst);
+            elapsed = bhNowNs() - start;
+            samples[count++] = (elapsed > clockNs) ? (double)(elapsed - clockNs) : 0.0;
+        }
+        nanosleep(&pause, NULL);
+    }
+    bhReport("log_message", param, samples, count, 1, 1);
+}
+
+int main(int argc, char *argv[]) {
+    static char source[] = "bgrPresentWindow";
+    int devNull;
+
+    bhInit("logBench", argc, argv);
+    devNull = open("/dev/null", O_WRONLY);
+    if ((devNull < 0) || (dup2(devNull, STDOUT_FILENO) < 0)) {
+        fprintf(stderr, "Can not point stdout to /dev/null\n");
+        return -1;
+    }
+
+    log_init(LOG_WARNING);
+    bhRun("log_message", "INFO filtered", caseInfo, source, 1);
+    bhRun("log_message", (LOG_DEBUG > LOG_COMPILE_LEVEL) ? "DEBUG compiled out" : "DEBUG filtered", caseDebug, source, 1);
+
+    log_init(LOG_INFO);
+    bhRun("log_message", "INFO text sync", caseInfo, source, 1);
+    if (log_async_start(LOG_OVERFLOW_BLOCK) == 0) {
+        bhRun("log_message", "INFO text async BLOCK", caseInfo, source, 1);
+        log_async_stop();
+    }
+    if (log_async_start(LOG_OVERFLOW_DROP) == 0) {
+        bhRun("log_message", "INFO text async DROP", caseInfo, source, 1);
+        runCallerLatency("INFO text async DROP caller latency", source);
+        log_async_stop();
+    }
+
+    if (log_binary_start("/dev/null") == 0) {
+        bhRun("log_message", "INFO binary sync", caseInfo, source, 1);
+        if (log_async_start(LOG_OVERFLOW_BLOCK) == 0) {
+            bhRun("log_message", "INFO binary async BLOCK", caseInfo, source, 1);
+            log_async_stop();
+        }
+        if (log_async_start(LOG_OVERFLOW_DROP) == 0) {
+            bhRun("log_message", "INFO binary async DROP", caseInfo, source, 1);
+            runCallerLatency("INFO binary async DROP caller latency", source);
+            log_async_stop();
+        }
+    }
+
+    close(devNull);
+    return bhFinish();
+}
@@ -0,0 +1,165 @@
+/*
+ * rotateBench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Image rotation: the original byte-wise 180 loop against pkRotate180Rgbx(), and a
+ *  per-pixel quarter turn against the tiled pkRotate90Rgbx()/pkRotate270Rgbx(), at
+ *  several resolutions. Results are checked against each other. Output as described
+ *  in BenchHarness.h; items are pixels.
+ *  Build with BUILD_PROFILE=release.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "PixKernels.h"
+#include "BenchHarness.h"
+
+typedef struct {
+    unsigned char *image;
+    uint32_t *dst;
+    int width;
+    int height;
+    int bytesPerPixel;
+    int clockwise;
+} rotateCase;
+
+// rotateImage180() as ImgLib first had it: one byte per inner iteration, two index multiplications per byte.
+static void legacyRotate180(unsigned char *data, int width, int height, int bytesPerPixel) {
+    int halfHeight = height / 2;
+
+    for (int row = 0; row < halfHeight; ++row) {
+        for (int col = 0; col < width; ++col) {
+            for (int byte = 0; byte < bytesPerPixel; ++byte) {
+                int topIndex = (row * width + col) * bytesPerPixel + byte;
+                int bottomIndex = ((height - 1 - row) * width + (width - 1 - col)) * bytesPerPixel + byte;
+                unsigned char temp = data[topIndex];
+                data[topIndex] = data[bottomIndex];
+                data[bottomIndex] = temp;
+            }
+        }
+    }
+    if (height % 2 != 0) {
+        int middleRow = halfHeight;
+        for (int col = 0; col < width / 2; ++col) {
+            for (int byte = 0; byte < bytesPerPixel; ++byte) {
+                int leftIndex = (middleRow * width + col) * bytesPerPixel + byte;
+                int rightIndex = (middleRow * width + (width - 1 - col)) * bytesPerPixel + byte;
+                unsigned char temp = data[leftIndex];
+                data[leftIndex] = data[rightIndex];
+                data[rightIndex] = temp;
+            }
+        }
+    }
+}
+
+// Straightforward quarter turn: sequential reads, one destination row per source pixel.
+static void naiveRotate90(const uint32_t *src, int width, int height, uint32_t *dst, int clockwise) {
+    int x, y;
+
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            if (clockwise) {
+                dst[(size_t)x * height + (height - 1 - y)] = src[(size_t)y * width + x];
+            } else {
+                dst[(size_t)(width - 1 - x) * height + y] = src[(size_t)y * width + x];
+            }
+        }
+    }
+}
+
+static void caseLegacy180(void *arg, long iterations) {
+    rotateCase *pCase = (rotateCase *)arg;
+
+    while (iterations-- > 0) {
+        legacyRotate180(pCase->image, pCase->width, pCase->height, pCase->bytesPerPixel);
+    }
+}
+
+static void caseKernel180(void *arg, long iterations) {
+    rotateCase *pCase = (rotateCase *)arg;
+
+    while (iterations-- > 0) {
+        pkRotate180Rgbx(pCase->image, pCase->width, pCase->height, pCase->width * 4);
+    }
+}
+
+static void caseNaive90(void *arg, long iterations) {
+    rotateCase *pCase = (rotateCase *)arg;
+
+    while (iterations-- > 0) {
+        naiveRotate90((const uint32_t *)pCase->image, pCase->width, pCase->height, pCase->dst, pCase->clockwise);
+    }
+}
+
+static void caseKernel90(void *arg, long iterations) {
+    rotateCase *pCase = (rotateCase *)arg;
+
+    while (iterations-- > 0) {
+        if (pCase->clockwise) {
+            pkRotate90Rgbx(pCase->image, pCase->width, pCase->height, pCase->width * 4, pCase->dst, pCase->height * 4);
+        } else {
+            pkRotate270Rgbx(pCase->image, pCase->width, pCase->height, pCase->width * 4, pCase->dst, pCase->height * 4);
+        }
+    }
+}
+
+static void runSize(int width, int height) {
+    size_t pixelCount = (size_t)width * height;
+    unsigned char *check = malloc(pixelCount * sizeof(uint32_t));
+    uint32_t *dstCheck = malloc(pixelCount * sizeof(uint32_t));
+    rotateCase rotCase;
+    char param[64];
+    size_t i;
+
+    rotCase.image = malloc(pixelCount * sizeof(uint32_t));
+    rotCase.dst = malloc(pixelCount * sizeof(uint32_t));
+    rotCase.width = width;
+    rotCase.height = height;
+    if ((rotCase.image == NULL) || (check == NULL) || (rotCase.dst == NULL) || (dstCheck == NULL)) {
+        fprintf(stderr, "Buffer allocation failed\n");
+        exit(-1);
+    }
+    for (i = 0; i < pixelCount * sizeof(uint32_t); i++) {
+        rotCase.image[i] = (unsigned char)rand();
+    }
+
+    snprintf(param, sizeof(param), "%dx%d", width, height);
+    rotCase.bytesPerPixel = 4;
+    memcpy(check, rotCase.image, pixelCount * sizeof(uint32_t));
+    legacyRotate180(check, width, height, rotCase.bytesPerPixel);
+    caseKernel180(&rotCase, 1);
+    bhCheck("pkRotate180Rgbx", param, memcmp(check, rotCase.image, pixelCount * sizeof(uint32_t)) == 0);
+
+    bhRun("legacyRotate180", param, caseLegacy180, &rotCase, (double)pixelCount);
+    bhRun("pkRotate180Rgbx", param, caseKernel180, &rotCase, (double)pixelCount);
+
+    for (rotCase.clockwise = 1; rotCase.clockwise >= 0; rotCase.clockwise--) {
+        naiveRotate90((const uint32_t *)rotCase.image, width, height, dstCheck, rotCase.clockwise);
+        caseKernel90(&rotCase, 1);
+        bhCheck(rotCase.clockwise ? "pkRotate90Rgbx" : "pkRotate270Rgbx", param, memcmp(dstCheck, rotCase.dst, pixelCount * sizeof(uint32_t)) == 0);
+
+        bhRun(rotCase.clockwise ? "naiveRotate90" : "naiveRotate270", param, caseNaive90, &rotCase, (double)pixelCount);
+        bhRun(rotCase.clockwise ? "pkRotate90Rgbx" : "pkRotate270Rgbx", param, caseKernel90, &rotCase, (double)pixelCount);
+    }
+
+    free(rotCase.image);
+    free(check);
+    free(rotCase.dst);
+    free(dstCheck);
+}
+
+int main(int argc, char *argv[]) {
+    bhInit("rotateBench", argc, argv);
+
+    runSize(1920, 1080);
+    runSize(1280, 768);
+    runSize(1023, 767);    // Odd sizes: a middle row and no full vectors at the row ends
+    runSize(800, 480);
+
+    return bhFinish();
+}
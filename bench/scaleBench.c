@@ -0,0 +1,175 @@
+/*
+ * scaleBench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Software scaler throughput per quality level: psScaleRgbx() nearest, bilinear and
+ *  area against straightforward per-pixel versions of the same filters (coordinates and
+ *  taps recomputed for every pixel, as a naive blit loop does). Results are checked
+ *  against each other. Output as described in BenchHarness.h; items are output pixels.
+ *  Build with BUILD_PROFILE=release.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "PixKernels.h"
+#include "PixScale.h"
+#include "BenchHarness.h"
+
+typedef struct {
+    const uint32_t *image;
+    int srcWidth;
+    int srcHeight;
+    uint32_t *dst;
+    int dstWidth;
+    int dstHeight;
+    psScaleParams params;
+} scaleCase;
+
+static uint32_t lerpPixel(uint32_t a, uint32_t b, uint32_t f) {
+    uint32_t result = 0;
+    int shift;
+
+    for (shift = 0; shift < 32; shift += 8) {
+        result |= (((((a >> shift) & 0xff) * (256 - f) + ((b >> shift) & 0xff) * f) >> 8) & 0xff) << shift;
+    }
+    return result;
+}
+
+static void linearTaps(int index, int srcSize, int scaledSize, int *pIdx0, int *pIdx1, uint32_t *pFrac) {
+    int64_t pos = (((int64_t)index * 256 + 128) * srcSize * 256) / scaledSize - 32768;
+    int idx = (int)(pos >> 16);
+
+    if (pos <= 0) {
+        *pIdx0 = *pIdx1 = 0;
+        *pFrac = 0;
+    } else if (idx >= srcSize - 1) {
+        *pIdx0 = *pIdx1 = srcSize - 1;
+        *pFrac = 0;
+    } else {
+        *pIdx0 = idx;
+        *pIdx1 = idx + 1;
+        *pFrac = (uint32_t)(pos & 0xffff) >> 8;
+    }
+}
+
+static void naiveScale(const uint32_t *src, int srcWidth, int srcHeight, uint32_t *dst, int dstWidth, int dstHeight, ePsFilters filter) {
+    int x, y, sx, sy, c;
+
+    for (y = 0; y < dstHeight; y++) {
+        for (x = 0; x < dstWidth; x++) {
+            if (filter == ePsFilter_NEAREST) {
+                sx = (int)(((int64_t)x * 2 + 1) * srcWidth / (2 * (int64_t)dstWidth));
+                sy = (int)(((int64_t)y * 2 + 1) * srcHeight / (2 * (int64_t)dstHeight));
+                dst[(size_t)y * dstWidth + x] = src[(size_t)sy * srcWidth + sx];
+            } else if (filter == ePsFilter_BILINEAR) {
+                int x0, x1, y0, y1;
+                uint32_t fx, fy;
+
+                linearTaps(x, srcWidth, dstWidth, &x0, &x1, &fx);
+                linearTaps(y, srcHeight, dstHeight, &y0, &y1, &fy);
+                dst[(size_t)y * dstWidth + x] = lerpPixel(lerpPixel(src[(size_t)y0 * srcWidth + x0], src[(size_t)y0 * srcWidth + x1], fx),
+                                                          lerpPixel(src[(size_t)y1 * srcWidth + x0], src[(size_t)y1 * srcWidth + x1], fx), fy);
+            } else {
+                int xs = (int)((int64_t)x * srcWidth / dstWidth), xe = (int)(((int64_t)x + 1) * srcWidth / dstWidth);
+                int ys = (int)((int64_t)y * srcHeight / dstHeight), ye = (int)(((int64_t)y + 1) * srcHeight / dstHeight);
+                uint64_t recip, count;
+                uint32_t result = 0;
+
+                if (xe <= xs) xe = xs + 1;
+                if (ye <= ys) ye = ys + 1;
+                count = (uint64_t)(xe - xs) * (ye - ys);
+                recip = ((1ULL << 24) + count / 2) / count;
+                for (c = 0; c < 4; c++) {
+                    uint32_t sum = 0;
+                    uint64_t v;
+
+                    for (sy = ys; sy < ye; sy++) {
+                        for (sx = xs; sx < xe; sx++) {
+                            sum += (src[(size_t)sy * srcWidth + sx] >> (c * 8)) & 0xff;
+                        }
+                    }
+                    v = (sum * recip + (1u << 23)) >> 24;
+                    result |= (uint32_t)((v > 255) ? 255 : v) << (c * 8);
+                }
+                dst[(size_t)y * dstWidth + x] = result;
+            }
+        }
+    }
+}
+
+static void caseNaive(void *arg, long iterations) {
+    scaleCase *pCase = (scaleCase *)arg;
+
+    while (iterations-- > 0) {
+        naiveScale(pCase->image, pCase->srcWidth, pCase->srcHeight, pCase->dst, pCase->dstWidth, pCase->dstHeight, pCase->params.filter);
+    }
+}
+
+static void caseKernel(void *arg, long iterations) {
+    scaleCase *pCase = (scaleCase *)arg;
+
+    while (iterations-- > 0) {
+        psScaleRgbx(pCase->image, pCase->srcWidth, pCase->srcHeight, pCase->srcWidth * 4, pCase->dst, pCase->dstWidth * 4, &(pCase->params));
+    }
+}
+
+static void runCase(int srcWidth, int srcHeight, int dstWidth, int dstHeight) {
+    uint32_t *image = malloc((size_t)srcWidth * srcHeight * sizeof(uint32_t));
+    uint32_t *dst = malloc((size_t)dstWidth * dstHeight * sizeof(uint32_t));
+    uint32_t *check = malloc((size_t)dstWidth * dstHeight * sizeof(uint32_t));
+    double pixels = (double)dstWidth * dstHeight;
+    scaleCase scCase;
+    char param[64];
+    int filter;
+    size_t i;
+
+    if ((image == NULL) || (dst == NULL) || (check == NULL)) {
+        fprintf(stderr, "Buffer allocation failed\n");
+        exit(-1);
+    }
+    // Smooth gradients with noise, so every filter has something to average
+    for (i = 0; i < (size_t)srcWidth * srcHeight; i++) {
+        uint32_t x = (uint32_t)(i % srcWidth), y = (uint32_t)(i / srcWidth);
+        image[i] = 0xff000000u | (((x + (rand() & 15)) & 0xff) << 16) | (((y + (rand() & 15)) & 0xff) << 8) | ((x ^ y) & 0xff);
+    }
+
+    memset(&scCase, 0, sizeof(scCase));
+    scCase.image = image;
+    scCase.srcWidth = srcWidth;
+    scCase.srcHeight = srcHeight;
+    scCase.dstWidth = dstWidth;
+    scCase.dstHeight = dstHeight;
+    scCase.params.scaledWidth = scCase.params.outWidth = dstWidth;
+    scCase.params.scaledHeight = scCase.params.outHeight = dstHeight;
+    for (filter = ePsFilter_NEAREST; filter <= ePsFilter_AREA; filter++) {
+        scCase.params.filter = (ePsFilters)filter;
+        snprintf(param, sizeof(param), "%dx%d->%dx%d %s", srcWidth, srcHeight, dstWidth, dstHeight, psFilterName(scCase.params.filter));
+        scCase.dst = check;
+        caseNaive(&scCase, 1);
+        bhRun("naiveScale", param, caseNaive, &scCase, pixels);
+        scCase.dst = dst;
+        caseKernel(&scCase, 1);
+        bhCheck("psScaleRgbx", param, memcmp(check, dst, (size_t)dstWidth * dstHeight * sizeof(uint32_t)) == 0);
+        bhRun("psScaleRgbx", param, caseKernel, &scCase, pixels);
+    }
+
+    free(image);
+    free(dst);
+    free(check);
+}
+
+int main(int argc, char *argv[]) {
+    bhInit("scaleBench", argc, argv);
+
+    runCase(1920, 1080, 1280, 720);    // Full HD splash on a 720p display
+    runCase(3840, 2160, 1280, 720);    // 4K source, heavy downscale
+    runCase(640, 480, 1280, 768);      // Small source stretched up
+    runCase(1280, 768, 1024, 600);     // Mild downscale
+
+    return bhFinish();
+}
@@ -0,0 +1,136 @@
+/*
+ * textBench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Text path through FtRenderer with a real font: frCalcStrPixelSize() and ftRender()
+ *  for a short and a long string, the latter with draw_bitmap() compositing opaque
+ *  (PIXMAP) and blended (BLEND), and once with the glyph cache flushed before every
+ *  render, as for text never shown before. Output as described in BenchHarness.h;
+ *  items are characters.
+ *
+ *    textBench -font=/path/to/font.ttf [-size=16] [-dpi=96]
+ *
+ *  Build with BUILD_PROFILE=release.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "logger.h"
+#include "FtRenderer.h"
+#include "BenchHarness.h"
+
+#define BUF_WIDTH    2048
+#define BUF_HEIGHT   96
+#define BPP          4
+
+typedef struct {
+    const char *text;
+    fr_grBufferProps buffProps;
+    fr_canvasProps canvasProps;
+    int maxPenPos_y;
+    int flushCache;
+} textCase;
+
+static const char *shortText = "Loading 40%";
+static const char *longText = "Updating system software, do not switch off the ignition (step 3 of 7: verifying partitions)";
+
+static void caseMeasure(void *arg, long iterations) {
+    textCase *pCase = (textCase *)arg;
+    int penPos_y, strWidth, strHeight;
+
+    while (iterations-- > 0) {
+        frCalcStrPixelSize(&penPos_y, &strWidth, &strHeight, pCase->text);
+    }
+}
+
+static void caseRender(void *arg, long iterations) {
+    textCase *pCase = (textCase *)arg;
+
+    while (iterations-- > 0) {
+        if (pCase->flushCache) {
+            frFlushGlyphCache();
+        }
+        pCase->canvasProps.penPos.pen_x = 0;
+        pCase->canvasProps.penPos.pen_y = pCase->maxPenPos_y << 6;
+        ftRender(pCase->buffProps, &(pCase->canvasProps), pCase->text);
+    }
+}
+
+// Sets up the text box as ImgLib does before ftRender()
+static void setupText(textCase *pCase, const char *text) {
+    int strWidth, strHeight;
+
+    pCase->text = text;
+    frCalcStrPixelSize(&(pCase->maxPenPos_y), &strWidth, &strHeight, text);
+    pCase->canvasProps.txtBoundBox.bb_start_x = 0;
+    pCase->canvasProps.txtBoundBox.bb_start_y = 0;
+    pCase->canvasProps.txtBoundBox.bb_width = (strWidth < BUF_WIDTH) ? strWidth : BUF_WIDTH;
+    pCase->canvasProps.txtBoundBox.bb_height = (strHeight < BUF_HEIGHT) ? strHeight : BUF_HEIGHT;
+}
+
+static void runText(textCase *pCase, const char *name, const char *text) {
+    char param[32];
+    double chars = (double)strlen(text);
+
+    setupText(pCase, text);
+    bhRun("frCalcStrPixelSize", name, caseMeasure, pCase, chars);
+
+    pCase->flushCache = 0;
+    pCase->buffProps.fr_composeMode = fr_Compose_Opaque;
+    snprintf(param, sizeof(param), "%s opaque", name);
+    bhRun("ftRender", param, caseRender, pCase, chars);
+
+    pCase->buffProps.fr_composeMode = fr_Compose_Blend;
+    snprintf(param, sizeof(param), "%s blend", name);
+    bhRun("ftRender", param, caseRender, pCase, chars);
+
+    pCase->flushCache = 1;
+    pCase->buffProps.fr_composeMode = fr_Compose_Opaque;
+    snprintf(param, sizeof(param), "%s uncached", name);
+    bhRun("ftRender", param, caseRender, pCase, chars);
+    pCase->flushCache = 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *fontArg = bhArg(argc, argv, "-font");
+    const char *sizeArg = bhArg(argc, argv, "-size");
+    const char *dpiArg = bhArg(argc, argv, "-dpi");
+    char fontFile[256];
+    textCase txtCase;
+
+    log_init(LOG_ERROR);
+    if (fontArg == NULL) {
+        fprintf(stderr, "Usage: textBench -font=/path/to/font.ttf [-size=16] [-dpi=96] [-reps=N] [-warmup=N] [-minRepMs=N]\n");
+        return -1;
+    }
+    strncpy(fontFile, fontArg, sizeof(fontFile) - 1);
+    fontFile[sizeof(fontFile) - 1] = 0;
+    if (ftInitFont(fontFile, (sizeArg != NULL) ? atoi(sizeArg) : 16, (dpiArg != NULL) ? atoi(dpiArg) : 96) != fr_OK) {
+        fprintf(stderr, "ftInitFont(%s) failed\n", fontFile);
+        return -1;
+    }
+    bhInit("textBench", argc, argv);
+
+    memset(&txtCase, 0, sizeof(txtCase));
+    txtCase.buffProps.fr_pix_buf_data = calloc(BUF_WIDTH * BUF_HEIGHT, BPP);
+    if (txtCase.buffProps.fr_pix_buf_data == NULL) {
+        fprintf(stderr, "Buffer allocation failed\n");
+        return -1;
+    }
+    txtCase.buffProps.fr_buf_size_x = BUF_WIDTH;
+    txtCase.buffProps.fr_buf_size_y = BUF_HEIGHT;
+    txtCase.buffProps.fr_bpp = BPP;
+    txtCase.buffProps.fr_stride = BUF_WIDTH * BPP;
+    txtCase.buffProps.fr_fgColor = 0x00ffffff;
+
+    runText(&txtCase, "short", shortText);
+    runText(&txtCase, "long", longText);
+
+    free(txtCase.buffProps.fr_pix_buf_data);
+    return bhFinish();
+}
@@ -0,0 +1,49 @@
+/*
+ * BgrImage.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  On-disk layout of a pre-converted splash image (.bgri), written by tools/bgrImgConv
+ *  and loaded by ImgLib without any codec. Pixels are already in the window format
+ *  (RGBX8888, X=0xFF) and orientation. All fields are little endian.
+ *
+ *  File: bgr_imgHeader | padding up to dataOffset | pixel data
+ *
+ *  RAW: height rows of stride bytes.
+ *  RLE: per row, packets of one uint32_t control word followed by pixels. The low 31 bits
+ *       are the pixel count; with BGR_IMG_RLE_RUN set one pixel follows, repeated count
+ *       times, otherwise count literal pixels follow. A packet never spans two rows.
+ */
+
+#ifndef SRC_BGRIMAGE_H_
+#define SRC_BGRIMAGE_H_
+
+#include <stdint.h>
+
+#define BGR_IMG_MAGIC        0x49524742u   /* "BGRI" */
+#define BGR_IMG_VERSION      1
+#define BGR_IMG_FORMAT_RGBX  1
+#define BGR_IMG_DATA_ALIGN   4096          /* Pixel data offset, so RAW rows can be read straight into a page aligned buffer */
+#define BGR_IMG_RLE_RUN      0x80000000u
+#define BGR_IMG_MAX_DIM      16384         /* Width and height limit; keeps a RAW or worst case RLE image below 4 GB */
+
+typedef enum {
+  eBgrImg_RAW = 0,
+  eBgrImg_RLE = 1
+} eBgrImgEncodings;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t format;
+  uint32_t encoding;       /* eBgrImgEncodings */
+  uint32_t stride;         /* RAW row size in bytes: width * 4 */
+  uint32_t dataOffset;
+  uint32_t dataSize;       /* Bytes of pixel data at dataOffset */
+  uint32_t reserved;
+} bgr_imgHeader;
+
+#endif /* SRC_BGRIMAGE_H_ */
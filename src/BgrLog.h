@@ -0,0 +1,56 @@
+/*
+ * BgrLog.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Layout of a binary log (.bgrl), written by the logger after log_binary_start() and
+ *  turned back into text by tools/bgrLogDecode. A message costs a format id, a timestamp
+ *  and its raw arguments; each format string is stored once, in a DEFINE record written
+ *  before its first message. All fields are little endian and unaligned.
+ *
+ *  File: bgr_logHeader | records
+ *
+ *  Record: bgr_logRecord, then by type
+ *    DEFINE:  uint8_t argTypes[argCount] (eBgrLogArgs), the format string (no terminating 0)
+ *    MESSAGE: uint64_t CLOCK_MONOTONIC time in ns, then each argument as its type stores it:
+ *             INT32 4 bytes, INT64 8 bytes, DOUBLE 8 bytes, STRING uint16_t length and the bytes
+ *    DROPPED: uint32_t count of messages lost since the previous DROPPED record
+ */
+
+#ifndef SRC_BGRLOG_H_
+#define SRC_BGRLOG_H_
+
+#include <stdint.h>
+
+#define BGR_LOG_MAGIC        0x4c524742u   /* "BGRL" */
+#define BGR_LOG_VERSION      1
+#define BGR_LOG_ID_TEXT      0             /* Predefined format "%s": messages logged as formatted text */
+
+typedef enum {
+  eBgrLog_DEFINE = 1,
+  eBgrLog_MESSAGE = 2,
+  eBgrLog_DROPPED = 3
+} eBgrLogRecords;
+
+typedef enum {
+  eBgrLogArg_INT32 = 1,    /* int, char; and long where it is 32 bit */
+  eBgrLogArg_INT64 = 2,    /* long long, 64 bit long, size_t, pointers; widened to 64 bit */
+  eBgrLogArg_DOUBLE = 3,
+  eBgrLogArg_STRING = 4    /* Copied, truncated to what fits the record */
+} eBgrLogArgs;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+} bgr_logHeader;
+
+typedef struct {
+  uint8_t type;            /* eBgrLogRecords */
+  uint8_t level;           /* log_level_t */
+  uint16_t length;         /* Whole record, this header included */
+  uint16_t id;             /* Format id */
+  uint16_t argCount;
+} bgr_logRecord;
+
+#endif /* SRC_BGRLOG_H_ */
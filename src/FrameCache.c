@@ -0,0 +1,223 @@
+/*
+ * FrameCache.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file FrameCache.c
+ *
+ *  @brief Composed frame cache file: header, then the pixel rows at a page aligned offset.
+ *
+ *  A frame is written to a temporary file, synced and renamed over the cache file, and
+ *  the directory is synced after, so a reset or power cut while storing leaves either
+ *  the old frame or the new one, never half of one.
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "logger.h"
+#include "PixFormat.h"
+#include "FrameCache.h"
+
+
+/******************************************************************************
+  Macro/Constant Definitions
+ ******************************************************************************/
+#define FC_MAGIC        0x46524742u   /* "BGRF" little endian */
+#define FC_VERSION      1
+#define FC_DATA_OFFSET  4096
+
+
+/******************************************************************************
+  Type Definitions
+ ******************************************************************************/
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;       /* Bytes per row in the file: width * bytes per pixel */
+  uint32_t format;       /* ePixFormats */
+  uint32_t dataOffset;
+  uint32_t reserved;
+} fcHeader;
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+// Makes a rename in the directory of fileName durable
+static int fcSyncDir(const char *fileName) {
+  char dirName[512];
+  const char *slash = strrchr(fileName, '/');
+  int dirFd;
+  int syncResult;
+
+  if (slash == NULL) {
+    strcpy(dirName, ".");
+  } else if (slash == fileName) {
+    strcpy(dirName, "/");
+  } else {
+    if ((size_t)(slash - fileName) >= sizeof(dirName)) {
+      return -1;
+    }
+    memcpy(dirName, fileName, slash - fileName);
+    dirName[slash - fileName] = 0;
+  }
+
+  dirFd = open(dirName, O_RDONLY);
+  if (dirFd < 0) {
+    return -1;
+  }
+  syncResult = fsync(dirFd);
+  close(dirFd);
+  return syncResult;
+}
+
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+uint64_t fcHash(uint64_t hash, const void *pData, size_t size) {
+  const uint8_t *pByte = (const uint8_t *)pData;
+  size_t i;
+
+  for (i = 0; i < size; i++) {
+    hash ^= pByte[i];
+    hash *= 0x100000001b3ULL;   /* FNV-1a 64 prime */
+  }
+  return hash;
+}
+
+// The terminator is hashed too, so "ab"+"c" and "a"+"bc" give different keys.
+uint64_t fcHashStr(uint64_t hash, const char *str) {
+  return fcHash(hash, str, strlen(str) + 1);
+}
+
+uint64_t fcHashInt(uint64_t hash, long long value) {
+  return fcHash(hash, &value, sizeof(value));
+}
+
+int fcLoad(const char *fileName, uint64_t key, int width, int height, ePixFormats format, void *pDst, int dstStride) {
+  const fcHeader *pHeader;
+  const uint8_t *pMap;
+  struct stat fileStat;
+  int loadResult = 1;
+  int fd;
+  int y;
+
+  fd = open(fileName, O_RDONLY);
+  if (fd < 0) {
+    log_message(LOG_INFO, "fcLoad: no frame cache at %s", fileName);
+    return 1;
+  }
+  if ((fstat(fd, &fileStat) != 0) || (fileStat.st_size < FC_DATA_OFFSET)) {
+    close(fd);
+    log_message(LOG_WARNING, "fcLoad: %s is not a frame cache", fileName);
+    return 1;
+  }
+  pMap = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (pMap == MAP_FAILED) {
+    log_message(LOG_ERROR, "fcLoad::mmap(%s) failed: %s", fileName, strerror(errno));
+    return -1;
+  }
+
+  pHeader = (const fcHeader *)pMap;
+  if ((pHeader->magic != FC_MAGIC) || (pHeader->version != FC_VERSION) || !pfIsDisplayFormat((ePixFormats)pHeader->format) ||
+      (pHeader->dataOffset != FC_DATA_OFFSET) || (pHeader->stride != (uint32_t)pfRowBytes((ePixFormats)pHeader->format, pHeader->width)) ||
+      ((off_t)pHeader->dataOffset + (off_t)pHeader->stride * pHeader->height > fileStat.st_size)) {
+    log_message(LOG_WARNING, "fcLoad: %s has an unknown layout, ignored", fileName);
+  } else if ((pHeader->key != key) || (pHeader->width != (uint32_t)width) || (pHeader->height != (uint32_t)height) ||
+             (pHeader->format != (uint32_t)format)) {
+    log_message(LOG_INFO, "fcLoad: %s was composed from other inputs, miss", fileName);
+  } else {
+    for (y = 0; y < height; y++) {
+      memcpy((uint8_t *)pDst + (size_t)y * dstStride, pMap + pHeader->dataOffset + (size_t)y * pHeader->stride, pHeader->stride);
+    }
+    log_message(LOG_INFO, "fcLoad: frame %dx%d loaded from %s", width, height, fileName);
+    loadResult = 0;
+  }
+
+  munmap((void *)pMap, fileStat.st_size);
+  return loadResult;
+}
+
+int fcStore(const char *fileName, uint64_t key, int width, int height, ePixFormats format, const void *pSrc, int srcStride) {
+  static const uint8_t padding[FC_DATA_OFFSET] = {0};
+  char tmpFileName[512];
+  fcHeader header;
+  FILE *out;
+  int storeResult = 0;
+  int y;
+
+  if (snprintf(tmpFileName, sizeof(tmpFileName), "%s.tmp", fileName) >= (int)sizeof(tmpFileName)) {
+    log_message(LOG_ERROR, "fcStore: path too long: %s", fileName);
+    return -1;
+  }
+  out = fopen(tmpFileName, "wb");
+  if (out == NULL) {
+    log_message(LOG_ERROR, "fcStore::fopen(%s) failed: %s", tmpFileName, strerror(errno));
+    return -1;
+  }
+
+  memset(&header, 0, sizeof(header));
+  header.magic = FC_MAGIC;
+  header.version = FC_VERSION;
+  header.key = key;
+  header.width = width;
+  header.height = height;
+  header.stride = pfRowBytes(format, width);
+  header.format = format;
+  header.dataOffset = FC_DATA_OFFSET;
+
+  if ((fwrite(&header, sizeof(header), 1, out) != 1) ||
+      (fwrite(padding, FC_DATA_OFFSET - sizeof(header), 1, out) != 1)) {
+    storeResult = -2;
+  }
+  for (y = 0; (y < height) && (storeResult == 0); y++) {
+    if (fwrite((const uint8_t *)pSrc + (size_t)y * srcStride, header.stride, 1, out) != 1) {
+      storeResult = -2;
+    }
+  }
+  //The data must be on disk before the rename is, or a power cut can leave a matching header over zeroed pixels
+  if ((storeResult == 0) && ((fflush(out) != 0) || (fsync(fileno(out)) != 0))) {
+    storeResult = -2;
+  }
+  if (fclose(out) != 0) {
+    storeResult = -2;
+  }
+
+  if (storeResult == 0) {
+    if (rename(tmpFileName, fileName) != 0) {
+      log_message(LOG_ERROR, "fcStore::rename(%s) failed: %s", fileName, strerror(errno));
+      storeResult = -3;
+    } else {
+      if (fcSyncDir(fileName) != 0) {
+        log_message(LOG_WARNING, "fcStore: syncing the directory of %s failed: %s", fileName, strerror(errno));
+      }
+      log_message(LOG_INFO, "fcStore: frame %dx%d stored in %s", width, height, fileName);
+    }
+  } else {
+    log_message(LOG_ERROR, "fcStore: writing %s failed", tmpFileName);
+  }
+  if (storeResult != 0) {
+    unlink(tmpFileName);
+  }
+
+  return storeResult;
+}
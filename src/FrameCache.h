@@ -0,0 +1,30 @@
+/*
+ * FrameCache.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Composed frame cache: the window frame of a previous boot, stored raw in the
+ *  window format (XRGB8888 or RGB565) under a 64 bit FNV-1a key of everything it was
+ *  composed from. A matching file is mmap()-ed and copied into the window buffer.
+ */
+
+#ifndef SRC_FRAMECACHE_H_
+#define SRC_FRAMECACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PixFormat.h"
+
+#define FC_HASH_INIT  0xcbf29ce484222325ULL   /* FNV-1a 64 offset basis */
+
+uint64_t fcHash(uint64_t hash, const void *pData, size_t size);
+uint64_t fcHashStr(uint64_t hash, const char *str);
+uint64_t fcHashInt(uint64_t hash, long long value);
+
+/* Returns 0 if the frame was copied to pDst, 1 on a miss (no file, other key, size or format), negative on error. */
+int fcLoad(const char *fileName, uint64_t key, int width, int height, ePixFormats format, void *pDst, int dstStride);
+int fcStore(const char *fileName, uint64_t key, int width, int height, ePixFormats format, const void *pSrc, int srcStride);
+
+#endif /* SRC_FRAMECACHE_H_ */
@@ -0,0 +1,269 @@
+/*
+ * FrameStats.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file FrameStats.c
+ *
+ *  @brief Update latency histogram and per frame statistics of the update loop.
+ *
+ *  Latencies go into log-linear buckets of microseconds: exact below 16 us, then 8
+ *  buckets per power of two, so a percentile is off by at most 12.5%. It is reported
+ *  as the upper bound of its bucket. Everything is fixed size and formatted without
+ *  stdio, so the report can be written from a signal handler.
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "FtRenderer.h"
+#include "Trace.h"
+#include "FrameStats.h"
+
+
+/******************************************************************************
+  Macro Definitions
+ ******************************************************************************/
+#define FS_LINEAR_US        16      /* Latencies below this have a bucket each */
+#define FS_SUB_BITS         3       /* 8 buckets per power of two above */
+#define FS_BUCKETS          (FS_LINEAR_US + (32 - 4) * (1 << FS_SUB_BITS))
+
+/******************************************************************************
+  Type Definitions
+ ******************************************************************************/
+typedef struct {
+  uint64_t count;
+  uint64_t totalNs;
+  uint64_t maxNs;
+} fsStageStats;
+
+typedef struct {
+  char *pos;
+  char *end;
+} fsOut;
+
+/******************************************************************************
+  File Scope Variables
+ ******************************************************************************/
+static const char *fsStageNames[eFsStage_COUNT] = { "bgrLoadImagePixmap", "bgrBlitImagePixmap", "frCalcStrPixelSize",
+                                                    "bgrPrepareTxtPixmap", "ftRender", "text blit", "bgrPresentWindow", "update" };
+static fsStageStats fsStages[eFsStage_COUNT];
+static uint32_t fsLatencyBuckets[FS_BUCKETS];
+static uint64_t fsLatencyCount;
+static uint64_t fsLatencyMaxUs;
+static uint64_t fsFrames;
+static uint64_t fsPosted;
+static uint64_t fsBlitBytes;
+static uint64_t fsFrameBlitBytes;
+static uint64_t fsLastBlitBytes;
+static uint64_t fsDirtyPixels;
+static uint64_t fsLastDirtyPixels;
+static uint64_t fsMaxDirtyPixels;
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+static int fsBucketOf(uint64_t us) {
+  int exponent;
+
+  if (us < FS_LINEAR_US) {
+    return (int)us;
+  }
+  if (us > 0xFFFFFFFFu) {
+    return FS_BUCKETS - 1;
+  }
+  for (exponent = 4; (us >> (exponent + 1)) != 0; exponent++);
+  return FS_LINEAR_US + (exponent - 4) * (1 << FS_SUB_BITS) + (int)((us >> (exponent - FS_SUB_BITS)) & ((1 << FS_SUB_BITS) - 1));
+}
+
+// Largest latency that falls into the bucket
+static uint64_t fsBucketLimit(int bucket) {
+  int exponent;
+  uint64_t sub;
+
+  if (bucket < FS_LINEAR_US) {
+    return (uint64_t)bucket;
+  }
+  exponent = 4 + (bucket - FS_LINEAR_US) / (1 << FS_SUB_BITS);
+  sub = (uint64_t)((bucket - FS_LINEAR_US) % (1 << FS_SUB_BITS));
+  return (((1 << FS_SUB_BITS) + sub + 1) << (exponent - FS_SUB_BITS)) - 1;
+}
+
+// Latency below which permille of the updates were posted
+static uint64_t fsPercentile(int permille) {
+  uint64_t rank;
+  uint64_t seen = 0;
+  int i;
+
+  if (fsLatencyCount == 0) {
+    return 0;
+  }
+  rank = (fsLatencyCount * (uint64_t)permille + 999) / 1000;
+  for (i = 0; i < FS_BUCKETS; i++) {
+    seen += fsLatencyBuckets[i];
+    if (seen >= rank) {
+      break;
+    }
+  }
+  //The top bucket may span far beyond what was seen
+  return (fsBucketLimit(i) < fsLatencyMaxUs) ? fsBucketLimit(i) : fsLatencyMaxUs;
+}
+
+static void fsPutStr(fsOut *pOut, const char *str) {
+  for (; (*str != 0) && (pOut->pos < pOut->end); str++) {
+    *pOut->pos++ = *str;
+  }
+}
+
+static void fsPutU64(fsOut *pOut, const char *key, uint64_t value) {
+  char digits[20];
+  int count = 0;
+
+  fsPutStr(pOut, key);
+  do {
+    digits[count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  while ((count > 0) && (pOut->pos < pOut->end)) {
+    *pOut->pos++ = digits[--count];
+  }
+}
+
+static void fsSignalDump(int sig) {
+  static char report[FS_REPORT_MAX];
+  int savedErrno = errno;
+  int length;
+  int done = 0;
+  ssize_t written;
+
+  length = fsReport(report, sizeof(report));
+  while (done < length) {
+    written = write(STDOUT_FILENO, report + done, length - done);
+    if (written <= 0) {
+      if ((written < 0) && (errno == EINTR)) {
+        continue;
+      }
+      break;
+    }
+    done += (int)written;
+  }
+  errno = savedErrno;
+}
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+int fsStart(void) {
+  struct sigaction action;
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = fsSignalDump;
+  sigemptyset(&(action.sa_mask));
+  action.sa_flags = SA_RESTART;
+  if (sigaction(SIGUSR2, &action, NULL) != 0) {
+    log_message(LOG_WARNING, "fsStart::sigaction(SIGUSR2) failed: %s", strerror(errno));
+    return -1;
+  }
+  log_message(LOG_INFO, "Frame statistics: kill -USR2 %d writes them to stdout", (int)getpid());
+
+  return 0;
+}
+
+void fsStageEnd(eFsStages stage, uint64_t start) {
+  uint64_t end = trcNow();
+  uint64_t duration = end - start;
+
+  fsStages[stage].count++;
+  fsStages[stage].totalNs += duration;
+  if (duration > fsStages[stage].maxNs) {
+    fsStages[stage].maxNs = duration;
+  }
+  trcSpan(fsStageNames[stage], start, end);
+}
+
+void fsAddBlitBytes(uint64_t bytes) {
+  fsFrameBlitBytes += bytes;
+}
+
+void fsFrameEnd(uint64_t received, const int *dirtyRect) {
+  uint64_t latencyUs;
+  uint64_t dirtyPixels = 0;
+
+  fsFrames++;
+  fsBlitBytes += fsFrameBlitBytes;
+  fsLastBlitBytes = fsFrameBlitBytes;
+  fsFrameBlitBytes = 0;
+
+  if ((dirtyRect[2] > 0) && (dirtyRect[3] > 0)) {
+    dirtyPixels = (uint64_t)dirtyRect[2] * (uint64_t)dirtyRect[3];
+    fsPosted++;
+  }
+  fsDirtyPixels += dirtyPixels;
+  fsLastDirtyPixels = dirtyPixels;
+  if (dirtyPixels > fsMaxDirtyPixels) {
+    fsMaxDirtyPixels = dirtyPixels;
+  }
+
+  if (received != 0) {
+    latencyUs = (trcNow() - received) / 1000;
+    fsLatencyBuckets[fsBucketOf(latencyUs)]++;
+    fsLatencyCount++;
+    if (latencyUs > fsLatencyMaxUs) {
+      fsLatencyMaxUs = latencyUs;
+    }
+  }
+}
+
+int fsReport(char *buf, int size) {
+  fr_glyphCacheStats glyphStats;
+  uint64_t lookups;
+  fsOut out;
+  int stage;
+
+  if (size <= 0) {
+    return 0;
+  }
+  out.pos = buf;
+  out.end = buf + size - 1;
+  frGetGlyphCacheStats(&glyphStats);
+  lookups = (uint64_t)glyphStats.atlasHits + glyphStats.hits + glyphStats.misses;
+
+  fsPutU64(&out, "frames count=", fsFrames);
+  fsPutU64(&out, " posted=", fsPosted);
+  fsPutU64(&out, "\nlatency_us updates=", fsLatencyCount);
+  fsPutU64(&out, " p50=", fsPercentile(500));
+  fsPutU64(&out, " p99=", fsPercentile(990));
+  fsPutU64(&out, " max=", fsLatencyMaxUs);
+  for (stage = 0; stage < eFsStage_COUNT; stage++) {
+    fsPutStr(&out, "\nstage name=\"");
+    fsPutStr(&out, fsStageNames[stage]);
+    fsPutU64(&out, "\" count=", fsStages[stage].count);
+    fsPutU64(&out, " avg_us=", (fsStages[stage].count > 0) ? fsStages[stage].totalNs / fsStages[stage].count / 1000 : 0);
+    fsPutU64(&out, " max_us=", fsStages[stage].maxNs / 1000);
+  }
+  fsPutU64(&out, "\nblit bytes=", fsBlitBytes);
+  fsPutU64(&out, " last=", fsLastBlitBytes);
+  fsPutU64(&out, "\ndirty pixels=", fsDirtyPixels);
+  fsPutU64(&out, " last=", fsLastDirtyPixels);
+  fsPutU64(&out, " max=", fsMaxDirtyPixels);
+  fsPutU64(&out, "\nglyph_cache lookups=", lookups);
+  fsPutU64(&out, " atlas=", glyphStats.atlasHits);
+  fsPutU64(&out, " hits=", glyphStats.hits);
+  fsPutU64(&out, " misses=", glyphStats.misses);
+  fsPutU64(&out, " hit_pct=", (lookups > 0) ? ((uint64_t)glyphStats.atlasHits + glyphStats.hits) * 100 / lookups : 0);
+  fsPutStr(&out, "\n\n");
+  *out.pos = 0;
+
+  return (int)(out.pos - buf);
+}
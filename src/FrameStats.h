@@ -0,0 +1,55 @@
+/*
+ * FrameStats.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Running statistics of the update loop: latency from a text update being read off
+ *  the control socket to its frame being posted (log-linear histogram, p50/p99/max),
+ *  render time per stage, bytes blitted, dirty area posted, and the glyph cache hit
+ *  rate. Only the main thread records. The report is plain "name key=value" lines,
+ *  returned for a "?stats" query on the control socket and written to stdout on
+ *  SIGUSR2. Reading it is async-signal-safe; values may be a frame apart.
+ *
+ *    uint64_t start = trcNow();
+ *    ...
+ *    fsStageEnd(eFsStage_PRESENT, start);   also records the trace span
+ */
+
+#ifndef SRC_FRAMESTATS_H_
+#define SRC_FRAMESTATS_H_
+
+#include <stdint.h>
+
+#define FS_QUERY          "?stats"     /* Control socket line answered with the report */
+#define FS_REPORT_MAX     2048
+
+typedef enum {
+  eFsStage_LOAD_IMAGE = 0,  /* bgrLoadImagePixmap */
+  eFsStage_BLIT_IMAGE,      /* bgrBlitImagePixmap */
+  eFsStage_MEASURE_TEXT,    /* frCalcStrPixelSize */
+  eFsStage_PREPARE_TEXT,    /* bgrPrepareTxtPixmap */
+  eFsStage_RENDER_TEXT,     /* ftRender */
+  eFsStage_BLIT_TEXT,       /* Text pixmap blit */
+  eFsStage_PRESENT,         /* bgrPresentWindow */
+  eFsStage_UPDATE,          /* The whole pass, load to present */
+  eFsStage_COUNT
+} eFsStages;
+
+/* Installs the SIGUSR2 dump. Returns 0 on success. */
+int fsStart(void);
+
+/* Adds the time from start (trcNow()) to now to the stage, and the span to the trace. */
+void fsStageEnd(eFsStages stage, uint64_t start);
+
+/* Counts bytes written into the window buffer by a blit or by the text compose. */
+void fsAddBlitBytes(uint64_t bytes);
+
+/* Ends a frame. received is the trcNow() time the text update was read, 0 if the frame
+ * was not triggered by one. dirtyRect is what was posted, w or h 0 if nothing was. */
+void fsFrameEnd(uint64_t received, const int *dirtyRect);
+
+/* Writes the report into buf, always 0 terminated. Returns its length. Async-signal-safe. */
+int fsReport(char *buf, int size);
+
+#endif /* SRC_FRAMESTATS_H_ */
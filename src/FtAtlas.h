@@ -0,0 +1,43 @@
+/*
+ * FtAtlas.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  On-disk layout of a pre-baked glyph atlas (.fra), written by tools/ftBakeAtlas
+ *  and mmap()-ed by FtRenderer. All fields are little endian.
+ *
+ *  File: fr_atlasHeader | fr_atlasGlyph[glyphCount] sorted by charCode | coverage data
+ */
+
+#ifndef SRC_FTATLAS_H_
+#define SRC_FTATLAS_H_
+
+#include <stdint.h>
+
+#define FR_ATLAS_MAGIC    0x54415246u   /* "FRAT" */
+#define FR_ATLAS_VERSION  1
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t pointSize;      /* Char size the atlas was baked at, in points */
+  uint32_t dpi;            /* Device resolution the atlas was baked for */
+  uint32_t glyphCount;
+  uint32_t dataOffset;     /* File offset of the coverage data */
+  uint32_t fileSize;
+  uint32_t reserved;
+} fr_atlasHeader;
+
+typedef struct {
+  uint32_t charCode;
+  int16_t  bitmapLeft;
+  int16_t  bitmapTop;
+  uint16_t width;
+  uint16_t rows;
+  int32_t  advanceX;       /* 26.6 pixels */
+  int32_t  advanceY;       /* 26.6 pixels */
+  uint32_t offset;         /* width * rows coverage bytes at dataOffset + offset */
+} fr_atlasGlyph;
+
+#endif /* SRC_FTATLAS_H_ */
@@ -6,24 +6,75 @@
  */
 
 #include <ctype.h>
+#include <errno.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
-#include <sys/keycodes.h>
-#include <screen/screen.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __QNX__
+ #include <sys/keycodes.h>
+ #include <screen/screen.h>
+#endif
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_OUTLINE_H
 
 
 #include "FtRenderer.h"
+#include "FtAtlas.h"
+#include "PixKernels.h"
 #include "logger.h"
 
 
 FT_Library  library = NULL;    /* handle to library     */
 FT_Face     face;                /* handle to face object */
 
+/* Glyph cache: glyphs are kept for the process lifetime so that measuring and
+ * re-rendering the same text does not go through FreeType again.
+ * Entries are keyed by face, glyph index and the face scale (i.e. the char size).
+ * An entry may hold metrics only (filled by string measurement); the coverage
+ * bitmap is added the first time the glyph is actually rendered.
+ * Must be a power of 2. */
+#define FR_GLYPH_CACHE_SIZE 256
+
+typedef struct {
+  FT_Face face;
+  FT_UInt glyphIndex;
+  FT_Fixed xScale;
+  FT_Fixed yScale;
+  int bitmapLeft;
+  int bitmapTop;
+  int width;
+  int rows;
+  FT_Pos advanceX;
+  FT_Pos advanceY;
+  unsigned char *buffer;    /* width * rows coverage bytes, no padding */
+  int hasBitmap;
+  int valid;
+} frCachedGlyph;
+
+static frCachedGlyph glyphCache[FR_GLYPH_CACHE_SIZE];
+static fr_glyphCacheStats glyphCacheStats;
+
+/* Pre-baked atlas, mmap()-ed read only. FreeType is only initialized, from the
+ * fallback font parameters, when a glyph missing in the atlas is requested. */
+typedef struct {
+  const unsigned char *pMap;
+  size_t mapSize;
+  const fr_atlasHeader *pHeader;
+  const fr_atlasGlyph *pGlyphs;
+  char fallbackFontFile[256];
+  int fallbackPointSize;
+  int fallbackDpi;
+  int fallbackFailed;
+} frAtlasData;
+
+static frAtlasData atlas;
+
 /* Utility function to calculate the dpi based on the display physical properties */
 int ftCalcDpi(int width_mm, int height_mm, int resolution_width, int resolution_height) {
 
@@ -32,56 +83,243 @@ int ftCalcDpi(int width_mm, int height_mm, int resolution_width, int resolution_
     return (int)(diagonal_pixels / diagonal_inches);
 }
 
-static void draw_bitmap(FT_GlyphSlot slot, fr_textBox BBox, fr_penPos penPos, fr_textBox *textDirtyRect, fr_grBufferProps buffData ) {
-  FT_Bitmap*  bitmap = &slot->bitmap;
-  FT_Int      dest_x, dest_y; //Loop vars
-  FT_Int      x_max, y_max; //Loop vars
-  FT_Int	  x, y;
-  unsigned char * srcBuffer = bitmap->buffer;
-  int rgbaVal = 0xff;
+// Grows the dirty rectangle to also cover x, y, width, height. An empty dirty rectangle has bb_width 0.
+static void frExtendDirtyRect(fr_textBox *pDirtyRect, int x, int y, int width, int height) {
+  int x2, y2;
 
- // _uint8 *fr_pix_buf_data = buffData.fr_pix_buf_data
+  if (pDirtyRect->bb_width <= 0) {
+    pDirtyRect->bb_start_x = x;
+    pDirtyRect->bb_start_y = y;
+    pDirtyRect->bb_width = width;
+    pDirtyRect->bb_height = height;
+    return;
+  }
+  x2 = pDirtyRect->bb_start_x + pDirtyRect->bb_width;
+  y2 = pDirtyRect->bb_start_y + pDirtyRect->bb_height;
+  if (x + width > x2) x2 = x + width;
+  if (y + height > y2) y2 = y + height;
+  if (x < pDirtyRect->bb_start_x) pDirtyRect->bb_start_x = x;
+  if (y < pDirtyRect->bb_start_y) pDirtyRect->bb_start_y = y;
+  pDirtyRect->bb_width = x2 - pDirtyRect->bb_start_x;
+  pDirtyRect->bb_height = y2 - pDirtyRect->bb_start_y;
+}
 
-  dest_x = BBox.bb_start_x + penPos.pen_x / 64 + slot->bitmap_left;
-  dest_y = BBox.bb_start_y + penPos.pen_y / 64 - slot->bitmap_top;
+// Blits (or blends) the glyph coverage into the buffer row by row, clipped to the text bounding box.
+// The pixels actually written are added to textDirtyRect.
+static void draw_bitmap(const frCachedGlyph *glyph, fr_textBox BBox, fr_penPos penPos, fr_textBox *textDirtyRect, fr_grBufferProps buffData ) {
+  int dest_x, dest_y;
+  int x_min, x_max, y_min, y_max;
+  int y;
+  int stride;
+  _uint8 *pDestRow;
+  const unsigned char *pSrcRow;
+
+  if (buffData.fr_bpp != 4) {
+    log_message(LOG_ERROR, "draw_bitmap() supports 4 bytes per pixel only, got fr_bpp:%d", buffData.fr_bpp);
+    return;
+  }
+  stride = (buffData.fr_stride != 0) ? buffData.fr_stride : buffData.fr_buf_size_x * buffData.fr_bpp;
 
+  dest_x = BBox.bb_start_x + penPos.pen_x / 64 + glyph->bitmapLeft;
+  dest_y = BBox.bb_start_y + penPos.pen_y / 64 - glyph->bitmapTop;
 
-  if (dest_x + bitmap->width <= BBox.bb_start_x + BBox.bb_width) {
-    x_max =  bitmap->width;
-  } else {
+  // Glyph relative clip range
+  x_min = (dest_x < BBox.bb_start_x) ? BBox.bb_start_x - dest_x : 0;
+  y_min = (dest_y < BBox.bb_start_y) ? BBox.bb_start_y - dest_y : 0;
+  x_max = glyph->width;
+  if (dest_x + x_max > BBox.bb_start_x + BBox.bb_width) {
     x_max = BBox.bb_start_x + BBox.bb_width - dest_x;
   }
+  y_max = glyph->rows;
+  if (dest_y + y_max > BBox.bb_start_y + BBox.bb_height) {
+    y_max = BBox.bb_start_y + BBox.bb_height - dest_y;
+  }
+  if ((x_min >= x_max) || (y_min >= y_max)) {
+    return;
+  }
+
+  //log_message(LOG_DEBUG, "draw_bitmap: dest_x:%d, dest_y:%d, x:%d..%d, y:%d..%d", dest_x, dest_y, x_min, x_max, y_min, y_max);
+  frExtendDirtyRect(textDirtyRect, dest_x + x_min, dest_y + y_min, x_max - x_min, y_max - y_min);
 
-  if (dest_y + bitmap->rows <= BBox.bb_start_y + BBox.bb_height) {
-    y_max =  bitmap->rows;
+  pDestRow = buffData.fr_pix_buf_data + (dest_y + y_min) * stride + (dest_x + x_min) * buffData.fr_bpp;
+  pSrcRow = glyph->buffer + y_min * glyph->width + x_min;
+  if (buffData.fr_composeMode == fr_Compose_Blend) {
+    for (y = y_min; y < y_max; y++) {
+      pkBlendCoverageRgbx((uint32_t *)pDestRow, pSrcRow, x_max - x_min, buffData.fr_fgColor);
+      pDestRow += stride;
+      pSrcRow += glyph->width;
+    }
   } else {
-    y_max = BBox.bb_start_y + BBox.bb_height - dest_y;
+    for (y = y_min; y < y_max; y++) {
+      pkCoverageToRgbx((uint32_t *)pDestRow, pSrcRow, x_max - x_min);
+      pDestRow += stride;
+      pSrcRow += glyph->width;
+    }
+  }
+}
+
+
+static void frReleaseCachedGlyph(frCachedGlyph *pGlyph) {
+  if (pGlyph->buffer != NULL) {
+    free(pGlyph->buffer);
+  }
+  memset(pGlyph, 0, sizeof(frCachedGlyph));
+}
+
+void frFlushGlyphCache(void) {
+  int i;
+
+  for (i = 0; i < FR_GLYPH_CACHE_SIZE; i++) {
+    if (glyphCache[i].valid) {
+      frReleaseCachedGlyph(&glyphCache[i]);
+    }
+  }
+}
+
+void frGetGlyphCacheStats(fr_glyphCacheStats *pStats) {
+  *pStats = glyphCacheStats;
+}
+
+// Loads the glyph outline (no rasterization) and fills in the bitmap box a later
+// FT_Render_Glyph() would produce: cbox grid-fitted to whole pixels.
+static int frLoadGlyphMetrics(FT_UInt glyphIndex, frCachedGlyph *pEntry) {
+  FT_GlyphSlot slot;
+  FT_BBox cbox;
+  FT_Error error;
+
+  error = FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT);
+  if (error) {
+    log_message(LOG_DEBUG, "frLoadGlyphMetrics::FT_Load_Glyph(glyph:%u) returned %d", glyphIndex, error);
+    return -1;
   }
+  slot = face->glyph;
+
+  if (slot->format == FT_GLYPH_FORMAT_OUTLINE) {
+    FT_Outline_Get_CBox(&slot->outline, &cbox);
+    pEntry->bitmapLeft = cbox.xMin >> 6;
+    pEntry->bitmapTop = (cbox.yMax + 63) >> 6;
+    pEntry->width = ((cbox.xMax + 63) >> 6) - pEntry->bitmapLeft;
+    pEntry->rows = pEntry->bitmapTop - (cbox.yMin >> 6);
+  } else {
+    // Embedded bitmaps come with their final dimensions already
+    pEntry->bitmapLeft = slot->bitmap_left;
+    pEntry->bitmapTop = slot->bitmap_top;
+    pEntry->width = slot->bitmap.width;
+    pEntry->rows = slot->bitmap.rows;
+  }
+  pEntry->advanceX = slot->advance.x;
+  pEntry->advanceY = slot->advance.y;
 
+  return 0;
+}
 
-  //log_message(LOG_DEBUG, "draw_bitmap before loop: x:%d, y:%d, x_max:%d, y_max:%d  ", x, y, x_max, y_max);
+// Rasterizes the glyph and stores its coverage bitmap in the cache entry.
+static int frLoadGlyphBitmap(FT_UInt glyphIndex, frCachedGlyph *pEntry) {
+  FT_GlyphSlot slot;
+  FT_Error error;
+  int row;
 
+  error = FT_Load_Glyph(face, glyphIndex, FT_LOAD_RENDER);
+  if (error) {
+    log_message(LOG_DEBUG, "frLoadGlyphBitmap::FT_Load_Glyph(glyph:%u) returned %d", glyphIndex, error);
+    return -1;
+  }
+  glyphCacheStats.rasterized++;
+  slot = face->glyph;
+
+  pEntry->width = slot->bitmap.width;
+  pEntry->rows = slot->bitmap.rows;
+  if (pEntry->width * pEntry->rows > 0) {
+    pEntry->buffer = malloc(pEntry->width * pEntry->rows);
+    if (pEntry->buffer == NULL) {
+      log_message(LOG_ERROR, "frLoadGlyphBitmap: Memory allocation failed for %dx%d glyph bitmap", pEntry->width, pEntry->rows);
+      return -1;
+    }
+    // Bitmap pitch may be padded (or negative for bottom-up bitmaps). Store rows tightly packed.
+    for (row = 0; row < pEntry->rows; row++) {
+      const unsigned char *srcRow = (slot->bitmap.pitch >= 0) ? slot->bitmap.buffer + row * slot->bitmap.pitch
+                                                              : slot->bitmap.buffer + (pEntry->rows - 1 - row) * (-slot->bitmap.pitch);
+      memcpy(pEntry->buffer + row * pEntry->width, srcRow, pEntry->width);
+    }
+  }
+  pEntry->bitmapLeft = slot->bitmap_left;
+  pEntry->bitmapTop = slot->bitmap_top;
+  pEntry->advanceX = slot->advance.x;
+  pEntry->advanceY = slot->advance.y;
+  pEntry->hasBitmap = 1;
 
-  for (y=0; y < y_max; y++) {
-	if (dest_y >= BBox.bb_start_y) {
-      for (x=0; x < x_max; x++) {
-        rgbaVal = 0xff << 24 | srcBuffer[y*(bitmap->width) + x] | srcBuffer[y*(bitmap->width) + x] << 8 | srcBuffer[y*(bitmap->width) + x] << 16;
-        //*(int *)&fr_pix_buf_data[((dest_y + y) * fr_buf_size_x * fr_bpp) + ((dest_x + x) * fr_bpp)] = rgbaVal;
-        *(int *)&(buffData.fr_pix_buf_data)[((dest_y + y) * buffData.fr_buf_size_x * buffData.fr_bpp) + ((dest_x + x) * buffData.fr_bpp)] = rgbaVal;
+  return 0;
+}
+
+// Returns the cached glyph for a character, going through FreeType only on a cache miss.
+// With needBitmap == 0 only the metrics are guaranteed, and the glyph is never rasterized.
+// Returns NULL if the glyph cannot be loaded.
+static const frCachedGlyph *frGetCachedGlyph(unsigned long charCode, int needBitmap) {
+  FT_UInt glyphIndex;
+  FT_Fixed xScale = face->size->metrics.x_scale;
+  FT_Fixed yScale = face->size->metrics.y_scale;
+  frCachedGlyph *pEntry = NULL;
+  unsigned int hash;
+  int probe;
+
+  glyphIndex = FT_Get_Char_Index(face, charCode);
+  hash = (glyphIndex * 2654435761u) ^ (unsigned int)xScale ^ ((unsigned int)yScale << 1);
+
+  // Linear probing. When all probed slots are taken, the home slot gets evicted.
+  for (probe = 0; probe < 8; probe++) {
+    frCachedGlyph *pSlot = &glyphCache[(hash + probe) & (FR_GLYPH_CACHE_SIZE - 1)];
+    if (!pSlot->valid) {
+      pEntry = pSlot;
+      break;
+    }
+    if ((pSlot->face == face) && (pSlot->glyphIndex == glyphIndex) && (pSlot->xScale == xScale) && (pSlot->yScale == yScale)) {
+      if (pSlot->hasBitmap || !needBitmap) {
+        glyphCacheStats.hits++;
+        return pSlot;
       }
+      // Measured before, never rendered: add the bitmap to the existing entry
+      glyphCacheStats.misses++;
+      if (frLoadGlyphBitmap(glyphIndex, pSlot) != 0) {
+        frReleaseCachedGlyph(pSlot);
+        return NULL;
+      }
+      return pSlot;
     }
   }
+  if (pEntry == NULL) {
+    pEntry = &glyphCache[hash & (FR_GLYPH_CACHE_SIZE - 1)];
+    frReleaseCachedGlyph(pEntry);
+  }
+
+  glyphCacheStats.misses++;
+  if (((needBitmap) ? frLoadGlyphBitmap(glyphIndex, pEntry) : frLoadGlyphMetrics(glyphIndex, pEntry)) != 0) {
+    frReleaseCachedGlyph(pEntry);
+    return NULL;
+  }
+  pEntry->face = face;
+  pEntry->glyphIndex = glyphIndex;
+  pEntry->xScale = xScale;
+  pEntry->yScale = yScale;
+  pEntry->valid = 1;
+
+  return pEntry;
 }
 
 
-int ftInitFont(char *fontFile, int point_size, int dpi) {
+// Loads the font face. Independent of the display, so it can run before the DPI is known.
+int ftOpenFont(char *fontFile) {
 	FT_Error error = -1;
 
-	error = FT_Init_FreeType( &library );
-    if ( error ) {
- 	   log_message(LOG_ERROR, "FT_Init_FreeType() returned %d ", error);
- 	   return fr_Err_FtInit;
-    }
+	frFlushGlyphCache();
+
+	if (library == NULL) {
+		error = FT_Init_FreeType( &library );
+		if ( error ) {
+			log_message(LOG_ERROR, "FT_Init_FreeType() returned %d ", error);
+			library = NULL;
+			return fr_Err_FtInit;
+		}
+	}
 
     error = FT_New_Face( library,
                          fontFile,
@@ -90,9 +328,21 @@ int ftInitFont(char *fontFile, int point_size, int dpi) {
     if ( error )
     {
   	   log_message(LOG_ERROR, "FT_New_Face() returned %d ", error);
+  	   face = NULL;
  	   return fr_Err_FtFace;
     }
 
+    return fr_OK;
+}
+
+// Sizes the face opened by ftOpenFont() for the display.
+int ftSetFontSize(int point_size, int dpi) {
+	FT_Error error = -1;
+
+	if (face == NULL) {
+		return fr_Err_FtFace;
+	}
+
     error = FT_Set_Char_Size (
             face,     			/* handle to face object           */
             point_size * 64, 	/* char_width in 1/64th of points. A point is a physical distance, equaling 1/72th of an inch; it is not a pixel.  */
@@ -108,6 +358,151 @@ int ftInitFont(char *fontFile, int point_size, int dpi) {
     return fr_OK;
 }
 
+int ftInitFont(char *fontFile, int point_size, int dpi) {
+	int result;
+
+	result = ftOpenFont(fontFile);
+	if (result == fr_OK) {
+		result = ftSetFontSize(point_size, dpi);
+	}
+
+	return result;
+}
+
+// Checks that everything the header and glyph table reference lies inside the mapped file
+static int frValidateAtlas(const unsigned char *pMap, size_t mapSize) {
+  const fr_atlasHeader *pHeader = (const fr_atlasHeader *)pMap;
+  const fr_atlasGlyph *pGlyphs = (const fr_atlasGlyph *)(pMap + sizeof(fr_atlasHeader));
+  size_t tableEnd;
+  uint32_t i;
+
+  if (mapSize < sizeof(fr_atlasHeader)) {
+    log_message(LOG_ERROR, "frValidateAtlas: file too small: %zu", mapSize);
+    return -1;
+  }
+  if ((pHeader->magic != FR_ATLAS_MAGIC) || (pHeader->version != FR_ATLAS_VERSION)) {
+    log_message(LOG_ERROR, "frValidateAtlas: bad magic 0x%08x or version %u", pHeader->magic, pHeader->version);
+    return -2;
+  }
+  tableEnd = sizeof(fr_atlasHeader) + (size_t)pHeader->glyphCount * sizeof(fr_atlasGlyph);
+  if ((pHeader->fileSize != mapSize) || (tableEnd > pHeader->dataOffset) || (pHeader->dataOffset > mapSize)) {
+    log_message(LOG_ERROR, "frValidateAtlas: inconsistent sizes: fileSize:%u, mapped:%zu, glyphs:%u, dataOffset:%u", pHeader->fileSize, mapSize, pHeader->glyphCount, pHeader->dataOffset);
+    return -3;
+  }
+  for (i = 0; i < pHeader->glyphCount; i++) {
+    if ((size_t)pHeader->dataOffset + pGlyphs[i].offset + (size_t)pGlyphs[i].width * pGlyphs[i].rows > mapSize) {
+      log_message(LOG_ERROR, "frValidateAtlas: glyph 0x%x coverage data out of file bounds", pGlyphs[i].charCode);
+      return -4;
+    }
+    if ((i > 0) && (pGlyphs[i].charCode <= pGlyphs[i - 1].charCode)) {
+      log_message(LOG_ERROR, "frValidateAtlas: glyph table not sorted at index %u", i);
+      return -5;
+    }
+  }
+
+  return 0;
+}
+
+int ftInitAtlas(const char *atlasFile, char *fontFile, int point_size, int dpi) {
+  struct stat fileStat;
+  void *pMap;
+  int fd;
+
+  memset(&atlas, 0, sizeof(atlas));
+  strncpy(atlas.fallbackFontFile, fontFile, sizeof(atlas.fallbackFontFile) - 1);
+  atlas.fallbackPointSize = point_size;
+  atlas.fallbackDpi = dpi;
+
+  fd = open(atlasFile, O_RDONLY);
+  if (fd < 0) {
+    log_message(LOG_ERROR, "ftInitAtlas::open(%s) failed: %s", atlasFile, strerror(errno));
+    return fr_Err_Atlas;
+  }
+  if (fstat(fd, &fileStat) != 0) {
+    log_message(LOG_ERROR, "ftInitAtlas::fstat(%s) failed: %s", atlasFile, strerror(errno));
+    close(fd);
+    return fr_Err_Atlas;
+  }
+  pMap = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (pMap == MAP_FAILED) {
+    log_message(LOG_ERROR, "ftInitAtlas::mmap(%s) failed: %s", atlasFile, strerror(errno));
+    return fr_Err_Atlas;
+  }
+
+  if (frValidateAtlas(pMap, fileStat.st_size) != 0) {
+    munmap(pMap, fileStat.st_size);
+    return fr_Err_Atlas;
+  }
+  atlas.pHeader = (const fr_atlasHeader *)pMap;
+  if ((atlas.pHeader->pointSize != point_size) || (atlas.pHeader->dpi != dpi)) {
+    log_message(LOG_WARNING, "ftInitAtlas: %s was baked for %upt@%udpi, %dpt@%ddpi requested. Atlas not used.", atlasFile, atlas.pHeader->pointSize, atlas.pHeader->dpi, point_size, dpi);
+    munmap(pMap, fileStat.st_size);
+    atlas.pHeader = NULL;
+    return fr_Err_Atlas;
+  }
+
+  atlas.pMap = pMap;
+  atlas.mapSize = fileStat.st_size;
+  atlas.pGlyphs = (const fr_atlasGlyph *)(atlas.pMap + sizeof(fr_atlasHeader));
+  log_message(LOG_INFO, "ftInitAtlas: %s mapped, %u glyphs, %zu bytes", atlasFile, atlas.pHeader->glyphCount, atlas.mapSize);
+
+  return fr_OK;
+}
+
+// Binary search of the sorted atlas glyph table
+static const fr_atlasGlyph *frFindAtlasGlyph(unsigned long charCode) {
+  int low = 0;
+  int high = (int)atlas.pHeader->glyphCount - 1;
+
+  while (low <= high) {
+    int mid = (low + high) / 2;
+    if (atlas.pGlyphs[mid].charCode == charCode) {
+      return &atlas.pGlyphs[mid];
+    } else if (atlas.pGlyphs[mid].charCode < charCode) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return NULL;
+}
+
+// Glyph lookup for measuring and rendering: atlas first, then the FreeType backed cache.
+// Atlas glyphs are returned through pScratch, pointing straight into the mapped file.
+static const frCachedGlyph *frGetGlyph(unsigned long charCode, int needBitmap, frCachedGlyph *pScratch) {
+  const fr_atlasGlyph *pAtlasGlyph;
+
+  if (atlas.pMap != NULL) {
+    pAtlasGlyph = frFindAtlasGlyph(charCode);
+    if (pAtlasGlyph != NULL) {
+      glyphCacheStats.atlasHits++;
+      pScratch->bitmapLeft = pAtlasGlyph->bitmapLeft;
+      pScratch->bitmapTop = pAtlasGlyph->bitmapTop;
+      pScratch->width = pAtlasGlyph->width;
+      pScratch->rows = pAtlasGlyph->rows;
+      pScratch->advanceX = pAtlasGlyph->advanceX;
+      pScratch->advanceY = pAtlasGlyph->advanceY;
+      pScratch->buffer = (unsigned char *)atlas.pMap + atlas.pHeader->dataOffset + pAtlasGlyph->offset;
+      pScratch->hasBitmap = 1;
+      return pScratch;
+    }
+    if ((face == NULL) && (!atlas.fallbackFailed)) {
+      log_message(LOG_INFO, "Glyph 0x%lx not in atlas, initializing FreeType with %s", charCode, atlas.fallbackFontFile);
+      if (ftInitFont(atlas.fallbackFontFile, atlas.fallbackPointSize, atlas.fallbackDpi) != fr_OK) {
+        atlas.fallbackFailed = 1;
+        face = NULL;
+      }
+    }
+  }
+
+  if (face == NULL) {
+    return NULL;
+  }
+  return frGetCachedGlyph(charCode, needBitmap);
+}
+
+
 //@fix: This is a Debug function to help text render calculations. Either delete or add handling of different image data modes
 void frDrawBoundBox(fr_textBox textBBox, int rgbaVal, fr_grBufferProps buffData) {
 	int x;
@@ -142,31 +537,30 @@ void frDrawBoundBox(fr_textBox textBBox, int rgbaVal, fr_grBufferProps buffData)
 
 //int ftRender(fr_textBox textBoundBox, fr_penPos penPos, fr_textBox *textDirtyRect, const char* text) {
 int ftRender(fr_grBufferProps buffData, fr_canvasProps *pftCanvasProps, const char* text) {
-    FT_GlyphSlot  slot;
-    FT_Error      error;
+    const frCachedGlyph *glyph;
+    frCachedGlyph atlasGlyph;
     int           n;
     size_t        strLen = strlen(text);
 
-    if (face == NULL) {
-        log_message(LOG_ERROR, "ftRender() called with NULL face. Is FT Uninit?");
+    if ((face == NULL) && (atlas.pMap == NULL)) {
+        log_message(LOG_ERROR, "ftRender() called with NULL face and no atlas. Is FT Uninit?");
     	return fr_Err_Generic;
     } else {
-        slot = face->glyph;
-
     	//frDrawBoundBox(textBoundBox, 0x7F7F7F7F);
+        memset(&(pftCanvasProps->txtDirtyRect), 0, sizeof(fr_textBox));
 
         for ( n = 0; n < strLen; n++ )
         {
-          /* load glyph image into the slot (erase previous one) */
-          error = FT_Load_Char(face, text[n], FT_LOAD_RENDER);
-          if ( error ) continue;  /* ignore errors */
+          /* get the rasterized glyph, from the atlas or the cache if possible */
+          glyph = frGetGlyph((unsigned char)text[n], 1, &atlasGlyph);
+          if ( glyph == NULL ) continue;  /* ignore errors */
 
           /* now, draw to our target surface */
-          draw_bitmap(slot, pftCanvasProps->txtBoundBox, pftCanvasProps->penPos, &(pftCanvasProps->txtDirtyRect), buffData);
+          draw_bitmap(glyph, pftCanvasProps->txtBoundBox, pftCanvasProps->penPos, &(pftCanvasProps->txtDirtyRect), buffData);
 
           /* increment pen position */
-          pftCanvasProps->penPos.pen_x += slot->advance.x;
-          pftCanvasProps->penPos.pen_y += slot->advance.y;
+          pftCanvasProps->penPos.pen_x += glyph->advanceX;
+          pftCanvasProps->penPos.pen_y += glyph->advanceY;
 
         }
         return fr_OK;
@@ -174,6 +568,40 @@ int ftRender(fr_grBufferProps buffData, fr_canvasProps *pftCanvasProps, const ch
 }
 
 
+// Height a text line can take at the current font size, in pixels: the same measure as strHeight of
+// frCalcStrPixelSize() for a string holding the font's tallest and deepest glyphs. Used to size text
+// surfaces once; a string can still exceed it with glyphs reaching beyond the font's ascender/descender.
+int frGetLineHeight(void) {
+    int maxTop = 0;
+    int minBottom = 0;
+    unsigned int i;
+
+    if (atlas.pMap != NULL) {
+        for (i = 0; i < atlas.pHeader->glyphCount; i++) {
+            if (atlas.pGlyphs[i].bitmapTop > maxTop) {
+                maxTop = atlas.pGlyphs[i].bitmapTop;
+            }
+            if (atlas.pGlyphs[i].bitmapTop - atlas.pGlyphs[i].rows < minBottom) {
+                minBottom = atlas.pGlyphs[i].bitmapTop - atlas.pGlyphs[i].rows;
+            }
+        }
+    }
+    if ((face != NULL) && (face->size != NULL)) {
+        // 26.6 metrics, rounded outwards
+        if ((int)((face->size->metrics.ascender + 63) >> 6) > maxTop) {
+            maxTop = (face->size->metrics.ascender + 63) >> 6;
+        }
+        if ((int)(face->size->metrics.descender >> 6) < minBottom) {
+            minBottom = face->size->metrics.descender >> 6;
+        }
+    }
+
+    return maxTop - minBottom;
+}
+
+
+// Calculates the string bounding box from glyph metrics only. Nothing gets rasterized here, so
+// the box can be sized before any pixel work. Gives the same box as the rendered bitmaps would.
 void frCalcStrPixelSize(int* penPos_y, int* strWidth, int* strHeight, const char* textStr) {
     *strWidth = 0;
     *strHeight = 0;
@@ -185,29 +613,35 @@ void frCalcStrPixelSize(int* penPos_y, int* strWidth, int* strHeight, const char
     int minBitmapBearringY = 0;
     int maxBitmapHeight = 0;
 
+    if ((face == NULL) && (atlas.pMap == NULL)) {
+        log_message(LOG_ERROR, "frCalcStrPixelSize() called with NULL face and no atlas. Is FT Uninit?");
+        *penPos_y = 0;
+        return;
+    }
+
     for (const char* p = textStr; *p; p++) {
-        if (FT_Load_Char(face, *p, FT_LOAD_RENDER)) {
+        frCachedGlyph atlasGlyph;
+        const frCachedGlyph *glyph = frGetGlyph((unsigned char)*p, 0, &atlasGlyph);
+        if (glyph == NULL) {
             continue; // Skip glyph if it cannot be loaded
         }
 
-        FT_GlyphSlot glyph = face->glyph;
-
         // Update width and height
-        pen_x += glyph->advance.x >> 6;
-        pen_y += glyph->advance.y >> 6;
+        pen_x += glyph->advanceX >> 6;
+        pen_y += glyph->advanceY >> 6;
 
         //Find the highest point in all glyphs
-        if (glyph->bitmap_top > maxBitmapBearringY) {
-            maxBitmapBearringY = glyph->bitmap_top;
+        if (glyph->bitmapTop > maxBitmapBearringY) {
+            maxBitmapBearringY = glyph->bitmapTop;
         }
         // Find the lowest point in all glyphs. looking for a negative number, so init to 0 is OK.
-        if ((int)glyph->bitmap_top - (int)glyph->bitmap.rows < (int)minBitmapBearringY) {
-            minBitmapBearringY = glyph->bitmap_top - glyph->bitmap.rows;
+        if (glyph->bitmapTop - glyph->rows < minBitmapBearringY) {
+            minBitmapBearringY = glyph->bitmapTop - glyph->rows;
         }
 
         //Store the largest bitmap height
-        if (glyph->bitmap.rows > maxBitmapHeight) {
-            maxBitmapHeight = glyph->bitmap.rows;
+        if (glyph->rows > maxBitmapHeight) {
+            maxBitmapHeight = glyph->rows;
         }
     }
 
@@ -215,7 +649,7 @@ void frCalcStrPixelSize(int* penPos_y, int* strWidth, int* strHeight, const char
     *strWidth = pen_x;
     *strHeight = maxBitmapBearringY + (-minBitmapBearringY);
     if (*strHeight < maxBitmapHeight) {
-        log_message(LOG_ERROR, "frCalcStrPixelSize() calculated strHeight=%d less than maxBitmapHeight=%d", strHeight, maxBitmapHeight);
+        log_message(LOG_ERROR, "frCalcStrPixelSize() calculated strHeight=%d less than maxBitmapHeight=%d", *strHeight, maxBitmapHeight);
 
     }
 }
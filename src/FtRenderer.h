@@ -8,6 +8,14 @@
 #ifndef SRC_LIB_IMGLIB_IMGLIB_FTRENDER_H_
 #define SRC_LIB_IMGLIB_IMGLIB_FTRENDER_H_
 
+#include <stdint.h>
+
+#ifdef __QNX__
+ #include <sys/platform.h>
+#else
+typedef uint8_t _uint8;
+#endif
+
 typedef struct {
   int bb_start_x;
   int bb_start_y;
@@ -22,30 +30,52 @@ typedef struct {
 
 typedef struct {
   fr_textBox txtBoundBox;
-  fr_textBox txtDirtyRect;
+  fr_textBox txtDirtyRect;   /* Set by ftRender(): pixels written by the glyphs, bb_width 0 if none */
   fr_penPos penPos;
 } fr_canvasProps;
 
+typedef enum {
+  fr_Compose_Opaque = 0,  /* Gray coverage written as opaque pixels, for a cleared text buffer */
+  fr_Compose_Blend        /* Foreground color blended over the existing buffer pixels */
+} frComposeMode;
+
 typedef struct {
   _uint8 *fr_pix_buf_data;
   int fr_buf_size_x;
   int fr_buf_size_y;
   int fr_bpp;
+  int fr_stride;  /* Bytes per buffer row. 0 means fr_buf_size_x * fr_bpp */
+  frComposeMode fr_composeMode;
+  unsigned int fr_fgColor;  /* 0x00RRGGBB, fr_Compose_Blend only */
 } fr_grBufferProps;
 
+typedef struct {
+  unsigned long atlasHits;   /* Glyph served from the pre-baked atlas */
+  unsigned long hits;        /* Glyph found in the cache */
+  unsigned long misses;      /* Glyph had to be loaded through FreeType */
+  unsigned long rasterized;  /* FreeType rasterizations (FT_LOAD_RENDER) performed */
+} fr_glyphCacheStats;
+
 typedef enum {
 	fr_OK,
 	fr_Err_Generic,
 	fr_Err_FtInit,
 	fr_Err_FtFace,
-	fr_Err_FtSetCharSize
+	fr_Err_FtSetCharSize,
+	fr_Err_Atlas
 } frErrorType;
 
 int ftCalcDpi(int width_mm, int height_mm, int resolution_width, int resolution_height);
 int ftInitDestBuffer (_uint8 *pix_buf_data, int buf_size_x, int buf_size_y, int bpp);
+int ftOpenFont(char *fontFile);
+int ftSetFontSize(int point_size, int dpi);
 int ftInitFont(char *fontFile, int point_size, int dpi);
+int ftInitAtlas(const char *atlasFile, char *fontFile, int point_size, int dpi);
 int ftRender(fr_grBufferProps buffData, fr_canvasProps *pftCanvasProps, const char* text);
 void frCalcStrPixelSize(int* penPos_y, int* strWidth, int* strHeight, const char* textStr);
+int frGetLineHeight(void);
+void frGetGlyphCacheStats(fr_glyphCacheStats *pStats);
+void frFlushGlyphCache(void);
 
 
 #endif /* SRC_LIB_IMGLIB_IMGLIB_FTRENDER_H_ */
@@ -0,0 +1,102 @@
+/*
+ * GfxBackend.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Window, pixmap, blit and post operations used by ImgLib, behind a table of
+ *  function pointers. Two implementations:
+ *   - gfxScreenBackend: QNX Screen (QNX builds only).
+ *   - gfxSoftBackend: in-memory RGBX8888 buffers with a software blit engine.
+ *     Builds and runs anywhere, so the whole pipeline can be profiled off target.
+ *  Buffers are in one of the display formats of PixFormat.h: XRGB8888 (Screen's RGBX8888)
+ *  or RGB565; blits convert between them. Functions return EOK (0) or a negative error.
+ */
+
+#ifndef SRC_GFXBACKEND_H_
+#define SRC_GFXBACKEND_H_
+
+#include <stdint.h>
+
+#include "PixFormat.h"
+
+#ifndef EOK
+ #define EOK 0
+#endif
+
+#define GFX_MAX_WIN_BUFFERS 3
+
+typedef struct gfxContext_s *gfxContext;
+typedef struct gfxWindow_s *gfxWindow;
+typedef struct gfxPixmap_s *gfxPixmap;
+typedef struct gfxBuffer_s *gfxBuffer;
+
+typedef enum {
+  gfx_Transparency_None = 0,   /* Source replaces destination (global alpha still applies) */
+  gfx_Transparency_SourceOver  /* Source alpha channel blended over destination */
+} gfxTransparency;
+
+typedef enum {
+  gfx_Quality_Fastest = 0,     /* Nearest neighbour when scaling */
+  gfx_Quality_Nicest           /* Filtered when scaling */
+} gfxScaleQuality;
+
+typedef struct {
+  int srcX, srcY, srcWidth, srcHeight;
+  int dstX, dstY, dstWidth, dstHeight;
+  int globalAlpha;             /* 0..255 */
+  gfxTransparency transparency;
+  gfxScaleQuality quality;
+} gfxBlitParams;
+
+typedef struct {
+  void *pData;
+  int width;
+  int height;
+  int stride;                  /* Bytes per row */
+  ePixFormats format;
+} gfxBufferInfo;
+
+typedef struct {
+  const char *name;
+
+  int  (*createContext)(gfxContext *pCtx);
+  void (*destroyContext)(gfxContext ctx);
+
+  /* format: of the window buffers, a display format. *pRotation: degrees clockwise, 0/90/180/270.
+     Returns the window and buffer sizes, and in *pRotation the part of the rotation the display
+     does not apply, for the caller to apply in software. */
+  int  (*createWindow)(gfxContext ctx, ePixFormats format, int *pRotation, gfxWindow *pWin, int *winSize, int *bufferSize);
+  void (*destroyWindow)(gfxWindow win);
+  /* Creates count buffers; pBuffers[0] is the first one to render into. */
+  int  (*createWindowBuffers)(gfxWindow win, int count, gfxBuffer *pBuffers);
+  /* Shows the window and posts buf. dirtyRect is x, y, width, height. */
+  int  (*postWindow)(gfxWindow win, gfxBuffer buf, const int *dirtyRect);
+  /* Buffer to render the next frame into, after a post. */
+  int  (*getRenderBuffer)(gfxWindow win, gfxBuffer *pBuf);
+  /* Display resolution in dots per inch, 0 if unknown. */
+  int  (*getDisplayDpi)(gfxWindow win, int *pDpi);
+
+  int  (*createPixmap)(gfxContext ctx, gfxPixmap *pPix);
+  void (*destroyPixmap)(gfxPixmap pix);
+  int  (*createPixmapBuffer)(gfxPixmap pix, int width, int height, ePixFormats format, gfxBuffer *pBuf);
+  void (*destroyPixmapBuffer)(gfxPixmap pix);
+
+  int  (*getBufferInfo)(gfxBuffer buf, gfxBufferInfo *pInfo);
+  int  (*blit)(gfxContext ctx, gfxBuffer dst, gfxBuffer src, const gfxBlitParams *pParams);
+  /* rect is x, y, width, height; color is 0xAARRGGBB */
+  int  (*fill)(gfxContext ctx, gfxBuffer dst, const int *rect, uint32_t color);
+  /* Waits until queued blits and fills have landed in the buffers. */
+  int  (*finish)(gfxContext ctx);
+} gfxBackendOps;
+
+#ifdef __QNX__
+extern const gfxBackendOps gfxScreenBackend;
+#endif
+extern const gfxBackendOps gfxSoftBackend;
+
+/* Software backend only: window size and DPI it reports, and an optional
+ * file each posted frame is written to as binary PPM. Call before createWindow. */
+void gfxSoftConfigure(int width, int height, int dpi, const char *outFile);
+
+#endif /* SRC_GFXBACKEND_H_ */
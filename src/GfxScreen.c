@@ -0,0 +1,415 @@
+/*
+ * GfxScreen.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file GfxScreen.c
+ *
+ *  @brief QNX Screen implementation of the graphics backend.
+ *
+ *
+ ******************************************************************************
+*/
+
+#ifdef __QNX__
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <math.h>
+#include <screen/screen.h>
+#include "errno.h"
+
+#include "logger.h"
+#include "GfxBackend.h"
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+// Screen format of a display format: ePixFmt_XRGB8888 is what Screen calls RGBX8888
+static int scrFormat(ePixFormats format) {
+    return (format == ePixFmt_RGB565) ? SCREEN_FORMAT_RGB565 : SCREEN_FORMAT_RGBX8888;
+}
+
+static void setup_blit_attributes(const gfxBlitParams *pParams, int *attribs) {
+    int index = 0;
+    attribs[index++] = SCREEN_BLIT_SOURCE_X;
+    attribs[index++] = pParams->srcX;
+    attribs[index++] = SCREEN_BLIT_SOURCE_Y;
+    attribs[index++] = pParams->srcY;
+    attribs[index++] = SCREEN_BLIT_SOURCE_WIDTH;
+    attribs[index++] = pParams->srcWidth;
+    attribs[index++] = SCREEN_BLIT_SOURCE_HEIGHT;
+    attribs[index++] = pParams->srcHeight;
+    attribs[index++] = SCREEN_BLIT_DESTINATION_X;
+    attribs[index++] = pParams->dstX;
+    attribs[index++] = SCREEN_BLIT_DESTINATION_Y;
+    attribs[index++] = pParams->dstY;
+    attribs[index++] = SCREEN_BLIT_DESTINATION_WIDTH;
+    attribs[index++] = pParams->dstWidth;
+    attribs[index++] = SCREEN_BLIT_DESTINATION_HEIGHT;
+    attribs[index++] = pParams->dstHeight;
+    attribs[index++] = SCREEN_BLIT_GLOBAL_ALPHA;
+    attribs[index++] = pParams->globalAlpha;
+    attribs[index++] = SCREEN_BLIT_TRANSPARENCY;
+    attribs[index++] = (pParams->transparency == gfx_Transparency_SourceOver) ? SCREEN_TRANSPARENCY_SOURCE_OVER : SCREEN_TRANSPARENCY_NONE;
+    attribs[index++] = SCREEN_BLIT_SCALE_QUALITY;
+    attribs[index++] = (pParams->quality == gfx_Quality_Nicest) ? SCREEN_QUALITY_NICEST : SCREEN_QUALITY_FASTEST;
+    attribs[index++] = SCREEN_BLIT_END;
+}
+
+static int scrCreateContext(gfxContext *pCtx) {
+  int screenIfaceResult;
+
+  screenIfaceResult = screen_create_context((screen_context_t *)pCtx, SCREEN_APPLICATION_CONTEXT);
+  if (screenIfaceResult != EOK) {
+    log_message(LOG_ERROR, "scrCreateContext::screen_create_context() returned non-zero: %d", screenIfaceResult);
+  }
+  return screenIfaceResult;
+}
+
+static void scrDestroyContext(gfxContext ctx) {
+  screen_destroy_context((screen_context_t)ctx);
+}
+
+static int scrCreateWindow(gfxContext ctx, ePixFormats format, int *pRotation, gfxWindow *pWin, int *winSize, int *bufferSize) {
+  const int windowUsage = SCREEN_USAGE_WRITE | SCREEN_USAGE_READ | SCREEN_USAGE_NATIVE | SCREEN_USAGE_ROTATION;
+  const int windowFormat = scrFormat(format);
+  screen_window_t scrWin;
+  int createWindowResult = -1;
+  int screenIfaceResult;
+
+    screenIfaceResult = screen_create_window(&scrWin, (screen_context_t)ctx);
+    if (screenIfaceResult == EOK) {
+      screenIfaceResult = screen_set_window_property_iv(scrWin, SCREEN_PROPERTY_USAGE, &windowUsage);
+      if (screenIfaceResult == EOK) {
+        screenIfaceResult = screen_set_window_property_iv(scrWin, SCREEN_PROPERTY_FORMAT, &windowFormat);
+        if (screenIfaceResult == EOK) {
+          screenIfaceResult = screen_get_window_property_iv(scrWin, SCREEN_PROPERTY_SIZE, winSize);
+          if (screenIfaceResult == EOK) {
+            screenIfaceResult = screen_get_window_property_iv(scrWin, SCREEN_PROPERTY_BUFFER_SIZE, bufferSize);
+            if (screenIfaceResult == EOK) {
+                if (*pRotation != 0 ) {
+                    screenIfaceResult = screen_set_window_property_iv(scrWin, SCREEN_PROPERTY_ROTATION, pRotation);
+                    if (screenIfaceResult == EOK) {
+                        *pRotation = 0;
+                    } else {
+                        //Not fatal: *pRotation is left for the caller to apply in software
+                        log_message(LOG_WARNING, "scrCreateWindow::screen_set_window_property_iv(SCREEN_PROPERTY_ROTATION) returned non-zero: %d ", screenIfaceResult);
+                    }
+                }
+                createWindowResult = 0; //EOK
+            } else {
+                log_message(LOG_ERROR, "scrCreateWindow::screen_get_window_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) returned non-zero: %d ", screenIfaceResult);
+                createWindowResult = -5;
+            }
+          } else {
+              log_message(LOG_ERROR, "scrCreateWindow::screen_get_window_property_iv(SCREEN_PROPERTY_SIZE) returned non-zero: %d ", screenIfaceResult);
+              createWindowResult = -4;
+          }
+        } else {
+          log_message(LOG_ERROR, "scrCreateWindow::screen_set_window_property_iv(SCREEN_PROPERTY_FORMAT) returned non-zero: %d ", screenIfaceResult);
+          createWindowResult = -3;
+        }
+      } else {
+        log_message(LOG_ERROR, "scrCreateWindow::screen_set_window_property_iv(SCREEN_PROPERTY_USAGE) returned non-zero: %d ", screenIfaceResult);
+        createWindowResult = -2;
+      }
+      if (createWindowResult != 0) {
+        screen_destroy_window(scrWin);
+      }
+    } else {
+        log_message(LOG_ERROR, "scrCreateWindow::screen_create_window() returned non-zero: %d ", screenIfaceResult);
+        createWindowResult = -1;
+    }
+
+  *pWin = (createWindowResult == 0) ? (gfxWindow)scrWin : NULL;
+  return createWindowResult;
+}
+
+static void scrDestroyWindow(gfxWindow win) {
+  screen_destroy_window((screen_window_t)win);
+}
+
+static int scrCreateWindowBuffers(gfxWindow win, int count, gfxBuffer *pBuffers) {
+  int createWindowBuffersResult = -1;
+  int screenIfaceResult;
+
+  // More than one buffer: pace posts to the display refresh
+  if (count > 1) {
+    screenIfaceResult = screen_set_window_property_iv((screen_window_t)win, SCREEN_PROPERTY_SWAP_INTERVAL, (int[]){1});
+    if (screenIfaceResult != EOK) {
+      log_message(LOG_WARNING, "scrCreateWindowBuffers::screen_set_window_property_iv(SCREEN_PROPERTY_SWAP_INTERVAL) returned non-zero: %d ", screenIfaceResult);
+    }
+  }
+
+  screenIfaceResult = screen_create_window_buffers((screen_window_t)win, count);
+  if (screenIfaceResult == EOK) {
+    screenIfaceResult = screen_get_window_property_pv((screen_window_t)win, SCREEN_PROPERTY_RENDER_BUFFERS, (void **)pBuffers);
+    if (screenIfaceResult == EOK) {
+      createWindowBuffersResult = 0; //EOK
+    } else {
+      log_message(LOG_ERROR, "scrCreateWindowBuffers::screen_get_window_property_pv(SCREEN_PROPERTY_RENDER_BUFFERS) returned non-zero: %d ", screenIfaceResult);
+      createWindowBuffersResult = -2;
+    }
+  } else {
+    log_message(LOG_ERROR, "scrCreateWindowBuffers::screen_create_window_buffers(%d) returned non-zero: %d ", count, screenIfaceResult);
+    createWindowBuffersResult = -1;
+  }
+
+  return createWindowBuffersResult;
+}
+
+static int scrPostWindow(gfxWindow win, gfxBuffer buf, const int *dirtyRect) {
+  int postResult = -1;
+  int screenIfaceResult;
+
+  screenIfaceResult = screen_set_window_property_iv((screen_window_t)win, SCREEN_PROPERTY_VISIBLE, (int[]){1});
+  if (screenIfaceResult == EOK) {
+    screenIfaceResult = screen_post_window((screen_window_t)win, (screen_buffer_t)buf, 1, dirtyRect, 0);
+    if (screenIfaceResult == EOK) {
+      postResult = 0;
+    } else {
+      log_message(LOG_ERROR, "scrPostWindow::screen_post_window() returned non-zero: %d", screenIfaceResult);
+    }
+  } else {
+    log_message(LOG_ERROR, "scrPostWindow::screen_set_window_property_iv(SCREEN_PROPERTY_VISIBLE) returned non-zero: %d", screenIfaceResult);
+  }
+
+  return postResult;
+}
+
+static int scrGetRenderBuffer(gfxWindow win, gfxBuffer *pBuf) {
+  screen_buffer_t renderBuffers[GFX_MAX_WIN_BUFFERS];
+  int screenIfaceResult;
+
+  screenIfaceResult = screen_get_window_property_pv((screen_window_t)win, SCREEN_PROPERTY_RENDER_BUFFERS, (void **)renderBuffers);
+  if (screenIfaceResult == EOK) {
+    *pBuf = (gfxBuffer)renderBuffers[0];
+  } else {
+    log_message(LOG_ERROR, "scrGetRenderBuffer::screen_get_window_property_pv(SCREEN_PROPERTY_RENDER_BUFFERS) returned non-zero: %d ", screenIfaceResult);
+  }
+  return screenIfaceResult;
+}
+
+static int scrGetDisplayDpi(gfxWindow win, int *pDpi) {
+  screen_display_t scrDisp;
+  int screenIfaceResult;
+  int getDpiResult = -1;
+  int screenSize_mm[2];
+  int screenDiag_mm;
+  int screenDiag_in;
+  int screenRes[2];
+  int screenDiag_pix;
+
+  *pDpi = 0;
+  screenIfaceResult = screen_get_window_property_pv((screen_window_t)win, SCREEN_PROPERTY_DISPLAY, (void **)&scrDisp);
+  if (screenIfaceResult == EOK) {
+    screenIfaceResult = screen_get_display_property_iv(scrDisp, SCREEN_PROPERTY_PHYSICAL_SIZE, screenSize_mm);
+    if (screenIfaceResult == EOK) {
+      screenDiag_mm = (int)round(sqrt(screenSize_mm[0] * screenSize_mm[0] + screenSize_mm[1] * screenSize_mm[1]));
+      screenDiag_in = (screenDiag_mm * 10) / 254;
+      if (screenDiag_in == 0) {
+        getDpiResult = 0;
+      } else {
+        screenIfaceResult = screen_get_display_property_iv(scrDisp, SCREEN_PROPERTY_SIZE, screenRes);
+        if (screenIfaceResult == EOK) {
+          screenDiag_pix = (int)round(sqrt(screenRes[0] * screenRes[0] + screenRes[1] * screenRes[1]));
+          *pDpi = screenDiag_pix/screenDiag_in;
+          getDpiResult = 0;
+        } else {
+          log_message(LOG_WARNING, "scrGetDisplayDpi::screen_get_display_property_iv(SCREEN_PROPERTY_SIZE) returned non-zero: %d", screenIfaceResult);
+          getDpiResult = -3;
+        }
+      }
+    } else {
+      log_message(LOG_WARNING, "scrGetDisplayDpi::screen_get_display_property_iv(SCREEN_PROPERTY_PHYSICAL_SIZE) returned non-zero: %d", screenIfaceResult);
+      getDpiResult = -2;
+    }
+  } else {
+    log_message(LOG_WARNING, "scrGetDisplayDpi::screen_get_window_property_pv(SCREEN_PROPERTY_DISPLAY) returned non-zero: %d", screenIfaceResult);
+    getDpiResult = -1;
+  }
+  return getDpiResult;
+}
+
+static int scrCreatePixmap(gfxContext ctx, gfxPixmap *pPix) {
+  const int pixmapUsage = SCREEN_USAGE_WRITE | SCREEN_USAGE_READ | SCREEN_USAGE_NATIVE ;
+  const int pixmapFormat = SCREEN_FORMAT_RGBX8888;
+  screen_pixmap_t scrPix;
+  int createPixmapResult = -1;
+  int screenIfaceResult;
+
+    screenIfaceResult = screen_create_pixmap(&scrPix, (screen_context_t)ctx);
+    if (screenIfaceResult == EOK) {
+        screenIfaceResult = screen_set_pixmap_property_iv(scrPix, SCREEN_PROPERTY_USAGE, &pixmapUsage);
+        if (screenIfaceResult == EOK) {
+           screenIfaceResult = screen_set_pixmap_property_iv(scrPix, SCREEN_PROPERTY_FORMAT, &pixmapFormat);
+           if (screenIfaceResult == EOK) {
+               createPixmapResult = 0; //EOK
+           } else {
+               log_message(LOG_ERROR, "scrCreatePixmap::screen_set_pixmap_property_iv(SCREEN_PROPERTY_FORMAT) returned non-zero: %d ", screenIfaceResult);
+               createPixmapResult = -3;
+           }
+        } else {
+            log_message(LOG_ERROR, "scrCreatePixmap::screen_set_pixmap_property_iv(SCREEN_PROPERTY_USAGE) returned non-zero: %d ", screenIfaceResult);
+            createPixmapResult = -2;
+        }
+        if (createPixmapResult != 0) {
+            screen_destroy_pixmap(scrPix);
+        }
+    } else {
+        log_message(LOG_ERROR, "scrCreatePixmap::screen_create_pixmap() returned non-zero: %d ", screenIfaceResult);
+        createPixmapResult = -1;
+    }
+
+  *pPix = (createPixmapResult == 0) ? (gfxPixmap)scrPix : NULL;
+  return createPixmapResult;
+}
+
+static void scrDestroyPixmap(gfxPixmap pix) {
+  screen_destroy_pixmap((screen_pixmap_t)pix);
+}
+
+// The pixmap format set at creation is replaced by format: one pixmap can get buffers of different formats.
+static int scrCreatePixmapBuffer(gfxPixmap pix, int width, int height, ePixFormats format, gfxBuffer *pBuf) {
+  const int pixmapFormat = scrFormat(format);
+  int size[2];
+  int createResult = -1;
+  int screenIfaceResult;
+
+  size[0] = width;
+  size[1] = height;
+  screenIfaceResult = screen_set_pixmap_property_iv((screen_pixmap_t)pix, SCREEN_PROPERTY_FORMAT, &pixmapFormat);
+  if (screenIfaceResult != EOK) {
+    log_message(LOG_ERROR, "scrCreatePixmapBuffer::screen_set_pixmap_property_iv(SCREEN_PROPERTY_FORMAT) returned non-zero: %d ", screenIfaceResult);
+    return -4;
+  }
+  screenIfaceResult = screen_set_pixmap_property_iv((screen_pixmap_t)pix, SCREEN_PROPERTY_BUFFER_SIZE, size);
+  if (screenIfaceResult == EOK) {
+    screenIfaceResult = screen_create_pixmap_buffer((screen_pixmap_t)pix);
+    if (screenIfaceResult == EOK) {
+      screenIfaceResult = screen_get_pixmap_property_pv((screen_pixmap_t)pix, SCREEN_PROPERTY_RENDER_BUFFERS, (void **)pBuf);
+      if (screenIfaceResult == EOK) {
+        createResult = 0; //EOK
+      } else {
+        log_message(LOG_ERROR, "scrCreatePixmapBuffer::screen_get_pixmap_property_pv(SCREEN_PROPERTY_RENDER_BUFFERS) returned non-zero: %d ", screenIfaceResult);
+        screen_destroy_pixmap_buffer((screen_pixmap_t)pix);
+        createResult = -3;
+      }
+    } else {
+      log_message(LOG_ERROR, "scrCreatePixmapBuffer::screen_create_pixmap_buffer() returned non-zero: %d ", screenIfaceResult);
+      createResult = -2;
+    }
+  } else {
+    log_message(LOG_ERROR, "scrCreatePixmapBuffer::screen_set_pixmap_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) with %dx%d returned non-zero: %d ", width, height, screenIfaceResult);
+    createResult = -1;
+  }
+
+  return createResult;
+}
+
+static void scrDestroyPixmapBuffer(gfxPixmap pix) {
+  screen_destroy_pixmap_buffer((screen_pixmap_t)pix);
+}
+
+static int scrGetBufferInfo(gfxBuffer buf, gfxBufferInfo *pInfo) {
+  int size[2];
+  int format = SCREEN_FORMAT_RGBX8888;
+  int getInfoResult = -1;
+  int screenIfaceResult;
+
+  screenIfaceResult = screen_get_buffer_property_pv((screen_buffer_t)buf, SCREEN_PROPERTY_POINTER, &(pInfo->pData));
+  if (screenIfaceResult == EOK) {
+    screenIfaceResult = screen_get_buffer_property_iv((screen_buffer_t)buf, SCREEN_PROPERTY_STRIDE, &(pInfo->stride));
+    if (screenIfaceResult == EOK) {
+      screenIfaceResult = screen_get_buffer_property_iv((screen_buffer_t)buf, SCREEN_PROPERTY_BUFFER_SIZE, size);
+      if (screenIfaceResult == EOK) {
+        pInfo->width = size[0];
+        pInfo->height = size[1];
+        //Buffers are only ever created in the two display formats
+        if (screen_get_buffer_property_iv((screen_buffer_t)buf, SCREEN_PROPERTY_FORMAT, &format) != EOK) {
+          log_message(LOG_WARNING, "scrGetBufferInfo::screen_get_buffer_property_iv(SCREEN_PROPERTY_FORMAT) failed, RGBX8888 assumed");
+        }
+        pInfo->format = (format == SCREEN_FORMAT_RGB565) ? ePixFmt_RGB565 : ePixFmt_XRGB8888;
+        getInfoResult = 0; //EOK
+      } else {
+        log_message(LOG_ERROR, "scrGetBufferInfo::screen_get_buffer_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) returned non-zero: %d ", screenIfaceResult);
+        getInfoResult = -3;
+      }
+    } else {
+      log_message(LOG_ERROR, "scrGetBufferInfo::screen_get_buffer_property_iv(SCREEN_PROPERTY_STRIDE) returned non-zero: %d ", screenIfaceResult);
+      getInfoResult = -2;
+    }
+  } else {
+    log_message(LOG_ERROR, "scrGetBufferInfo::screen_get_buffer_property_pv(SCREEN_PROPERTY_POINTER) returned non-zero: %d ", screenIfaceResult);
+    getInfoResult = -1;
+  }
+
+  return getInfoResult;
+}
+
+static int scrBlit(gfxContext ctx, gfxBuffer dst, gfxBuffer src, const gfxBlitParams *pParams) {
+  int attribs[32];
+  int screenIfaceResult;
+
+  setup_blit_attributes(pParams, attribs);
+  screenIfaceResult = screen_blit((screen_context_t)ctx, (screen_buffer_t)dst, (screen_buffer_t)src, attribs);
+  if (screenIfaceResult != EOK) {
+    log_message(LOG_ERROR, "scrBlit::screen_blit() returned non-zero: %d", screenIfaceResult);
+  }
+  return screenIfaceResult;
+}
+
+static int scrFill(gfxContext ctx, gfxBuffer dst, const int *rect, uint32_t color) {
+  int attribs[] = { SCREEN_BLIT_DESTINATION_X, rect[0], SCREEN_BLIT_DESTINATION_Y, rect[1],
+                    SCREEN_BLIT_DESTINATION_WIDTH, rect[2], SCREEN_BLIT_DESTINATION_HEIGHT, rect[3],
+                    SCREEN_BLIT_COLOR, (int)color, SCREEN_BLIT_END };
+  int screenIfaceResult;
+
+  screenIfaceResult = screen_fill((screen_context_t)ctx, (screen_buffer_t)dst, attribs);
+  if (screenIfaceResult != EOK) {
+    log_message(LOG_ERROR, "scrFill::screen_fill() returned non-zero: %d", screenIfaceResult);
+  }
+  return screenIfaceResult;
+}
+
+static int scrFinish(gfxContext ctx) {
+  int screenIfaceResult;
+
+  screenIfaceResult = screen_flush_blits((screen_context_t)ctx, SCREEN_WAIT_IDLE);
+  if (screenIfaceResult != EOK) {
+    log_message(LOG_ERROR, "scrFinish::screen_flush_blits() returned non-zero: %d", screenIfaceResult);
+  }
+  return screenIfaceResult;
+}
+
+
+/******************************************************************************
+  Global Variables
+ ******************************************************************************/
+
+const gfxBackendOps gfxScreenBackend = {
+  .name                = "screen",
+  .createContext       = scrCreateContext,
+  .destroyContext      = scrDestroyContext,
+  .createWindow        = scrCreateWindow,
+  .destroyWindow       = scrDestroyWindow,
+  .createWindowBuffers = scrCreateWindowBuffers,
+  .postWindow          = scrPostWindow,
+  .getRenderBuffer     = scrGetRenderBuffer,
+  .getDisplayDpi       = scrGetDisplayDpi,
+  .createPixmap        = scrCreatePixmap,
+  .destroyPixmap       = scrDestroyPixmap,
+  .createPixmapBuffer  = scrCreatePixmapBuffer,
+  .destroyPixmapBuffer = scrDestroyPixmapBuffer,
+  .getBufferInfo       = scrGetBufferInfo,
+  .blit                = scrBlit,
+  .fill                = scrFill,
+  .finish              = scrFinish
+};
+
+#endif /* __QNX__ */
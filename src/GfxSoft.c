@@ -0,0 +1,538 @@
+/*
+ * GfxSoft.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file GfxSoft.c
+ *
+ *  @brief Software graphics backend: window and pixmap buffers in process memory,
+ *         blits and fills done on the CPU, synchronously.
+ *
+ *  Posting a frame only rotates the window buffers, and optionally writes the
+ *  posted frame to a PPM file, so renders can be inspected and diffed.
+ *  Buffers are XRGB8888 or RGB565. Scaling and blending work on XRGB8888 rows;
+ *  RGB565 rows are converted on the way in and out, one row at a time.
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+#include "PixKernels.h"
+#include "PixFormat.h"
+#include "GfxBackend.h"
+
+
+/******************************************************************************
+  Type Definitions
+ ******************************************************************************/
+typedef struct {
+  uint8_t *pData;
+  int width;
+  int height;
+  int stride;
+  ePixFormats format;
+  int bpp;                     /* Bytes per pixel */
+} swBuffer;
+
+typedef struct {
+  int unused;
+} swContext;
+
+typedef struct {
+  swBuffer buffers[GFX_MAX_WIN_BUFFERS];
+  ePixFormats format;
+  int bufferCount;
+  int renderIdx;
+  int visible;
+  unsigned long postCount;
+} swWindow;
+
+typedef struct {
+  swBuffer buffer;
+  int hasBuffer;
+} swPixmap;
+
+
+/******************************************************************************
+  File Scope Variables
+ ******************************************************************************/
+static struct {
+  int width;
+  int height;
+  int dpi;
+  char outFile[256];
+} swConfig = { 1280, 768, 0, "" };
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+static int swAllocBuffer(swBuffer *pBuf, int width, int height, ePixFormats format) {
+  if ((width <= 0) || (height <= 0) || !pfIsDisplayFormat(format)) {
+    log_message(LOG_ERROR, "swAllocBuffer: invalid %s buffer %dx%d", pfFormatName(format), width, height);
+    return -1;
+  }
+  pBuf->format = format;
+  pBuf->bpp = pfBitsPerPixel(format) / 8;
+  // Rows aligned to 64 bytes, as hardware buffers usually are
+  pBuf->stride = (width * pBuf->bpp + 63) & ~63;
+  pBuf->pData = calloc((size_t)pBuf->stride * height, 1);
+  if (pBuf->pData == NULL) {
+    log_message(LOG_ERROR, "swAllocBuffer: out of memory for %dx%d", width, height);
+    return -2;
+  }
+  pBuf->width = width;
+  pBuf->height = height;
+  return 0;
+}
+
+static void swFreeBuffer(swBuffer *pBuf) {
+  free(pBuf->pData);
+  memset(pBuf, 0, sizeof(swBuffer));
+}
+
+// Exact, rounded (s * a + d * (255 - a)) / 255
+static inline uint32_t swBlendChannel(uint32_t s, uint32_t d, uint32_t a) {
+  uint32_t t = s * a + d * (255 - a);
+  return (t + ((t + 128) >> 8) + 128) >> 8;
+}
+
+static inline uint32_t swBlendPixel(uint32_t s, uint32_t d, uint32_t a) {
+  return (swBlendChannel(0xff, d >> 24, a) << 24)
+       | (swBlendChannel((s >> 16) & 0xff, (d >> 16) & 0xff, a) << 16)
+       | (swBlendChannel((s >> 8) & 0xff, (d >> 8) & 0xff, a) << 8)
+       | swBlendChannel(s & 0xff, d & 0xff, a);
+}
+
+// Weights are 0..256
+static inline uint32_t swLerpPixel(uint32_t p0, uint32_t p1, uint32_t w1) {
+  uint32_t w0 = 256 - w1;
+  uint32_t rb = ((p0 & 0x00ff00ffu) * w0 + (p1 & 0x00ff00ffu) * w1 + 0x00800080u) >> 8;
+  uint32_t ag = (((p0 >> 8) & 0x00ff00ffu) * w0 + ((p1 >> 8) & 0x00ff00ffu) * w1 + 0x00800080u) >> 8;
+  return (rb & 0x00ff00ffu) | ((ag & 0x00ff00ffu) << 8);
+}
+
+static int swWritePpm(const char *fileName, const swBuffer *pBuf) {
+  FILE *out;
+  uint8_t *rgbRow;
+  uint32_t *xrgbRow;
+  const uint32_t *pRow;
+  int x, y;
+  int result = 0;
+
+  out = fopen(fileName, "wb");
+  if (out == NULL) {
+    log_message(LOG_ERROR, "swWritePpm: cannot create %s", fileName);
+    return -1;
+  }
+  rgbRow = malloc((size_t)pBuf->width * 3);
+  xrgbRow = malloc((size_t)pBuf->width * 4);
+  if ((rgbRow == NULL) || (xrgbRow == NULL)) {
+    free(rgbRow);
+    free(xrgbRow);
+    fclose(out);
+    return -2;
+  }
+  fprintf(out, "P6\n%d %d\n255\n", pBuf->width, pBuf->height);
+  for (y = 0; (y < pBuf->height) && (result == 0); y++) {
+    pRow = (const uint32_t *)(pBuf->pData + (size_t)y * pBuf->stride);
+    if (pBuf->format != ePixFmt_XRGB8888) {
+      pfConvertRow(xrgbRow, ePixFmt_XRGB8888, pRow, pBuf->format, pBuf->width, NULL);
+      pRow = xrgbRow;
+    }
+    for (x = 0; x < pBuf->width; x++) {
+      rgbRow[x * 3 + 0] = (pRow[x] >> 16) & 0xff;
+      rgbRow[x * 3 + 1] = (pRow[x] >> 8) & 0xff;
+      rgbRow[x * 3 + 2] = pRow[x] & 0xff;
+    }
+    if (fwrite(rgbRow, 3, pBuf->width, out) != (size_t)pBuf->width) {
+      log_message(LOG_ERROR, "swWritePpm: writing %s failed", fileName);
+      result = -3;
+    }
+  }
+  free(rgbRow);
+  free(xrgbRow);
+  fclose(out);
+  return result;
+}
+
+
+static int swCreateContext(gfxContext *pCtx) {
+  *pCtx = (gfxContext)calloc(1, sizeof(swContext));
+  return (*pCtx != NULL) ? 0 : -1;
+}
+
+static void swDestroyContext(gfxContext ctx) {
+  free(ctx);
+}
+
+// No display to rotate: *pRotation is returned as is, the caller rotates in software.
+static int swCreateWindow(gfxContext ctx, ePixFormats format, int *pRotation, gfxWindow *pWin, int *winSize, int *bufferSize) {
+  swWindow *pSwWin;
+
+  if (!pfIsDisplayFormat(format)) {
+    log_message(LOG_ERROR, "swCreateWindow: %s is not a window format", pfFormatName(format));
+    return -2;
+  }
+  pSwWin = calloc(1, sizeof(swWindow));
+  if (pSwWin == NULL) {
+    return -1;
+  }
+  pSwWin->format = format;
+  winSize[0] = swConfig.width;
+  winSize[1] = swConfig.height;
+  bufferSize[0] = swConfig.width;
+  bufferSize[1] = swConfig.height;
+  *pWin = (gfxWindow)pSwWin;
+  return 0;
+}
+
+static void swDestroyWindow(gfxWindow win) {
+  swWindow *pSwWin = (swWindow *)win;
+  int i;
+
+  for (i = 0; i < pSwWin->bufferCount; i++) {
+    swFreeBuffer(&(pSwWin->buffers[i]));
+  }
+  free(pSwWin);
+}
+
+static int swCreateWindowBuffers(gfxWindow win, int count, gfxBuffer *pBuffers) {
+  swWindow *pSwWin = (swWindow *)win;
+  int i;
+
+  if ((count < 1) || (count > GFX_MAX_WIN_BUFFERS)) {
+    log_message(LOG_ERROR, "swCreateWindowBuffers: %d buffers not supported", count);
+    return -1;
+  }
+  for (i = 0; i < count; i++) {
+    if (swAllocBuffer(&(pSwWin->buffers[i]), swConfig.width, swConfig.height, pSwWin->format) != 0) {
+      while (--i >= 0) {
+        swFreeBuffer(&(pSwWin->buffers[i]));
+      }
+      return -2;
+    }
+    pBuffers[i] = (gfxBuffer)&(pSwWin->buffers[i]);
+  }
+  pSwWin->bufferCount = count;
+  pSwWin->renderIdx = 0;
+  return 0;
+}
+
+static int swPostWindow(gfxWindow win, gfxBuffer buf, const int *dirtyRect) {
+  swWindow *pSwWin = (swWindow *)win;
+
+  pSwWin->visible = 1;
+  pSwWin->postCount++;
+  log_message(LOG_DEBUG, "swPostWindow: post %lu, dirty x:%d, y:%d, w:%d, h:%d", pSwWin->postCount, dirtyRect[0], dirtyRect[1], dirtyRect[2], dirtyRect[3]);
+  if (swConfig.outFile[0] != 0) {
+    swWritePpm(swConfig.outFile, (const swBuffer *)buf);
+  }
+  pSwWin->renderIdx = (pSwWin->renderIdx + 1) % pSwWin->bufferCount;
+  return 0;
+}
+
+static int swGetRenderBuffer(gfxWindow win, gfxBuffer *pBuf) {
+  swWindow *pSwWin = (swWindow *)win;
+
+  *pBuf = (gfxBuffer)&(pSwWin->buffers[pSwWin->renderIdx]);
+  return 0;
+}
+
+static int swGetDisplayDpi(gfxWindow win, int *pDpi) {
+  *pDpi = swConfig.dpi;
+  return 0;
+}
+
+static int swCreatePixmap(gfxContext ctx, gfxPixmap *pPix) {
+  *pPix = (gfxPixmap)calloc(1, sizeof(swPixmap));
+  return (*pPix != NULL) ? 0 : -1;
+}
+
+static void swDestroyPixmapBuffer(gfxPixmap pix) {
+  swPixmap *pSwPix = (swPixmap *)pix;
+
+  if (pSwPix->hasBuffer) {
+    swFreeBuffer(&(pSwPix->buffer));
+    pSwPix->hasBuffer = 0;
+  }
+}
+
+static void swDestroyPixmap(gfxPixmap pix) {
+  swDestroyPixmapBuffer(pix);
+  free(pix);
+}
+
+static int swCreatePixmapBuffer(gfxPixmap pix, int width, int height, ePixFormats format, gfxBuffer *pBuf) {
+  swPixmap *pSwPix = (swPixmap *)pix;
+
+  swDestroyPixmapBuffer(pix);
+  if (swAllocBuffer(&(pSwPix->buffer), width, height, format) != 0) {
+    return -1;
+  }
+  pSwPix->hasBuffer = 1;
+  *pBuf = (gfxBuffer)&(pSwPix->buffer);
+  return 0;
+}
+
+static int swGetBufferInfo(gfxBuffer buf, gfxBufferInfo *pInfo) {
+  const swBuffer *pSwBuf = (const swBuffer *)buf;
+
+  pInfo->pData = pSwBuf->pData;
+  pInfo->width = pSwBuf->width;
+  pInfo->height = pSwBuf->height;
+  pInfo->stride = pSwBuf->stride;
+  pInfo->format = pSwBuf->format;
+  return 0;
+}
+
+// Source row y, counted from srcY, as XRGB8888 pixels from srcX on. RGB565 rows are converted into one of
+// two slots of srcWidth pixels each; rows are asked for top down, so the slot with the lower row is reused.
+static const uint32_t *swSourceRow(const swBuffer *pSrc, const gfxBlitParams *p, int y, uint32_t *pSlots, int *slotY) {
+  const uint8_t *pRow = pSrc->pData + (size_t)(p->srcY + y) * pSrc->stride + (size_t)p->srcX * pSrc->bpp;
+  int slot;
+
+  if (pSrc->format == ePixFmt_XRGB8888) {
+    return (const uint32_t *)pRow;
+  }
+  for (slot = 0; slot < 2; slot++) {
+    if (slotY[slot] == y) {
+      return pSlots + (size_t)slot * p->srcWidth;
+    }
+  }
+  slot = (slotY[0] < slotY[1]) ? 0 : 1;
+  pfConvertRow(pSlots + (size_t)slot * p->srcWidth, ePixFmt_XRGB8888, pRow, pSrc->format, p->srcWidth, NULL);
+  slotY[slot] = y;
+  return pSlots + (size_t)slot * p->srcWidth;
+}
+
+// Scaled blit: source coordinates are sampled at destination pixel centers, in 16.16 fixed point.
+// FASTEST picks the nearest source pixel, NICEST interpolates bilinearly. The source rectangle
+// must lie inside the source buffer; the destination is clipped to the destination buffer.
+static int swBlit(gfxContext ctx, gfxBuffer dst, gfxBuffer src, const gfxBlitParams *p) {
+  const swBuffer *pSrc = (const swBuffer *)src;
+  const swBuffer *pDst = (const swBuffer *)dst;
+  const int bilinear = (p->quality == gfx_Quality_Nicest);
+  const int srcOver = (p->transparency == gfx_Transparency_SourceOver);
+  const int ga = (p->globalAlpha < 0) ? 0 : ((p->globalAlpha > 255) ? 255 : p->globalAlpha);
+  int x0, x1, y0, y1;
+  int32_t stepX, stepY;
+  int32_t *xPos = NULL;
+  uint32_t *rowBuf = NULL;
+  uint32_t *srcSlots = NULL;
+  uint32_t *dstSpan = NULL;
+  int slotY[2] = { -1, -1 };
+  uint8_t *pDstRow8;
+  int x, y, width;
+
+  if ((p->srcWidth <= 0) || (p->srcHeight <= 0) || (p->dstWidth <= 0) || (p->dstHeight <= 0)) {
+    return 0;
+  }
+  if ((p->srcX < 0) || (p->srcY < 0) || (p->srcX + p->srcWidth > pSrc->width) || (p->srcY + p->srcHeight > pSrc->height)) {
+    log_message(LOG_ERROR, "swBlit: source rect %d,%d %dx%d outside of %dx%d buffer", p->srcX, p->srcY, p->srcWidth, p->srcHeight, pSrc->width, pSrc->height);
+    return -1;
+  }
+
+  // Destination span inside the destination buffer, relative to dstX/dstY
+  x0 = (p->dstX < 0) ? -p->dstX : 0;
+  y0 = (p->dstY < 0) ? -p->dstY : 0;
+  x1 = (p->dstX + p->dstWidth > pDst->width) ? pDst->width - p->dstX : p->dstWidth;
+  y1 = (p->dstY + p->dstHeight > pDst->height) ? pDst->height - p->dstY : p->dstHeight;
+  if ((x0 >= x1) || (y0 >= y1) || (ga == 0)) {
+    return 0;
+  }
+  width = x1 - x0;
+
+  // 1:1 opaque copy, the common case for text and unscaled images; converted if the formats differ
+  if ((p->srcWidth == p->dstWidth) && (p->srcHeight == p->dstHeight) && !srcOver && (ga == 255)) {
+    for (y = y0; y < y1; y++) {
+      pDstRow8 = pDst->pData + (size_t)(p->dstY + y) * pDst->stride + (size_t)(p->dstX + x0) * pDst->bpp;
+      if (pSrc->format == pDst->format) {
+        memcpy(pDstRow8, pSrc->pData + (size_t)(p->srcY + y) * pSrc->stride + (size_t)(p->srcX + x0) * pSrc->bpp, (size_t)width * pDst->bpp);
+      } else {
+        pfConvertRow(pDstRow8, pDst->format, pSrc->pData + (size_t)(p->srcY + y) * pSrc->stride + (size_t)(p->srcX + x0) * pSrc->bpp,
+                     pSrc->format, width, NULL);
+      }
+    }
+    return 0;
+  }
+
+  xPos = malloc(sizeof(int32_t) * width);
+  rowBuf = malloc(sizeof(uint32_t) * width);
+  if (pSrc->format != ePixFmt_XRGB8888) {
+    srcSlots = malloc(sizeof(uint32_t) * 2 * p->srcWidth);
+  }
+  if (pDst->format != ePixFmt_XRGB8888) {
+    dstSpan = malloc(sizeof(uint32_t) * width);
+  }
+  if ((xPos == NULL) || (rowBuf == NULL) || ((pSrc->format != ePixFmt_XRGB8888) && (srcSlots == NULL)) ||
+      ((pDst->format != ePixFmt_XRGB8888) && (dstSpan == NULL))) {
+    free(xPos);
+    free(rowBuf);
+    free(srcSlots);
+    free(dstSpan);
+    log_message(LOG_ERROR, "swBlit: out of memory");
+    return -2;
+  }
+
+  stepX = (int32_t)(((int64_t)p->srcWidth << 16) / p->dstWidth);
+  stepY = (int32_t)(((int64_t)p->srcHeight << 16) / p->dstHeight);
+  for (x = 0; x < width; x++) {
+    // Center of destination pixel, in source pixels from srcX; bilinear samples between centers
+    int32_t pos = (int32_t)((x0 + x) * (int64_t)stepX + stepX / 2);
+    xPos[x] = bilinear ? pos - 0x8000 : pos;
+  }
+
+  for (y = y0; y < y1; y++) {
+    int32_t posY = (int32_t)(y * (int64_t)stepY + stepY / 2);
+    uint32_t *pDstRow;
+
+    pDstRow8 = pDst->pData + (size_t)(p->dstY + y) * pDst->stride + (size_t)(p->dstX + x0) * pDst->bpp;
+    pDstRow = (dstSpan != NULL) ? dstSpan : (uint32_t *)pDstRow8;
+    if (bilinear) {
+      int sy, sy1;
+      uint32_t fy;
+      const uint32_t *pRow0, *pRow1;
+
+      posY -= 0x8000;
+      if (posY < 0) posY = 0;
+      sy = posY >> 16;
+      fy = (posY & 0xffff) >> 8;
+      if (sy >= p->srcHeight - 1) {
+        sy = p->srcHeight - 1;
+        fy = 0;
+      }
+      sy1 = (sy + 1 < p->srcHeight) ? sy + 1 : sy;
+      pRow0 = swSourceRow(pSrc, p, sy, srcSlots, slotY);
+      pRow1 = swSourceRow(pSrc, p, sy1, srcSlots, slotY);
+      for (x = 0; x < width; x++) {
+        int32_t posX = (xPos[x] < 0) ? 0 : xPos[x];
+        int sx = posX >> 16;
+        uint32_t fx = (posX & 0xffff) >> 8;
+        int sx1;
+
+        if (sx >= p->srcWidth - 1) {
+          sx = p->srcWidth - 1;
+          fx = 0;
+        }
+        sx1 = (sx + 1 < p->srcWidth) ? sx + 1 : sx;
+        rowBuf[x] = swLerpPixel(swLerpPixel(pRow0[sx], pRow0[sx1], fx), swLerpPixel(pRow1[sx], pRow1[sx1], fx), fy);
+      }
+    } else {
+      int sy = posY >> 16;
+      const uint32_t *pRow;
+
+      if (sy > p->srcHeight - 1) sy = p->srcHeight - 1;
+      pRow = swSourceRow(pSrc, p, sy, srcSlots, slotY);
+      for (x = 0; x < width; x++) {
+        int sx = xPos[x] >> 16;
+        rowBuf[x] = pRow[(sx < p->srcWidth) ? sx : p->srcWidth - 1];
+      }
+    }
+
+    if (!srcOver && (ga == 255)) {
+      pfConvertRow(pDstRow8, pDst->format, rowBuf, ePixFmt_XRGB8888, width, NULL);
+    } else {
+      // Blending reads the destination: RGB565 spans are widened first and packed again after
+      if (dstSpan != NULL) {
+        pfConvertRow(dstSpan, ePixFmt_XRGB8888, pDstRow8, pDst->format, width, NULL);
+      }
+      for (x = 0; x < width; x++) {
+        uint32_t a = srcOver ? (((rowBuf[x] >> 24) * ga + 127) / 255) : (uint32_t)ga;
+        if (a == 255) {
+          pDstRow[x] = rowBuf[x] | 0xff000000u;
+        } else if (a != 0) {
+          pDstRow[x] = swBlendPixel(rowBuf[x], pDstRow[x], a);
+        }
+      }
+      if (dstSpan != NULL) {
+        pfConvertRow(pDstRow8, pDst->format, dstSpan, ePixFmt_XRGB8888, width, NULL);
+      }
+    }
+  }
+
+  free(xPos);
+  free(rowBuf);
+  free(srcSlots);
+  free(dstSpan);
+  return 0;
+}
+
+static int swFill(gfxContext ctx, gfxBuffer dst, const int *rect, uint32_t color) {
+  const swBuffer *pDst = (const swBuffer *)dst;
+  const uint16_t color565 = pfPackRgb565(color);
+  uint16_t *pRow16;
+  int x0, y0, x1, y1;
+  int x, y;
+
+  x0 = (rect[0] < 0) ? 0 : rect[0];
+  y0 = (rect[1] < 0) ? 0 : rect[1];
+  x1 = (rect[0] + rect[2] > pDst->width) ? pDst->width : rect[0] + rect[2];
+  y1 = (rect[1] + rect[3] > pDst->height) ? pDst->height : rect[1] + rect[3];
+  for (y = y0; (y < y1) && (x1 > x0); y++) {
+    if (pDst->format == ePixFmt_RGB565) {
+      pRow16 = (uint16_t *)(pDst->pData + (size_t)y * pDst->stride);
+      for (x = x0; x < x1; x++) {
+        pRow16[x] = color565;
+      }
+    } else {
+      pkFillRgbx((uint32_t *)(pDst->pData + (size_t)y * pDst->stride) + x0, x1 - x0, color);
+    }
+  }
+  return 0;
+}
+
+static int swFinish(gfxContext ctx) {
+  // Everything is done synchronously
+  return 0;
+}
+
+
+/******************************************************************************
+  Global Variables
+ ******************************************************************************/
+
+const gfxBackendOps gfxSoftBackend = {
+  .name                = "soft",
+  .createContext       = swCreateContext,
+  .destroyContext      = swDestroyContext,
+  .createWindow        = swCreateWindow,
+  .destroyWindow       = swDestroyWindow,
+  .createWindowBuffers = swCreateWindowBuffers,
+  .postWindow          = swPostWindow,
+  .getRenderBuffer     = swGetRenderBuffer,
+  .getDisplayDpi       = swGetDisplayDpi,
+  .createPixmap        = swCreatePixmap,
+  .destroyPixmap       = swDestroyPixmap,
+  .createPixmapBuffer  = swCreatePixmapBuffer,
+  .destroyPixmapBuffer = swDestroyPixmapBuffer,
+  .getBufferInfo       = swGetBufferInfo,
+  .blit                = swBlit,
+  .fill                = swFill,
+  .finish              = swFinish
+};
+
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+void gfxSoftConfigure(int width, int height, int dpi, const char *outFile) {
+  swConfig.width = width;
+  swConfig.height = height;
+  swConfig.dpi = dpi;
+  if (outFile != NULL) {
+    strncpy(swConfig.outFile, outFile, sizeof(swConfig.outFile) - 1);
+  } else {
+    swConfig.outFile[0] = 0;
+  }
+}
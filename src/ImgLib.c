@@ -20,20 +20,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+
+#include <time.h>
 
 #ifdef __QNX__
- #include <time.h>
- #include <screen/screen.h>
  #include <sys/netmgr.h>
  #include <sys/neutrino.h>
  #include <dirent.h>
  #include <img/img.h>
- #include "errno.h"
 #endif
 
 #include "logger.h"
 #include "argParse.h"
 #include "FtRenderer.h"
+#include "PixKernels.h"
+#include "PixScale.h"
+#include "PixFormat.h"
+#include "Trace.h"
+#include "FrameStats.h"
+#include "TxtChannel.h"
+#include "InitSched.h"
+#include "FrameCache.h"
+#include "BgrImage.h"
 #include "ImgLib.h"
 
 
@@ -44,18 +58,45 @@
 #define TFT_HEIGHT_MM 104
 #define TFT_HORIZONTAL_RESOLUTION 1280
 #define TFT_VERTICAL_RESOLUTION 768
+#define TXT_POINT_SIZE 16
 
 /******************************************************************************
   Type Definitions
  ******************************************************************************/
+typedef struct {
+  bgrScrWinContexts *pWinCtxt;
+  bgrImgPixmapData *pImgData;
+  bgrTxtPixmapData *pTxtData;
+  int txtLineHeight;             /* Set by the text task */
+  const char *frameCacheFile;    /* NULL: no frame cache */
+  uint64_t frameCacheKey;        /* Inputs key, completed with the window size by the frame cache task */
+  int frameCacheHit;             /* Window render buffer already holds the composed frame */
+} bgrInitTaskData;
 
 /******************************************************************************
   File Scope Variables
  ******************************************************************************/
 int viewport_size[2] = { 0, 0 };
-int scale_mode = SCREEN_SCALE_NONE;
-int mirror_mode = SCREEN_MIRROR_DISABLED;
+int scale_mode = eScale_ZOOM;
+int mirror_mode = eMirror_DISABLED;
+int scaler_mode = eScaler_AUTO;
 eTextSources txtSrc = eTxtSrc_PARAM;
+frComposeMode txtComposeMode = fr_Compose_Opaque;
+unsigned int txtColor = 0xFFFFFF;
+int winBufferCount = 2;
+ePixFormats winFormat = ePixFmt_XRGB8888;
+int initThreadCount = 3;
+int imgBandRows = 0;
+int logAsyncEnabled = 1;
+log_overflow_t logOverflowMode = LOG_OVERFLOW_DROP;
+#ifdef __QNX__
+const gfxBackendOps *gfx = &gfxScreenBackend;
+#else
+const gfxBackendOps *gfx = &gfxSoftBackend;
+#endif
+struct timespec stageTimes[eStage_COUNT];
+int stageMarked[eStage_COUNT] = {0};
+const char *stageNames[eStage_COUNT] = { "start", "window", "first band", "image decoded", "first frame", "font ready", "text frame" };
 
 /******************************************************************************
   File Scope Function Prototypes
@@ -95,7 +136,13 @@ int validate_file(const char *value) {
         } else {
             // Compare extension with allowed image formats (case-insensitive)
             log_message(LOG_DEBUG, "File extension: %s", ext);
-            if ( (strcasecmp(ext, ".png") == 0) || (strcasecmp(ext, ".jpg") == 0) || (strcasecmp(ext, ".jpeg") == 0) || (strcasecmp(ext, ".bmp") == 0) ) {
+#ifdef __QNX__
+            if ( (strcasecmp(ext, ".png") == 0) || (strcasecmp(ext, ".jpg") == 0) || (strcasecmp(ext, ".jpeg") == 0) || (strcasecmp(ext, ".bmp") == 0) ||
+                 (strcasecmp(ext, ".bgri") == 0) ) {
+#else
+            //No libimg off target: binary PPM and pre-converted images only
+            if ( (strcasecmp(ext, ".ppm") == 0) || (strcasecmp(ext, ".bgri") == 0) ) {
+#endif
                 // Basic file existence check (may not be reliable on all systems)
                 FILE* file = fopen(value, "rb");
                 if (file == NULL) {
@@ -143,17 +190,17 @@ int validate_scale(const char *value) {
 
     if (value) {
         if ( strcmp(value, "NONE") == 0 ) {
-            scale_mode = SCREEN_SCALE_NONE;
+            scale_mode = eScale_NONE;
         } else if ( strcmp(value, "STRETCH") == 0) {
-            scale_mode = SCREEN_SCALE_STRETCH;
+            scale_mode = eScale_STRETCH;
         } else if ( strcmp(value, "ZOOM") == 0) {
-            scale_mode = SCREEN_SCALE_ZOOM;
+            scale_mode = eScale_ZOOM;
         } else if ( strcmp(value, "FILL") == 0) {
-            scale_mode = SCREEN_SCALE_FILL;
+            scale_mode = eScale_FILL;
         } else if ( strcmp(value, "SHIFT_UP") == 0) {
-            scale_mode = SCREEN_SCALE_HALF_LINE_SHIFT_UP;
+            scale_mode = eScale_SHIFT_UP;
         } else if ( strcmp(value, "SHIFT_DOWN") == 0) {
-            scale_mode = SCREEN_SCALE_HALF_LINE_SHIFT_DOWN;
+            scale_mode = eScale_SHIFT_DOWN;
         } else {
             result = 0;
         }
@@ -168,15 +215,15 @@ int validate_mirror(const char *value) {
 
     if (value) {
         if ( strcmp(value, "DISABLED") == 0 ) {
-            mirror_mode = SCREEN_MIRROR_DISABLED;
+            mirror_mode = eMirror_DISABLED;
         } else if ( strcmp(value, "NORMAL") == 0) {
-            mirror_mode = SCREEN_MIRROR_NORMAL;
+            mirror_mode = eMirror_NORMAL;
         } else if ( strcmp(value, "STRETCH") == 0) {
-            mirror_mode = SCREEN_MIRROR_STRETCH;
+            mirror_mode = eMirror_STRETCH;
         } else if ( strcmp(value, "ZOOM") == 0) {
-            mirror_mode = SCREEN_MIRROR_ZOOM;
+            mirror_mode = eMirror_ZOOM;
         } else if ( strcmp(value, "FILL") == 0) {
-            mirror_mode = SCREEN_MIRROR_FILL;
+            mirror_mode = eMirror_FILL;
         } else {
             result = 0;
         }
@@ -186,6 +233,29 @@ int validate_mirror(const char *value) {
 }
 
 
+int validate_scaler(const char *value) {
+    int result = 1;
+
+    if (value) {
+        if ( strcmp(value, "AUTO") == 0 ) {
+            scaler_mode = eScaler_AUTO;
+        } else if ( strcmp(value, "HW") == 0) {
+            scaler_mode = eScaler_HW;
+        } else if ( strcmp(value, "NEAREST") == 0) {
+            scaler_mode = eScaler_NEAREST;
+        } else if ( strcmp(value, "BILINEAR") == 0) {
+            scaler_mode = eScaler_BILINEAR;
+        } else if ( strcmp(value, "AREA") == 0) {
+            scaler_mode = eScaler_AREA;
+        } else {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+
 int validate_verbosity(const char *value) {
     int result = 1;
 
@@ -274,37 +344,285 @@ int validate_text_source(const char *value) {
 }
 
 
+int validate_text_mode(const char *value) {
+    int result = 1;
+
+    if (value) {
+        if ( strcmp(value, "PIXMAP") == 0 ) {
+            txtComposeMode = fr_Compose_Opaque;
+        } else if ( strcmp(value, "BLEND") == 0 ) {
+            txtComposeMode = fr_Compose_Blend;
+        } else {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int validate_text_color(const char *value) {
+    int result = 0;
+    char *end = NULL;
+    unsigned long color;
+
+    if (value == NULL || strlen(value) == 0) {
+        log_message(LOG_WARNING, "Empty text color is invalid");
+    } else {
+        color = strtoul(value, &end, 16);
+        if ((*end != 0) || (color > 0xFFFFFF)) {
+            log_message(LOG_WARNING, "Text color is not a RRGGBB hex value: %s", value);
+        } else {
+            txtColor = (unsigned int)color;
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+int validate_atlas(const char *value) {
+    int result = 0;
+
+    if (value == NULL || strlen(value) == 0) {
+        log_message(LOG_WARNING, "Empty atlas path_name is invalid");
+    } else {
+        const char *ext = strrchr(value, '.');
+        if ((ext == NULL) || (strcasecmp(ext, ".fra") != 0)) {
+            log_message(LOG_WARNING, "Atlas file extension is not .fra");
+        } else {
+            FILE* file = fopen(value, "rb");
+            if (file == NULL) {
+                log_message(LOG_WARNING, "Atlas file could not be opened");
+            } else {
+                fclose(file);
+                log_message(LOG_INFO, "validate_atlas() passed");
+                result = 1;
+            }
+        }
+    }
+
+    return result;
+}
+
+int validate_ctrl(const char *value) {
+    int result = 0;
+
+    if (value == NULL || strlen(value) == 0) {
+        log_message(LOG_WARNING, "Empty control socket path is invalid");
+    } else if (strlen(value) >= 100) {
+        log_message(LOG_WARNING, "Control socket path is too long: %s", value);
+    } else {
+        result = 1;
+    }
+
+    return result;
+}
+
+
+int validate_buffers(const char *value) {
+    int result = 1;
+
+    if (value) {
+        if ( strcmp(value, "1") == 0 ) {
+            winBufferCount = 1;
+        } else if ( strcmp(value, "2") == 0 ) {
+            winBufferCount = 2;
+        } else if ( strcmp(value, "3") == 0 ) {
+            winBufferCount = 3;
+        } else {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int validate_win_format(const char *value) {
+    int result = 1;
+
+    if (value) {
+        if ( strcmp(value, "RGBX8888") == 0 ) {
+            winFormat = ePixFmt_XRGB8888;
+        } else if ( strcmp(value, "RGB565") == 0 ) {
+            winFormat = ePixFmt_RGB565;
+        } else {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int validate_log_queue(const char *value) {
+    int result = 1;
+
+    if (value) {
+        if ( strcmp(value, "DROP") == 0 ) {
+            logAsyncEnabled = 1;
+            logOverflowMode = LOG_OVERFLOW_DROP;
+        } else if ( strcmp(value, "BLOCK") == 0 ) {
+            logAsyncEnabled = 1;
+            logOverflowMode = LOG_OVERFLOW_BLOCK;
+        } else if ( strcmp(value, "OFF") == 0 ) {
+            logAsyncEnabled = 0;
+        } else {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int validate_log_bin(const char *value) {
+    return (value != NULL) && (strlen(value) > 0);
+}
+
+int validate_trace(const char *value) {
+    return (value != NULL) && (strlen(value) > 0) && (strlen(value) < 255);
+}
+
+int validate_progressive(const char *value) {
+    int result = 0;
+    char *end = NULL;
+    long rows;
+
+    if (value) {
+        rows = strtol(value, &end, 10);
+        if ((end != value) && (*end == 0) && (rows >= 0) && (rows <= 4096)) {
+            imgBandRows = (int)rows;
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+int validate_init_threads(const char *value) {
+    int result = 1;
+
+    if (value) {
+        if ( (strlen(value) == 1) && (value[0] >= '1') && (value[0] <= '0' + IS_MAX_THREADS) ) {
+            initThreadCount = value[0] - '0';
+        } else {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int validate_backend(const char *value) {
+    int result = 1;
+
+    if (value) {
+        if ( strcmp(value, "SOFT") == 0 ) {
+            gfx = &gfxSoftBackend;
+#ifdef __QNX__
+        } else if ( strcmp(value, "SCREEN") == 0 ) {
+            gfx = &gfxScreenBackend;
+#endif
+        } else {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int validate_soft_out(const char *value) {
+    int result = 0;
+
+    if (value == NULL || strlen(value) == 0) {
+        log_message(LOG_WARNING, "Empty frame output path is invalid");
+    } else {
+        const char *ext = strrchr(value, '.');
+        if ((ext == NULL) || (strcasecmp(ext, ".ppm") != 0)) {
+            log_message(LOG_WARNING, "Frame output file extension is not .ppm");
+        } else {
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+int validate_frame_cache(const char *value) {
+    int result = 0;
+
+    if (value == NULL || strlen(value) == 0) {
+        log_message(LOG_WARNING, "Empty frame cache path is invalid");
+    } else {
+        result = 1;
+    }
+
+    return result;
+}
 
 
 // Enumeration for parameter indices
 typedef enum {
     PARAM_VERBOCITY,
+    PARAM_LOG_QUEUE,
+    PARAM_LOG_BIN,
     PARAM_FILE,
     PARAM_ROTATION,
     PARAM_SCALE,
     PARAM_MIRROR,
+    PARAM_SCALER,
     PARAM_FONT,
     PARAM_TEXT,
     PARAM_TEXT_SOURCE,
+    PARAM_TEXT_MODE,
+    PARAM_TEXT_COLOR,
+    PARAM_ATLAS,
+    PARAM_CTRL,
+    PARAM_BUFFERS,
+    PARAM_WIN_FORMAT,
+    PARAM_BACKEND,
+    PARAM_SOFT_OUT,
+    PARAM_INIT_THREADS,
+    PARAM_FRAME_CACHE,
+    PARAM_PROGRESSIVE,
+    PARAM_TRACE,
     PARAM_COUNT // Automatically provides the count of parameters
 } ParameterIndex;
 
 // Define the array of parameters
 tCmdOptionParam params[] = {
     {"-v", 			"", 	validate_verbosity, 	"[-v=1..4]", 												"Verbosity (optional): 1-Error, 2-Warning+, 3-Info+, 4-Debug+.", 								false, 	false, 	"1"						},
+    {"-logQueue",	"", 	validate_log_queue,		"[-logQueue={DROP|BLOCK|OFF}]",								"Log lines are written by a background thread (optional): DROP-a full queue drops lines, BLOCK-the logger waits for room, OFF-written by the caller. Default: DROP",	false, 	false, 	"DROP"			 	},
+    {"-logBin",		"", 	validate_log_bin,		"[-logBin=fullPathToFile.bgrl]",							"Binary log (optional): messages are stored as format id and raw arguments, decoded with bgrLogDecode. Errors also go to stderr. Default: text",	false, 	false, 	""				 		},
     {"-file", 		"", 	validate_file, 			"-file=fullPathToFile", 									"Path to the input file (required).", 															true, 	false, 	NULL					},
     {"-rotation", 	"", 	validate_rotation, 		"[-rotation={0|90|180|270}]", 								"Rotation angle (optional): Clockwise, multiple of 90. Default: 0.", 							false, 	false, 	"0"						},
-    {"-scale", 		"", 	validate_scale, 		"[-scale={NONE|STRETCH|ZOOM|FILL|SHIFT_UP|SHIFT_DOWN}]", 	"Scale factor (optional): None or one of the listed types.", 									false, 	false, 	"NONE"					},
-    {"-mirror",		"", 	validate_mirror, 		"[-mirror={DISABLED|NORMAL|STRETCH|ZOOM|FILL}]", 			"Mirror Mode (optional): Disabled or one of the listed modes.", 								false, 	false, 	"DISABLED"				},
+    {"-scale", 		"", 	validate_scale, 		"[-scale={NONE|STRETCH|ZOOM|FILL|SHIFT_UP|SHIFT_DOWN}]", 	"Scale mode (optional): NONE-1:1, STRETCH-window size, ZOOM-aspect fit, FILL-aspect fill (cropped), SHIFT_UP/SHIFT_DOWN-ZOOM moved by half a line. Default: ZOOM",	false, 	false, 	"ZOOM"					},
+    {"-mirror",		"", 	validate_mirror, 		"[-mirror={DISABLED|NORMAL|STRETCH|ZOOM|FILL}]", 			"Mirror Mode (optional): Image flipped left to right; NORMAL keeps the -scale mode, STRETCH/ZOOM/FILL replace it. Default: DISABLED",	false, 	false, 	"DISABLED"				},
+    {"-scaler",		"", 	validate_scaler, 		"[-scaler={AUTO|HW|NEAREST|BILINEAR|AREA}]", 				"Image scaling (optional): HW-backend blit; NEAREST/BILINEAR/AREA-software, once per image. AUTO: HW unless mirror/shift need software. Default: AUTO",	false, 	false, 	"AUTO"					},
     {"-font",		"", 	validate_font, 			"[-font=fullPathToFontFile]",								"Font file to use (optional). Default: /usr/fonts/DejaVuSans.ttf", 								false, 	false, 	"/usr/fonts/DejaVuSans.ttf"	},
     {"-text",		"", 	validate_text, 			"[-text=\"Display text\"]",									"Quote enclosed non-null text to display (required). Default: Error text.",						false, 	false, 	"No -text= passed" 		},
-    {"-textSrc",	"", 	validate_text_source,	"[-textSrc={NONE|PARAM|ENVVAR}]",							"NONE for no text; ENVVAR for BOOT_TEXT_STR=\"..\"; PARAM for -text=\"..\"; Default: PARAM",	false, 	false, 	"PARAM"			 		}
+    {"-textSrc",	"", 	validate_text_source,	"[-textSrc={NONE|PARAM|ENVVAR}]",							"NONE for no text; ENVVAR for BOOT_TEXT_STR=\"..\"; PARAM for -text=\"..\"; Default: PARAM",	false, 	false, 	"PARAM"			 		},
+    {"-textMode",	"", 	validate_text_mode,		"[-textMode={PIXMAP|BLEND}]",								"PIXMAP: opaque text box blitted from a text pixmap; BLEND: text blended over the image. Default: PIXMAP",	false, 	false, 	"PIXMAP"			 	},
+    {"-textColor",	"", 	validate_text_color,	"[-textColor=RRGGBB]",										"Text color in hex (optional, BLEND mode only). Default: FFFFFF",									false, 	false, 	"FFFFFF"			 	},
+    {"-atlas",		"", 	validate_atlas,			"[-atlas=fullPathToAtlas.fra]",								"Pre-baked glyph atlas (optional). -font= is loaded only for glyphs missing in it.",				false, 	false, 	""				 		},
+    {"-ctrl",		"", 	validate_ctrl,			"[-ctrl=/path/to/socket]",									"Text update socket (optional): each line written to it replaces the text. Default: no updates.",	false, 	false, 	""				 		},
+    {"-buffers",	"", 	validate_buffers,		"[-buffers={1|2|3}]",										"Window buffers (optional): 1-single, 2-double, 3-triple buffering. Default: 2",					false, 	false, 	"2"				 		},
+    {"-winFormat",	"", 	validate_win_format,	"[-winFormat={RGBX8888|RGB565}]",							"Window pixel format (optional): RGB565 halves scan-out bandwidth; BLEND text falls back to PIXMAP. Default: RGBX8888",	false, 	false, 	"RGBX8888"			 	},
+#ifdef __QNX__
+    {"-backend",	"", 	validate_backend,		"[-backend={SCREEN|SOFT}]",									"Graphics backend (optional): SCREEN-QNX Screen, SOFT-software framebuffer. Default: SCREEN",	false, 	false, 	"SCREEN"			 	},
+#else
+    {"-backend",	"", 	validate_backend,		"[-backend=SOFT]",											"Graphics backend (optional): SOFT-software framebuffer. Default: SOFT",						false, 	false, 	"SOFT"				 	},
+#endif
+    {"-softOut",	"", 	validate_soft_out,		"[-softOut=fullPathToFile.ppm]",							"SOFT backend only (optional): every posted frame is written to this file. Default: none",		false, 	false, 	""				 		},
+    {"-initThreads",	"", 	validate_init_threads,	"[-initThreads={1..4}]",									"Startup worker threads (optional): screen setup, image decode and font loading overlap. Default: 3",	false, 	false, 	"3"				 		},
+    {"-frameCache",	"", 	validate_frame_cache,	"[-frameCache=fullPathToFile]",								"Composed frame cache (optional): a boot with unchanged inputs posts this frame without decoding. Default: none",	false, 	false, 	""				 		},
+    {"-progressive",	"", 	validate_progressive,	"[-progressive=rows]",										"Post the splash image in bands of this many rows while it decodes (optional). Default: 0, posted when complete",	false, 	false, 	"0"				 		},
+    {"-trace",		"", 	validate_trace,			"[-trace=fullPathToFile.json]",								"Timing trace (optional): Chrome trace_event JSON of startup and every update, written at exit, on SIGINT/SIGTERM and on SIGUSR1. Default: none",	false, 	false, 	""				 		}
 };
 
 /////////////////////////////////
 // Actual ImageLib code goes here
 /////////////////////////////////
 
+#ifdef __QNX__
 int getBytesPerPixel(img_t img) {
     int retval;
 
@@ -357,412 +675,1028 @@ int getBytesPerPixel(img_t img) {
     return retval;
 }
 
+// Conversion library format of a libimg format, ePixFmt_INVALID for those it does not convert (YUV888).
+// Alpha is dropped: the A formats map to their X twins.
+static ePixFormats ilPixFormatOfImg(img_format_t format) {
+    switch (format) {
+        case (IMG_FMT_PKLE_ARGB8888):
+        case (IMG_FMT_PKLE_XRGB8888):
+            return ePixFmt_XRGB8888;
+        case (IMG_FMT_PKBE_ARGB8888):
+        case (IMG_FMT_PKBE_XRGB8888):
+            return ePixFmt_XRGB8888_BE;
+        case (IMG_FMT_PKLE_ABGR8888):
+        case (IMG_FMT_PKLE_XBGR8888):
+            return ePixFmt_XBGR8888;
+        case (IMG_FMT_PKBE_ABGR8888):
+        case (IMG_FMT_PKBE_XBGR8888):
+            return ePixFmt_XBGR8888_BE;
+        case (IMG_FMT_RGB888):
+            return ePixFmt_RGB888;
+        case (IMG_FMT_BGR888):
+            return ePixFmt_BGR888;
+        case (IMG_FMT_PKLE_RGB565):
+            return ePixFmt_RGB565;
+        case (IMG_FMT_PKBE_RGB565):
+            return ePixFmt_RGB565_BE;
+        case (IMG_FMT_PKLE_ARGB1555):
+        case (IMG_FMT_PKLE_XRGB1555):
+            return ePixFmt_XRGB1555;
+        case (IMG_FMT_PKBE_ARGB1555):
+        case (IMG_FMT_PKBE_XRGB1555):
+            return ePixFmt_XRGB1555_BE;
+        case (IMG_FMT_G8):
+            return ePixFmt_G8;
+        case (IMG_FMT_A8):
+            return ePixFmt_A8;
+        case (IMG_FMT_PAL8):
+            return ePixFmt_PAL8;
+        case (IMG_FMT_PAL4):
+            return ePixFmt_PAL4;
+        case (IMG_FMT_PAL1):
+        case (IMG_FMT_MONO):
+            return ePixFmt_PAL1;
+        default:
+            return ePixFmt_INVALID;
+    }
+}
 
-void rotateImage180(unsigned char *data, int width, int height, int bytesPerPixel) {
-    int halfHeight = height / 2;
-/*    unsigned int pixelBytes;
+// libimg format of a display format
+static img_format_t ilImgFormatOf(ePixFormats format) {
+    return (format == ePixFmt_RGB565) ? IMG_FMT_PKLE_RGB565 : IMG_FMT_PKLE_XRGB8888;
+}
 
-       for (int i=0; i<height; i++) {
-           printf("imgdata: Row: %d ",i);
-           for (int j=0; j<width; j++) {
-               //printf("@%d:%02X%02X%02X%02X ",j, data[((i * width) + j)*4], data[((i * width) + j)*4 + 1], data[((i * width) + j)*4 + 2], data[((i * width) + j)*4 + 3]);
-               printf("@%d:", j);
-               pixelBytes = 0;
-               for (int k=0; k<4; k++) {
-            	   pixelBytes = (pixelBytes<<8) | data[((i * width) + j)*4 + k];
-               }
-               printf("%08X ", pixelBytes);
-           }
-           printf("\n");
-       }
-*/
+#endif
 
-    for (int row = 0; row < halfHeight; ++row) {
-        for (int col = 0; col < width; ++col) {
-            for (int byte = 0; byte < bytesPerPixel; ++byte) {
-                int topIndex = (row * width + col) * bytesPerPixel + byte;
-                int bottomIndex = ((height - 1 - row) * width + (width - 1 - col)) * bytesPerPixel + byte;
 
-                // Swap the pixels
-                unsigned char temp = data[topIndex];
-                data[topIndex] = data[bottomIndex];
-                data[bottomIndex] = temp;
-            }
-        }
+// Scale mode in effect: the mirror modes other than NORMAL bring their own.
+static int ilEffectiveScaleMode(void) {
+  switch (mirror_mode) {
+    case eMirror_STRETCH:
+      return eScale_STRETCH;
+    case eMirror_ZOOM:
+      return eScale_ZOOM;
+    case eMirror_FILL:
+      return eScale_FILL;
+    default:
+      return scale_mode;
+  }
+}
+
+// Non-zero if the image is scaled in software: asked for, or needed for a mirror or shift the backend blit can not do.
+static int ilSwScalerActive(void) {
+  int scaleMode = ilEffectiveScaleMode();
+
+  return (scaler_mode == eScaler_NEAREST) || (scaler_mode == eScaler_BILINEAR) || (scaler_mode == eScaler_AREA) ||
+         (mirror_mode != eMirror_DISABLED) || (scaleMode == eScale_SHIFT_UP) || (scaleMode == eScale_SHIFT_DOWN);
+}
+
+// Pixmap size for a srcWidth x srcHeight image: its displayed size if that is smaller, so no pixel is
+// decoded and stored only to be scaled away by the blit. Upscaling is left to the blit.
+static void ilDecodeTargetSize(bgrImgPixmapData *pImgPxmpData, int srcWidth, int srcHeight, int *targetSize) {
+  int decodeBound[2];
+  int imageRect[4];
+
+  targetSize[0] = srcWidth;
+  targetSize[1] = srcHeight;
+  //A quarter turn applied after the decode puts the image's width along the window's height
+  if ((pImgPxmpData->imgRotationAngle == 90) || (pImgPxmpData->imgRotationAngle == 270)) {
+    decodeBound[0] = pImgPxmpData->imgDecodeBound[1];
+    decodeBound[1] = pImgPxmpData->imgDecodeBound[0];
+  } else {
+    decodeBound[0] = pImgPxmpData->imgDecodeBound[0];
+    decodeBound[1] = pImgPxmpData->imgDecodeBound[1];
+  }
+  if ((decodeBound[0] > 0) && (decodeBound[1] > 0)) {
+    bgrCalcImageRect(srcWidth, srcHeight, decodeBound, ilEffectiveScaleMode(), imageRect);
+    if ((imageRect[2] > 0) && (imageRect[3] > 0) && (imageRect[2] < srcWidth) && (imageRect[3] < srcHeight)) {
+      targetSize[0] = imageRect[2];
+      targetSize[1] = imageRect[3];
+      log_message(LOG_INFO, "Image %dx%d is decoded at its displayed size %dx%d", srcWidth, srcHeight, targetSize[0], targetSize[1]);
     }
+  }
+}
 
-    // If the height is odd, we need to reverse the middle row
-    if (height % 2 != 0) {
-        int middleRow = halfHeight;
-        for (int col = 0; col < width / 2; ++col) {
-            for (int byte = 0; byte < bytesPerPixel; ++byte) {
-                int leftIndex = (middleRow * width + col) * bytesPerPixel + byte;
-                int rightIndex = (middleRow * width + (width - 1 - col)) * bytesPerPixel + byte;
-
-                // Swap the pixels
-                unsigned char temp = data[leftIndex];
-                data[leftIndex] = data[rightIndex];
-                data[rightIndex] = temp;
-            }
-        }
+// Called by the decoders as pixmap rows complete. Once a band's worth of new rows is there (or the image is complete),
+// they are blitted and posted with just their window area as damage, while the rest of the image still decodes.
+static void ilImageRowsDecoded(bgrImgPixmapData *pImgPxmpData, int rowsDone) {
+  bgrScrWinContexts *pScrWinCtxt = pImgPxmpData->pImgBandWin;
+  int imageRect[4];
+  int bandRect[4];
+  int repaintRect[4];
+  int destY;
+
+  if ((pScrWinCtxt == NULL) || (pImgPxmpData->imgBandRows <= 0) ||
+      ((rowsDone - pImgPxmpData->imgBandPosted < pImgPxmpData->imgBandRows) && (rowsDone < pImgPxmpData->imgHeight))) {
+    return;
+  }
+
+  bgrCalcImageRect(pImgPxmpData->imgWidth, pImgPxmpData->imgHeight, pScrWinCtxt->scrWinBufferSize, ilEffectiveScaleMode(), imageRect);
+  destY = imageRect[1];
+  bandRect[0] = 0;
+  bandRect[1] = destY + (int)((long long)pImgPxmpData->imgBandPosted * imageRect[3] / pImgPxmpData->imgHeight);
+  bandRect[2] = pScrWinCtxt->scrWinBufferSize[0];
+  bandRect[3] = destY + (int)((long long)rowsDone * imageRect[3] / pImgPxmpData->imgHeight) - bandRect[1];
+  pImgPxmpData->imgBandPosted = rowsDone;
+
+  bgrAddDamage(pScrWinCtxt, bandRect);
+  bgrGetRepaintRect(pScrWinCtxt, repaintRect);
+  if ((bgrBlitImagePixmap(pImgPxmpData, pScrWinCtxt, repaintRect) != EOK) || (bgrPresentWindow(pScrWinCtxt) != EOK)) {
+    log_message(LOG_WARNING, "Image band not posted, the image shows when decoded");
+    pImgPxmpData->pImgBandWin = NULL;
+    return;
+  }
+  log_message(LOG_DEBUG, "Image band up to row %d of %d posted", rowsDone, pImgPxmpData->imgHeight);
+  bgrMarkStage(eStage_FIRST_BAND);
+}
+
+#ifdef __QNX__
+// Header only pass: records the source size and stops libimg before any pixel is decoded.
+static int ilProbeSetup(uintptr_t data, img_t *img, unsigned flags)
+{
+  int *pSrcSize = (int *)data;
+
+  pSrcSize[0] = img->w;
+  pSrcSize[1] = img->h;
+  return -1;
+}
+
+// Offered the formats the codec decodes to without converting, returns the index of the pixmap format if it is one
+// of them, else of the first one PixFormat converts from. With neither, index 0 is returned and the setup callout
+// rejects it, so the image is decoded again with libimg converting into the pixmap format.
+static unsigned ilDecodeChooseFormat(uintptr_t data, img_t *img, const img_format_t *formats, unsigned nformats)
+{
+  bgrImgPixmapData *pImgPixmapData = (bgrImgPixmapData *)data;
+  unsigned chosen = 0;
+  int found = 0;
+  unsigned i;
+
+  for (i = 0; i < nformats; i++) {
+    if (ilPixFormatOfImg(formats[i]) == pImgPixmapData->imgPixmapFormat) {
+      return i;
     }
+    if (!found && (ilPixFormatOfImg(formats[i]) != ePixFmt_INVALID)) {
+      chosen = i;
+      found = 1;
+    }
+  }
+  return chosen;
 }
 
+// Converts the native rows decoded so far, up to lastRow, into the pixmap.
+static void ilConvertNativeRows(bgrImgPixmapData *pImgPixmapData, img_t *img, int lastRow)
+{
+  static const uint32_t monoPalette[2] = { 0xff000000u, 0xffffffffu };
+  gfxBufferInfo bufInfo;
+  unsigned i;
+  int y;
 
+  if ((pImgPixmapData->pImgNative == NULL) || pImgPixmapData->imgConvertFailed || (lastRow < pImgPixmapData->imgRowsConverted)) {
+    return;
+  }
+  if (!pImgPixmapData->imgPaletteReady) {
+    //Entries past npalette stay black, so stray indexes never read past the palette
+    memset(pImgPixmapData->imgPalette, 0, sizeof(pImgPixmapData->imgPalette));
+    if ((img->palette != NULL) && (img->npalette > 0)) {
+      for (i = 0; (i < img->npalette) && (i < 256); i++) {
+        pImgPixmapData->imgPalette[i] = img->palette[i];
+      }
+    } else if (img->format == IMG_FMT_MONO) {
+      memcpy(pImgPixmapData->imgPalette, monoPalette, sizeof(monoPalette));
+    }
+    pImgPixmapData->imgPaletteReady = 1;
+  }
+  if (gfx->getBufferInfo(pImgPixmapData->imgPixmapBuffer, &bufInfo) != EOK) {
+    pImgPixmapData->imgConvertFailed = 1;
+    return;
+  }
+  for (y = pImgPixmapData->imgRowsConverted; y <= lastRow; y++) {
+    pfConvertRow((uint8_t *)bufInfo.pData + (size_t)y * bufInfo.stride, bufInfo.format,
+                 pImgPixmapData->pImgNative + (size_t)y * pImgPixmapData->imgNativeStride, pImgPixmapData->imgNativeFormat,
+                 pImgPixmapData->imgWidth, pImgPixmapData->imgPalette);
+  }
+  pImgPixmapData->imgRowsConverted = lastRow + 1;
+}
 
+// Rows in the pixmap format are decoded straight into the pixmap. Any other format libimg delivers is decoded into
+// a buffer of its own and converted once, row by row, as rows complete.
 static int ilDecodeSetupPixmap(uintptr_t data, img_t *img, unsigned flags)
 {
   bgrImgPixmapData *pImgPixmapData = (bgrImgPixmapData *)data;
-  int size[2];
-  int screenIfaceResult = -1;
-
-  size[0] = img->w;
-  size[1] = img->h;
-  //screen_set_window_property_iv(screen_win, SCREEN_PROPERTY_BUFFER_SIZE, size);
-  screenIfaceResult = screen_set_pixmap_property_iv(pImgPixmapData->imgPixmap, SCREEN_PROPERTY_BUFFER_SIZE, size);
-  if (screenIfaceResult != EOK) {
-    log_message(LOG_ERROR, "decode_setup_pixmap::screen_set_pixmap_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) with size[0]:%d, size[0]:%d returned non-zero: %d", size[0], size[1], screenIfaceResult);
-    screenIfaceResult = -1;
+  ePixFormats nativeFormat = ilPixFormatOfImg(img->format);
+  gfxBufferInfo bufInfo;
+  int gfxResult = -1;
+
+  if (nativeFormat == ePixFmt_INVALID) {
+    log_message(LOG_INFO, "decode_setup_pixmap: no conversion from libimg format %d, decoded again as %s", img->format, pfFormatName(pImgPixmapData->imgPixmapFormat));
+    pImgPixmapData->imgConvertFailed = 1;
+    return -3;
+  }
+  gfxResult = gfx->createPixmapBuffer(pImgPixmapData->imgPixmap, img->w, img->h, pImgPixmapData->imgPixmapFormat, &(pImgPixmapData->imgPixmapBuffer));
+  if (gfxResult != EOK) {
+    log_message(LOG_ERROR, "decode_setup_pixmap::createPixmapBuffer() with size[0]:%d, size[1]:%d returned non-zero: %d", img->w, img->h, gfxResult);
+    gfxResult = -1;
   } else {
-    screenIfaceResult = screen_create_pixmap_buffer(pImgPixmapData->imgPixmap);
-    if (screenIfaceResult != EOK) {
-      log_message(LOG_ERROR, "decode_setup_pixmap::screen_create_pixmap_buffer()  returned non-zero: %d", screenIfaceResult);
-      screenIfaceResult = -2;
+    pImgPixmapData->imgPixmapBufferState = eHandleValid;
+    gfxResult = gfx->getBufferInfo(pImgPixmapData->imgPixmapBuffer, &bufInfo);
+    if (gfxResult != EOK) {
+      log_message(LOG_ERROR, "decode_setup_pixmap::getBufferInfo() returned non-zero: %d", gfxResult);
+      gfxResult = -2;
     } else {
-      screenIfaceResult = screen_get_pixmap_property_pv(pImgPixmapData->imgPixmap, SCREEN_PROPERTY_RENDER_BUFFERS, (void **)&(pImgPixmapData->imgPixmapBuffer));
-      if (screenIfaceResult != EOK) {
-        log_message(LOG_ERROR, "decode_setup_pixmap::screen_get_pixmap_property_pv(SCREEN_PROPERTY_RENDER_BUFFERS) returned non-zero: %d", screenIfaceResult);
-        screenIfaceResult = -3;
+      pImgPixmapData->imgWidth = img->w;
+      pImgPixmapData->imgHeight = img->h;
+      pImgPixmapData->imgBandPosted = 0;
+      pImgPixmapData->imgRowsConverted = 0;
+      pImgPixmapData->imgPaletteReady = 0;
+      if (nativeFormat == bufInfo.format) {
+        img->access.direct.data = bufInfo.pData;
+        img->access.direct.stride = bufInfo.stride;
+        gfxResult = 0;
       } else {
-        pImgPixmapData->imgPixmapBufferState = eHandleValid;
-        screenIfaceResult = screen_get_buffer_property_pv(pImgPixmapData->imgPixmapBuffer, SCREEN_PROPERTY_POINTER, (void **)&img->access.direct.data);
-        if (screenIfaceResult != EOK) {
-          log_message(LOG_ERROR, "decode_setup_pixmap::screen_get_buffer_property_pv(SCREEN_PROPERTY_POINTER) returned non-zero: %d", screenIfaceResult);
-          screenIfaceResult = -4;
+        pImgPixmapData->imgNativeFormat = nativeFormat;
+        pImgPixmapData->imgNativeStride = (pfRowBytes(nativeFormat, img->w) + 3) & ~3;
+        pImgPixmapData->pImgNative = malloc((size_t)pImgPixmapData->imgNativeStride * img->h);
+        if (pImgPixmapData->pImgNative == NULL) {
+          log_message(LOG_ERROR, "decode_setup_pixmap: no memory for %dx%d %s rows", img->w, img->h, pfFormatName(nativeFormat));
+          gfxResult = -4;
         } else {
-          screenIfaceResult = screen_get_buffer_property_iv(pImgPixmapData->imgPixmapBuffer, SCREEN_PROPERTY_STRIDE, (int *)&img->access.direct.stride);
-          if (screenIfaceResult != EOK) {
-            log_message(LOG_ERROR, "decode_setup_pixmap::screen_get_buffer_property_pv(SCREEN_PROPERTY_STRIDE) returned non-zero: %d", screenIfaceResult);
-            screenIfaceResult = -5;
-          } else {
-            screenIfaceResult = 0;
-            log_message(LOG_DEBUG, "decode_setup_pixmap: pix_buf:%d, img->access.direct.data:%d ", pImgPixmapData->imgPixmapBuffer, img->access.direct.data);
-          }
+          img->access.direct.data = pImgPixmapData->pImgNative;
+          img->access.direct.stride = pImgPixmapData->imgNativeStride;
+          gfxResult = 0;
+          log_message(LOG_INFO, "decode_setup_pixmap: decoded as %s, converted into %s", pfFormatName(nativeFormat), pfFormatName(bufInfo.format));
         }
       }
+      log_message(LOG_DEBUG, "decode_setup_pixmap: img->access.direct.data:%p, stride:%d", img->access.direct.data, img->access.direct.stride);
     }
   }
 
    img->flags |= IMG_DIRECT;
 
-   return screenIfaceResult;
+   return gfxResult;
+}
+
+// Interlaced images complete their rows only in the last pass, so only that one is converted and posted.
+static int ilDecodeScanline(uintptr_t data, img_t *img, unsigned row, unsigned npass_line, unsigned npass_total)
+{
+  if (npass_line == npass_total) {
+    ilConvertNativeRows((bgrImgPixmapData *)data, img, row);
+    ilImageRowsDecoded((bgrImgPixmapData *)data, row + 1);
+  }
+  return IMG_ERR_OK;
+}
+
+static void ilDecodeFreeNative(bgrImgPixmapData *pImgPixmapData)
+{
+  free(pImgPixmapData->pImgNative);
+  pImgPixmapData->pImgNative = NULL;
 }
 
 static void ilDecodeAbortPixmap(uintptr_t data, img_t *img)
 {
   bgrImgPixmapData *pImgPixmapData = (bgrImgPixmapData *)data;
-//  screen_window_t screen_pixmap = (screen_window_t)data;
-  screen_destroy_pixmap_buffer(pImgPixmapData->imgPixmap);
+  gfx->destroyPixmapBuffer(pImgPixmapData->imgPixmap);
+  pImgPixmapData->imgPixmapBufferState = eHandleUninit;
+  ilDecodeFreeNative(pImgPixmapData);
 }
-// This version targets render loops support.
-int bgrLoadImagePixmap(bgrImgPixmapData *pImgPxmpData)
-{
+
+// Decodes the image file with libimg into the image pixmap buffer, in the codec's own format where PixFormat
+// converts from it. A format it does not know is decoded a second time, with libimg converting instead.
+static int ilDecodeImage(bgrImgPixmapData *pImgPxmpData) {
   img_decode_callouts_t callouts;
-  img_lib_t ilib = NULL;
+  int srcSize[2] = {0, 0};
+  int targetSize[2];
   int rc;
 
-  rc = img_lib_attach(&ilib);
-  if (rc != IMG_ERR_OK) {
-    log_message(LOG_ERROR, "Failed to load lib. Error %d ", rc);
-    return -1;
-  } else {
-    memset(&(pImgPxmpData->img), 0, sizeof(img_lib_t));
-    pImgPxmpData->img.flags |= IMG_FORMAT;
-    pImgPxmpData->img.format = IMG_FMT_PKLE_XRGB8888;
-
-    if (pImgPxmpData->imgPixmapBufferState == eHandleValid) {
-    	screen_destroy_pixmap_buffer(pImgPxmpData->imgPixmap);
-    	pImgPxmpData->imgPixmapBufferState = eHandleUninit;
+  if (pImgPxmpData->imgLibState != eHandleValid) {
+    rc = img_lib_attach(&(pImgPxmpData->imgLib));
+    if (rc != IMG_ERR_OK) {
+      log_message(LOG_ERROR, "Failed to load lib. Error %d ", rc);
+      return -1;
     }
+    pImgPxmpData->imgLibState = eHandleValid;
+  }
+
+  memset(&(pImgPxmpData->img), 0, sizeof(img_t));
+
+  //With a display bound, read the header first: libimg scales while loading when asked for a size
+  if ((pImgPxmpData->imgDecodeBound[0] > 0) && (pImgPxmpData->imgDecodeBound[1] > 0)) {
+    img_t probeImg;
 
+    memset(&probeImg, 0, sizeof(img_t));
     memset(&callouts, 0, sizeof(callouts));
-    callouts.setup_f = ilDecodeSetupPixmap;
-    callouts.abort_f = ilDecodeAbortPixmap;
-    callouts.data = (uintptr_t)pImgPxmpData;
-
-    rc = img_load_file(ilib, pImgPxmpData->imgFileName, &callouts, &(pImgPxmpData->img));
-    if (rc == IMG_ERR_OK) {
-      //printf( "imgdata: img.h:%d , img.w:%d, img.flags:%d, img.format:%d \n",img.h, img.w, img.flags, img.format );
-      log_message(LOG_DEBUG,
-                  "imgdata: img.h:%d, img.w:%d, img.flags:%d, img.format:%d",
-                  pImgPxmpData->img.h, pImgPxmpData->img.w, pImgPxmpData->img.flags, pImgPxmpData->img.format
-                 );
-
-      if (pImgPxmpData->imgRotationAngle == IMG_ANGLE_180) {
-        //img_rotate_ortho(&img, &img, IMG_ANGLE_180);
-        //log_message(LOG_INFO, "Rotation 180");
-        //rotateImage180(pImgPxmpData->img.access.direct.data, pImgPxmpData->img.w, pImgPxmpData->img.h, getBytesPerPixel(pImgPxmpData->img));
+    callouts.setup_f = ilProbeSetup;
+    callouts.data = (uintptr_t)srcSize;
+    img_load_file(pImgPxmpData->imgLib, pImgPxmpData->imgFileName, &callouts, &probeImg);
+    if ((srcSize[0] > 0) && (srcSize[1] > 0)) {
+      ilDecodeTargetSize(pImgPxmpData, srcSize[0], srcSize[1], targetSize);
+      if ((targetSize[0] != srcSize[0]) || (targetSize[1] != srcSize[1])) {
+        pImgPxmpData->img.flags |= IMG_W | IMG_H;
+        pImgPxmpData->img.w = targetSize[0];
+        pImgPxmpData->img.h = targetSize[1];
       }
+    } else {
+      log_message(LOG_WARNING, "bgrLoadImagePixmap: size of %s unknown, decoded at full size", pImgPxmpData->imgFileName);
     }
+  }
 
-    img_lib_detach(ilib);
-
-    return rc == IMG_ERR_OK ? 0 : -1;
-  }
-}
-
-
-
-void setup_blit_attributes(int src_x, int src_y, int src_width, int src_height,
-                           int dst_x, int dst_y, int dst_width, int dst_height,
-                           int global_alpha, int transparency, int scale_quality,
-                           int *attribs) {
-    int index = 0;
-    attribs[index++] = SCREEN_BLIT_SOURCE_X;
-    attribs[index++] = src_x;
-    attribs[index++] = SCREEN_BLIT_SOURCE_Y;
-    attribs[index++] = src_y;
-    attribs[index++] = SCREEN_BLIT_SOURCE_WIDTH;
-    attribs[index++] = src_width;
-    attribs[index++] = SCREEN_BLIT_SOURCE_HEIGHT;
-    attribs[index++] = src_height;
-    attribs[index++] = SCREEN_BLIT_DESTINATION_X;
-    attribs[index++] = dst_x;
-    attribs[index++] = SCREEN_BLIT_DESTINATION_Y;
-    attribs[index++] = dst_y;
-    attribs[index++] = SCREEN_BLIT_DESTINATION_WIDTH;
-    attribs[index++] = dst_width;
-    attribs[index++] = SCREEN_BLIT_DESTINATION_HEIGHT;
-    attribs[index++] = dst_height;
-    attribs[index++] = SCREEN_BLIT_GLOBAL_ALPHA;
-    attribs[index++] = global_alpha;
-    attribs[index++] = SCREEN_BLIT_TRANSPARENCY;
-    attribs[index++] = transparency;
-    attribs[index++] = SCREEN_BLIT_SCALE_QUALITY;
-    attribs[index++] = scale_quality;
-    attribs[index++] = SCREEN_BLIT_END;
-}
-
-int createWindow(screen_context_t *pScreen_ctx, screen_window_t *pScreen_win, int *screen_size, int *buffer_size) {
-    const int windowUsage = SCREEN_USAGE_WRITE | SCREEN_USAGE_READ | SCREEN_USAGE_NATIVE ;
-	int createWindowResult = -1;
-	int screenIfaceResult;
-	//screen_context_t screen_ctx = *pScreen_ctx;
-	//screen_window_t screen_win = *pScreen_win;
-
-    screenIfaceResult = screen_create_window(pScreen_win, *pScreen_ctx);
-    if (screenIfaceResult == EOK) {
-      screenIfaceResult = screen_set_window_property_iv(*pScreen_win, SCREEN_PROPERTY_USAGE, &windowUsage);
-      if (screenIfaceResult == EOK) {
-        //@Fix: format neither received nor stored.
-        screenIfaceResult = screen_set_window_property_iv(*pScreen_win, SCREEN_PROPERTY_FORMAT, (int[]){SCREEN_FORMAT_RGBX8888});
-        if (screenIfaceResult == EOK) {
-          screenIfaceResult = screen_get_window_property_iv(*pScreen_win, SCREEN_PROPERTY_SIZE, screen_size);
-          if (screenIfaceResult == EOK) {
-            screenIfaceResult = screen_get_window_property_iv(*pScreen_win, SCREEN_PROPERTY_BUFFER_SIZE, buffer_size);
-            if (screenIfaceResult == EOK) {
-              createWindowResult = 0; //EOK
-            } else {
-                log_message(LOG_ERROR, "createWindow::screen_get_window_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) returned non-zero: %d ", screenIfaceResult);
-                createWindowResult = -5;
-            }
-          } else {
-              log_message(LOG_ERROR, "createWindow::screen_get_window_property_iv(SCREEN_PROPERTY_SIZE) returned non-zero: %d ", screenIfaceResult);
-              createWindowResult = -4;
+  memset(&callouts, 0, sizeof(callouts));
+  callouts.choose_format_f = ilDecodeChooseFormat;
+  callouts.setup_f = ilDecodeSetupPixmap;
+  callouts.abort_f = ilDecodeAbortPixmap;
+  callouts.scanline_f = ilDecodeScanline;
+  callouts.data = (uintptr_t)pImgPxmpData;
+
+  pImgPxmpData->imgConvertFailed = 0;
+  rc = img_load_file(pImgPxmpData->imgLib, pImgPxmpData->imgFileName, &callouts, &(pImgPxmpData->img));
+  if ((rc != IMG_ERR_OK) && pImgPxmpData->imgConvertFailed) {
+    if (pImgPxmpData->imgPixmapBufferState == eHandleValid) {
+      ilDecodeAbortPixmap((uintptr_t)pImgPxmpData, &(pImgPxmpData->img));
+    }
+    pImgPxmpData->img.flags = (pImgPxmpData->img.flags & (IMG_W | IMG_H)) | IMG_FORMAT;
+    pImgPxmpData->img.format = ilImgFormatOf(pImgPxmpData->imgPixmapFormat);
+    callouts.choose_format_f = NULL;
+    pImgPxmpData->imgConvertFailed = 0;
+    rc = img_load_file(pImgPxmpData->imgLib, pImgPxmpData->imgFileName, &callouts, &(pImgPxmpData->img));
+  }
+  if (rc == IMG_ERR_OK) {
+    log_message(LOG_DEBUG,
+                "imgdata: img.h:%d, img.w:%d, img.flags:%d, img.format:%d",
+                pImgPxmpData->img.h, pImgPxmpData->img.w, pImgPxmpData->img.flags, pImgPxmpData->img.format
+               );
+    pImgPxmpData->imgWidth = pImgPxmpData->img.w;
+    pImgPxmpData->imgHeight = pImgPxmpData->img.h;
+    //Codecs that do not report scanlines leave all rows to convert here
+    ilConvertNativeRows(pImgPxmpData, &(pImgPxmpData->img), pImgPxmpData->imgHeight - 1);
+    ilDecodeFreeNative(pImgPxmpData);
+  } else {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap::img_load_file(%s) returned %d", pImgPxmpData->imgFileName, rc);
+    ilDecodeFreeNative(pImgPxmpData);
+  }
+
+  return rc == IMG_ERR_OK ? 0 : -1;
+}
+
+#else
+
+// Reads one PPM header token, skipping white space and comments.
+static int ilReadPpmToken(FILE *in, int *pValue) {
+  int c;
+
+  do {
+    c = fgetc(in);
+    if (c == '#') {
+      while ((c != '\n') && (c != EOF)) {
+        c = fgetc(in);
+      }
+    }
+  } while ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'));
+  if ((c < '0') || (c > '9')) {
+    return -1;
+  }
+  *pValue = 0;
+  while ((c >= '0') && (c <= '9')) {
+    *pValue = *pValue * 10 + (c - '0');
+    c = fgetc(in);
+  }
+  // The single white space after the last header value is consumed by the loop above
+  return 0;
+}
+
+// Off target there is no libimg: binary PPM (P6, 8 bits per channel) is decoded into the image pixmap buffer.
+// Images larger than their displayed size are box filtered down while streaming rows: only one source
+// row and one row of channel sums are held, never the full size image. Rows are converted from RGB888
+// (or the averaged XRGB8888) into the pixmap format as they complete.
+static int ilDecodeImage(bgrImgPixmapData *pImgPxmpData) {
+  FILE *in;
+  gfxBufferInfo bufInfo;
+  uint8_t *rgbRow = NULL;
+  uint64_t *rowSums = NULL;
+  uint64_t *pSum;
+  int *colMap = NULL;
+  int *colCount = NULL;
+  uint32_t *boxRow = NULL;
+  uint64_t boxSize;
+  int width, height, maxVal;
+  int targetSize[2];
+  int scaled;
+  int bandRows = 0;
+  int x, y, ty;
+  int decodeResult = -1;
+
+  in = fopen(pImgPxmpData->imgFileName, "rb");
+  if (in == NULL) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap::fopen(%s) failed: %s", pImgPxmpData->imgFileName, strerror(errno));
+    return -1;
+  }
+
+  if ((fgetc(in) != 'P') || (fgetc(in) != '6') ||
+      (ilReadPpmToken(in, &width) != 0) || (ilReadPpmToken(in, &height) != 0) || (ilReadPpmToken(in, &maxVal) != 0) ||
+      (width <= 0) || (height <= 0) || (maxVal != 255)) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap: %s is not a binary 8 bit PPM", pImgPxmpData->imgFileName);
+    fclose(in);
+    return -2;
+  }
+  ilDecodeTargetSize(pImgPxmpData, width, height, targetSize);
+  scaled = (targetSize[0] != width) || (targetSize[1] != height);
+
+  if (gfx->createPixmapBuffer(pImgPxmpData->imgPixmap, targetSize[0], targetSize[1], pImgPxmpData->imgPixmapFormat, &(pImgPxmpData->imgPixmapBuffer)) != EOK) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap::createPixmapBuffer(%dx%d) failed", targetSize[0], targetSize[1]);
+    fclose(in);
+    return -3;
+  }
+  pImgPxmpData->imgPixmapBufferState = eHandleValid;
+  rgbRow = malloc((size_t)width * 3);
+  if (scaled) {
+    rowSums = calloc((size_t)targetSize[0] * 3, sizeof(uint64_t));
+    colMap = malloc((size_t)width * sizeof(int));
+    colCount = calloc(targetSize[0], sizeof(int));
+    boxRow = malloc((size_t)targetSize[0] * sizeof(uint32_t));
+  }
+  if ((rgbRow == NULL) || (scaled && ((rowSums == NULL) || (colMap == NULL) || (colCount == NULL) || (boxRow == NULL))) ||
+      (gfx->getBufferInfo(pImgPxmpData->imgPixmapBuffer, &bufInfo) != EOK)) {
+    decodeResult = -4;
+  } else {
+    decodeResult = 0;
+    pImgPxmpData->imgWidth = targetSize[0];
+    pImgPxmpData->imgHeight = targetSize[1];
+    pImgPxmpData->imgBandPosted = 0;
+    if (scaled) {
+      for (x = 0; x < width; x++) {
+        colMap[x] = (int)((long long)x * targetSize[0] / width);
+        colCount[colMap[x]]++;
+      }
+    }
+    for (y = 0; (y < height) && (decodeResult == 0); y++) {
+      if (fread(rgbRow, 3, width, in) != (size_t)width) {
+        log_message(LOG_ERROR, "bgrLoadImagePixmap: %s is truncated", pImgPxmpData->imgFileName);
+        decodeResult = -5;
+      } else if (!scaled) {
+        pfConvertRow((uint8_t *)bufInfo.pData + (size_t)y * bufInfo.stride, bufInfo.format, rgbRow, ePixFmt_RGB888, width, NULL);
+        ilImageRowsDecoded(pImgPxmpData, y + 1);
+      } else {
+        for (x = 0; x < width; x++) {
+          pSum = &rowSums[colMap[x] * 3];
+          pSum[0] += rgbRow[x * 3];
+          pSum[1] += rgbRow[x * 3 + 1];
+          pSum[2] += rgbRow[x * 3 + 2];
+        }
+        bandRows++;
+        // Last source row of this target row: average the box and start the next one
+        ty = (int)((long long)y * targetSize[1] / height);
+        if ((y + 1 == height) || ((int)((long long)(y + 1) * targetSize[1] / height) != ty)) {
+          for (x = 0; x < targetSize[0]; x++) {
+            boxSize = (uint64_t)colCount[x] * bandRows;
+            boxRow[x] = 0xff000000u | ((uint32_t)((rowSums[x * 3] + boxSize / 2) / boxSize) << 16) |
+                        ((uint32_t)((rowSums[x * 3 + 1] + boxSize / 2) / boxSize) << 8) | (uint32_t)((rowSums[x * 3 + 2] + boxSize / 2) / boxSize);
           }
-        } else {
-          log_message(LOG_ERROR, "createWindow::screen_set_window_property_iv(SCREEN_PROPERTY_FORMAT) returned non-zero: %d ", screenIfaceResult);
-          createWindowResult = -3;
+          pfConvertRow((uint8_t *)bufInfo.pData + (size_t)ty * bufInfo.stride, bufInfo.format, boxRow, ePixFmt_XRGB8888, targetSize[0], NULL);
+          memset(rowSums, 0, (size_t)targetSize[0] * 3 * sizeof(uint64_t));
+          bandRows = 0;
+          ilImageRowsDecoded(pImgPxmpData, ty + 1);
         }
-      } else {
-        log_message(LOG_ERROR, "createWindow::screen_set_window_property_iv(SCREEN_PROPERTY_USAGE) returned non-zero: %d ", screenIfaceResult);
-        createWindowResult = -2;
       }
-    } else {
-        log_message(LOG_ERROR, "createWindow::screen_create_window() returned non-zero: %d ", screenIfaceResult);
-        createWindowResult = -1;
     }
+  }
+  free(rgbRow);
+  free(rowSums);
+  free(colMap);
+  free(colCount);
+  free(boxRow);
+  if (decodeResult != 0) {
+    gfx->destroyPixmapBuffer(pImgPxmpData->imgPixmap);
+    pImgPxmpData->imgPixmapBufferState = eHandleUninit;
+  } else {
+    log_message(LOG_DEBUG, "imgdata: h:%d, w:%d (PPM %dx%d)", targetSize[1], targetSize[0], width, height);
+    pImgPxmpData->imgWidth = targetSize[0];
+    pImgPxmpData->imgHeight = targetSize[1];
+  }
 
-	return createWindowResult;
+  fclose(in);
+  return decodeResult;
 }
+#endif
 
-int bgrCreateWindow(bgrScrWinContexts *pScrWinCtxt) {
-  int createWindowResult = -1;
-  int screenIfaceResult;
+// Expands the RLE packets of one row. Returns the number of words consumed, or 0 if the packets do not fill exactly one row.
+static size_t ilDecodeRleRow(const uint32_t *pData, size_t words, uint32_t *pRow, int width) {
+  size_t used = 0;
+  uint32_t count, i;
+  int x = 0;
 
-    screenIfaceResult = screen_create_window( &(pScrWinCtxt->scrWin), pScrWinCtxt->scrCtx);
-    if (screenIfaceResult == EOK) {
-      screenIfaceResult = screen_set_window_property_iv(pScrWinCtxt->scrWin, SCREEN_PROPERTY_USAGE, &(pScrWinCtxt->scrWinUsage));
-      if (screenIfaceResult == EOK) {
-        screenIfaceResult = screen_set_window_property_iv(pScrWinCtxt->scrWin, SCREEN_PROPERTY_FORMAT, &(pScrWinCtxt->scrWinFormat));
-        if (screenIfaceResult == EOK) {
-          screenIfaceResult = screen_get_window_property_iv(pScrWinCtxt->scrWin, SCREEN_PROPERTY_SIZE, pScrWinCtxt->scrWinSize);
-          if (screenIfaceResult == EOK) {
-            screenIfaceResult = screen_get_window_property_iv(pScrWinCtxt->scrWin, SCREEN_PROPERTY_BUFFER_SIZE, pScrWinCtxt->scrWinBufferSize);
-            if (screenIfaceResult == EOK) {
-                if (pScrWinCtxt->scrWinRotation != 0 ) {
-                    screenIfaceResult = screen_set_window_property_iv(pScrWinCtxt->scrWin, SCREEN_PROPERTY_ROTATION, &(pScrWinCtxt->scrWinRotation));
-                    if (screenIfaceResult == EOK) {
-                        createWindowResult = 0; //EOK
-                    } else {
-                        log_message(LOG_ERROR, "createWindow::screen_get_window_property_iv(SCREEN_PROPERTY_ROTATION) returned non-zero: %d ", screenIfaceResult);
-                        createWindowResult = -6;
-                    }
-                } else {
-                    createWindowResult = 0; //EOK
-                }
-            } else {
-                log_message(LOG_ERROR, "createWindow::screen_get_window_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) returned non-zero: %d ", screenIfaceResult);
-                createWindowResult = -5;
-            }
-          } else {
-              log_message(LOG_ERROR, "createWindow::screen_get_window_property_iv(SCREEN_PROPERTY_SIZE) returned non-zero: %d ", screenIfaceResult);
-              createWindowResult = -4;
-          }
-        } else {
-          log_message(LOG_ERROR, "createWindow::screen_set_window_property_iv(SCREEN_PROPERTY_FORMAT) returned non-zero: %d ", screenIfaceResult);
-          createWindowResult = -3;
-        }
-      } else {
-        log_message(LOG_ERROR, "createWindow::screen_set_window_property_iv(SCREEN_PROPERTY_USAGE) returned non-zero: %d ", screenIfaceResult);
-        createWindowResult = -2;
+  while (x < width) {
+    if (used >= words) {
+      return 0;
+    }
+    count = pData[used] & ~BGR_IMG_RLE_RUN;
+    if ((count == 0) || (count > (uint32_t)(width - x))) {
+      return 0;
+    }
+    if (pData[used] & BGR_IMG_RLE_RUN) {
+      if (used + 2 > words) {
+        return 0;
       }
+      for (i = 0; i < count; i++) {
+        pRow[x + i] = pData[used + 1];
+      }
+      used += 2;
     } else {
-        log_message(LOG_ERROR, "createWindow::screen_create_window() returned non-zero: %d ", screenIfaceResult);
-        createWindowResult = -1;
+      if (used + 1 + count > words) {
+        return 0;
+      }
+      memcpy(&pRow[x], &pData[used + 1], count * sizeof(uint32_t));
+      used += 1 + count;
     }
+    x += count;
+  }
 
-	return createWindowResult;
+  return used;
 }
 
-int createWindowBuffers(screen_window_t *pScreen_win, void **screen_buf) {
-  int createWindowBuffersResult = -1;
-  int screenIfaceResult;
+// Copies a pre-converted image (see BgrImage.h) into the image pixmap buffer. No codec is involved: a RAW image
+// whose stride and format match the buffer is read with a single read(), anything else is copied, converted or
+// expanded from an mmap().
+static int ilLoadBgrImage(bgrImgPixmapData *pImgPxmpData) {
+  bgr_imgHeader header;
+  gfxBufferInfo bufInfo;
+  struct stat fileStat;
+  const uint8_t *pMap = MAP_FAILED;
+  const uint32_t *pData;
+  uint32_t *rleRow = NULL;
+  uint8_t *pRow;
+  size_t remaining, used;
+  ssize_t got;
+  int loadResult = 0;
+  int fd;
+  int y;
+
+  fd = open(pImgPxmpData->imgFileName, O_RDONLY);
+  if (fd < 0) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap::open(%s) failed: %s", pImgPxmpData->imgFileName, strerror(errno));
+    return -1;
+  }
+  if ((fstat(fd, &fileStat) != 0) || (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) ||
+      (header.magic != BGR_IMG_MAGIC) || (header.version != BGR_IMG_VERSION) || (header.format != BGR_IMG_FORMAT_RGBX) ||
+      (header.width == 0) || (header.height == 0) || (header.width > BGR_IMG_MAX_DIM) || (header.height > BGR_IMG_MAX_DIM) ||
+      ((uint64_t)header.stride != (uint64_t)header.width * 4) || (header.dataOffset < sizeof(header)) ||
+      ((header.dataOffset % sizeof(uint32_t)) != 0) ||   /* Pixels and RLE control words are read as uint32_t */
+      ((uint64_t)header.dataOffset + header.dataSize > (uint64_t)fileStat.st_size) ||
+      ((header.encoding == eBgrImg_RAW) && ((uint64_t)header.dataSize != (uint64_t)header.stride * header.height)) ||
+      ((header.encoding != eBgrImg_RAW) && (header.encoding != eBgrImg_RLE))) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap: %s is not a valid .bgri image", pImgPxmpData->imgFileName);
+    close(fd);
+    return -2;
+  }
 
-  screenIfaceResult = screen_create_window_buffers(*pScreen_win, 1);
-  if (screenIfaceResult == EOK) {
-    screenIfaceResult = screen_get_window_property_pv(*pScreen_win, SCREEN_PROPERTY_RENDER_BUFFERS, screen_buf);
-    if (screenIfaceResult == EOK) {
-      createWindowBuffersResult = 0; //EOK
+  if (gfx->createPixmapBuffer(pImgPxmpData->imgPixmap, header.width, header.height, pImgPxmpData->imgPixmapFormat, &(pImgPxmpData->imgPixmapBuffer)) != EOK) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap::createPixmapBuffer(%ux%u) failed", header.width, header.height);
+    close(fd);
+    return -3;
+  }
+  pImgPxmpData->imgPixmapBufferState = eHandleValid;
+  if (gfx->getBufferInfo(pImgPxmpData->imgPixmapBuffer, &bufInfo) != EOK) {
+    loadResult = -4;
+  } else if ((header.encoding == eBgrImg_RAW) && ((uint32_t)bufInfo.stride == header.stride) && (bufInfo.format == ePixFmt_XRGB8888)) {
+    remaining = header.dataSize;
+    while ((remaining > 0) && (loadResult == 0)) {
+      got = pread(fd, (uint8_t *)bufInfo.pData + (header.dataSize - remaining), remaining, header.dataOffset + (header.dataSize - remaining));
+      if (got <= 0) {
+        log_message(LOG_ERROR, "bgrLoadImagePixmap::pread(%s) failed: %s", pImgPxmpData->imgFileName, (got < 0) ? strerror(errno) : "end of file");
+        loadResult = -5;
+      } else {
+        remaining -= got;
+      }
+    }
+  } else {
+    pMap = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (bufInfo.format != ePixFmt_XRGB8888) {
+      rleRow = malloc((size_t)header.width * sizeof(uint32_t));   //RLE rows expand here before conversion
+    }
+    if (pMap == MAP_FAILED) {
+      log_message(LOG_ERROR, "bgrLoadImagePixmap::mmap(%s) failed: %s", pImgPxmpData->imgFileName, strerror(errno));
+      loadResult = -6;
+    } else if ((bufInfo.format != ePixFmt_XRGB8888) && (rleRow == NULL)) {
+      loadResult = -8;
     } else {
-      log_message(LOG_ERROR, "createWindowBuffers::screen_get_window_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) returned non-zero: %d ", screenIfaceResult);
-      createWindowBuffersResult = -2;
+      pData = (const uint32_t *)(pMap + header.dataOffset);
+      remaining = header.dataSize / sizeof(uint32_t);
+      for (y = 0; (y < (int)header.height) && (loadResult == 0); y++) {
+        pRow = (uint8_t *)bufInfo.pData + (size_t)y * bufInfo.stride;
+        if (header.encoding == eBgrImg_RAW) {
+          pfConvertRow(pRow, bufInfo.format, (const uint8_t *)pData + (size_t)y * header.stride, ePixFmt_XRGB8888, header.width, NULL);
+        } else {
+          used = ilDecodeRleRow(pData, remaining, (rleRow != NULL) ? rleRow : (uint32_t *)pRow, header.width);
+          if (used == 0) {
+            log_message(LOG_ERROR, "bgrLoadImagePixmap: %s has a corrupt row %d", pImgPxmpData->imgFileName, y);
+            loadResult = -7;
+          } else if (rleRow != NULL) {
+            pfConvertRow(pRow, bufInfo.format, rleRow, ePixFmt_XRGB8888, header.width, NULL);
+          }
+          pData += used;
+          remaining -= used;
+        }
+      }
+    }
+    if (pMap != MAP_FAILED) {
+      munmap((void *)pMap, fileStat.st_size);
     }
+    free(rleRow);
+  }
+  close(fd);
+
+  if (loadResult != 0) {
+    gfx->destroyPixmapBuffer(pImgPxmpData->imgPixmap);
+    pImgPxmpData->imgPixmapBufferState = eHandleUninit;
   } else {
-    log_message(LOG_ERROR, "createWindowBuffers::screen_create_window_buffers(1) returned non-zero: %d ", screenIfaceResult);
-    createWindowBuffersResult = -1;
+    log_message(LOG_DEBUG, "imgdata: h:%u, w:%u (%s)", header.height, header.width, (header.encoding == eBgrImg_RLE) ? "bgri RLE" : "bgri RAW");
+    pImgPxmpData->imgWidth = header.width;
+    pImgPxmpData->imgHeight = header.height;
   }
 
-  return createWindowBuffersResult;
+  return loadResult;
 }
 
-int displayWindowBuffer(screen_window_t *pScreen_win, screen_buffer_t screen_bufer, int *dirty_rect) {
-  int displayWindowBufferResult = -1;
-  int screenIfaceResult;
+// Returns 1 for pre-converted images, which skip the codecs.
+static int ilIsBgrImage(const char *fileName) {
+  const char *ext = strrchr(fileName, '.');
 
-  screenIfaceResult = screen_set_window_property_iv(*pScreen_win, SCREEN_PROPERTY_VISIBLE, (int[]){1});
-  if (screenIfaceResult == EOK) {
-    log_message(LOG_DEBUG, "screen_set_window_property_iv(SCREEN_PROPERTY_VISIBLE, 1) completed");
-    screenIfaceResult = screen_post_window(*pScreen_win, screen_bufer, 0, dirty_rect, 0);
-    //screenIfaceResult = screen_post_window(*pScreen_win, screen_bufer, 0, NULL, 0);
-    if (screenIfaceResult == EOK) {
-      log_message(LOG_DEBUG, "displayWindowBuffer::screen_post_window() completed.");
-      displayWindowBufferResult = 0;
-    } else {
-      log_message(LOG_ERROR, "displayWindowBuffer::screen_post_window() returned non-zero: %d", screenIfaceResult);
+  return (ext != NULL) && (strcasecmp(ext, ".bgri") == 0);
+}
+
+// Returns 1 if the image file is the one decoded last time (same inode, size and mtime).
+// The mtime is compared to the nanosecond, so a same-size rewrite within one second is still seen.
+static int ilImageFileUnchanged(bgrImgPixmapData *pImgPxmpData, struct stat *pFileStat) {
+  return (pImgPxmpData->imgPixmapBufferState == eHandleValid) &&
+         (pFileStat->st_ino == pImgPxmpData->imgFileStat.st_ino) &&
+         (pFileStat->st_dev == pImgPxmpData->imgFileStat.st_dev) &&
+         (pFileStat->st_size == pImgPxmpData->imgFileStat.st_size) &&
+         (pFileStat->st_mtim.tv_sec == pImgPxmpData->imgFileStat.st_mtim.tv_sec) &&
+         (pFileStat->st_mtim.tv_nsec == pImgPxmpData->imgFileStat.st_mtim.tv_nsec);
+}
+
+// Applies imgRotationAngle to the decoded pixmap: 180 in place, 90/270 into a new transposed buffer.
+static int ilRotateImagePixmap(bgrImgPixmapData *pImgPxmpData) {
+  gfxBufferInfo bufInfo;
+  uint8_t *pCopy;
+  int copyStride;
+  int srcWidth = pImgPxmpData->imgWidth;
+  int srcHeight = pImgPxmpData->imgHeight;
+  int y;
+
+  if (gfx->getBufferInfo(pImgPxmpData->imgPixmapBuffer, &bufInfo) != EOK) {
+    log_message(LOG_ERROR, "ilRotateImagePixmap::getBufferInfo() failed");
+    return -1;
+  }
+  if (pImgPxmpData->imgRotationAngle == 180) {
+    pkRotate180Rgbx(bufInfo.pData, srcWidth, srcHeight, bufInfo.stride);
+    return 0;
+  }
+
+  //The pixmap buffer cannot change shape: copy the image out, then rotate it into an h x w buffer
+  copyStride = srcWidth * 4;
+  pCopy = malloc((size_t)copyStride * srcHeight);
+  if (pCopy == NULL) {
+    log_message(LOG_ERROR, "ilRotateImagePixmap: no memory for a %dx%d copy", srcWidth, srcHeight);
+    return -2;
+  }
+  for (y = 0; y < srcHeight; y++) {
+    memcpy(pCopy + (size_t)y * copyStride, (uint8_t *)bufInfo.pData + (size_t)y * bufInfo.stride, copyStride);
+  }
+  gfx->destroyPixmapBuffer(pImgPxmpData->imgPixmap);
+  pImgPxmpData->imgPixmapBufferState = eHandleUninit;
+  if ((gfx->createPixmapBuffer(pImgPxmpData->imgPixmap, srcHeight, srcWidth, pImgPxmpData->imgPixmapFormat, &(pImgPxmpData->imgPixmapBuffer)) != EOK) ||
+      (gfx->getBufferInfo(pImgPxmpData->imgPixmapBuffer, &bufInfo) != EOK)) {
+    log_message(LOG_ERROR, "ilRotateImagePixmap::createPixmapBuffer(%dx%d) failed", srcHeight, srcWidth);
+    free(pCopy);
+    return -3;
+  }
+  pImgPxmpData->imgPixmapBufferState = eHandleValid;
+  if (pImgPxmpData->imgRotationAngle == 90) {
+    pkRotate90Rgbx(pCopy, srcWidth, srcHeight, copyStride, bufInfo.pData, bufInfo.stride);
+  } else {
+    pkRotate270Rgbx(pCopy, srcWidth, srcHeight, copyStride, bufInfo.pData, bufInfo.stride);
+  }
+  free(pCopy);
+  pImgPxmpData->imgWidth = srcHeight;
+  pImgPxmpData->imgHeight = srcWidth;
+
+  return 0;
+}
+
+// This version targets render loops support.
+// The decoded image stays resident in the pixmap; the file is decoded again only when it changed.
+// img_lib is attached on first use and stays attached until bgrCleanupImgPxmpContexts().
+int bgrLoadImagePixmap(bgrImgPixmapData *pImgPxmpData)
+{
+  struct stat fileStat;
+  int rc;
+
+  if (stat(pImgPxmpData->imgFileName, &fileStat) != 0) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap::stat(%s) failed: %s", pImgPxmpData->imgFileName, strerror(errno));
+    return -1;
+  }
+  if (ilImageFileUnchanged(pImgPxmpData, &fileStat)) {
+    log_message(LOG_DEBUG, "bgrLoadImagePixmap: %s unchanged, decode skipped", pImgPxmpData->imgFileName);
+    return 0;
+  }
+
+  if (pImgPxmpData->imgPixmapBufferState == eHandleValid) {
+    gfx->destroyPixmapBuffer(pImgPxmpData->imgPixmap);
+    pImgPxmpData->imgPixmapBufferState = eHandleUninit;
+  }
+
+  if (ilIsBgrImage(pImgPxmpData->imgFileName)) {
+    rc = ilLoadBgrImage(pImgPxmpData);
+  } else {
+    rc = ilDecodeImage(pImgPxmpData);
+  }
+  if ((rc == 0) && (pImgPxmpData->imgRotationAngle != 0)) {
+    rc = ilRotateImagePixmap(pImgPxmpData);
+    if (rc == 0) {
+      log_message(LOG_DEBUG, "bgrLoadImagePixmap: image rotated by %d", pImgPxmpData->imgRotationAngle);
     }
+  }
+  if (rc == 0) {
+    pImgPxmpData->imgFileStat = fileStat;
+    pImgPxmpData->imgDecoded = 1;
+    pImgPxmpData->imgScaledRect[2] = 0;
+  }
+
+  return rc;
+}
+
+
+int bgrCreateWindow(bgrScrWinContexts *pScrWinCtxt) {
+  int createWindowResult;
+
+  pScrWinCtxt->scrWinSwRotation = pScrWinCtxt->scrWinRotation;
+  createWindowResult = gfx->createWindow(pScrWinCtxt->scrCtx, pScrWinCtxt->scrWinFormat, &(pScrWinCtxt->scrWinSwRotation), &(pScrWinCtxt->scrWin),
+                                         pScrWinCtxt->scrWinSize, pScrWinCtxt->scrWinBufferSize);
+  if (createWindowResult != EOK) {
+    log_message(LOG_ERROR, "createWindow::%s createWindow() returned non-zero: %d ", gfx->name, createWindowResult);
+  } else if (pScrWinCtxt->scrWinSwRotation != 0) {
+    log_message(LOG_WARNING, "createWindow: %s does not rotate the window, the image is rotated by %d in software, the text is not",
+                gfx->name, pScrWinCtxt->scrWinSwRotation);
+  }
+
+	return createWindowResult;
+}
+
+// Creates bufferCount (1..BGR_MAX_WIN_BUFFERS) window buffers. With more than one, posting is paced to the
+// display refresh and pBuffers[0] is the first buffer to render into.
+int createWindowBuffers(gfxWindow win, int bufferCount, gfxBuffer *pBuffers) {
+  int createWindowBuffersResult;
+
+  createWindowBuffersResult = gfx->createWindowBuffers(win, bufferCount, pBuffers);
+  if (createWindowBuffersResult != EOK) {
+    log_message(LOG_ERROR, "createWindowBuffers::%s createWindowBuffers(%d) returned non-zero: %d ", gfx->name, bufferCount, createWindowBuffersResult);
+  }
+
+  return createWindowBuffersResult;
+}
+
+int displayWindowBuffer(gfxWindow win, gfxBuffer buffer, int *dirty_rect) {
+  int displayWindowBufferResult;
+  uint64_t traceStart = trcBegin();
+
+  displayWindowBufferResult = gfx->postWindow(win, buffer, dirty_rect);
+  trcEnd("displayWindowBuffer", traceStart);
+  if (displayWindowBufferResult == EOK) {
+    log_message(LOG_DEBUG, "displayWindowBuffer::postWindow() completed.");
   } else {
-    log_message(LOG_ERROR, "displayWindowBuffer::screen_set_window_property_iv(SCREEN_PROPERTY_VISIBLE) returned non-zero: %d", screenIfaceResult);
+    log_message(LOG_ERROR, "displayWindowBuffer::%s postWindow() returned non-zero: %d", gfx->name, displayWindowBufferResult);
   }
 
   return displayWindowBufferResult;
 }
 
-int bgrCreatePixmap(screen_context_t *pScreen_ctx, screen_pixmap_t *pScreen_pix) {
-    const int pixmapUsage = SCREEN_USAGE_WRITE | SCREEN_USAGE_READ | SCREEN_USAGE_NATIVE ;
-	int createPixmapResult = -1;
-	int screenIfaceResult;
-	//screen_context_t screen_ctx = *pScreen_ctx;
-	//screen_pixmap_t screen_pix = *pScreen_pix;
+// Grows rect (x, y, w, h) to also cover addRect. An empty rect (w or h <= 0) is ignored on either side.
+void bgrUnionRect(int *rect, const int *addRect) {
+  int x2, y2;
 
-    screenIfaceResult = screen_create_pixmap(pScreen_pix, *pScreen_ctx);
-    if (screenIfaceResult == EOK) {
-    	screenIfaceResult = screen_set_pixmap_property_iv(*pScreen_pix, SCREEN_PROPERTY_USAGE, &pixmapUsage);
-        if (screenIfaceResult == EOK) {
-     	   screenIfaceResult = screen_set_pixmap_property_iv(*pScreen_pix, SCREEN_PROPERTY_FORMAT, (int[]){SCREEN_FORMAT_RGBX8888});
-           if (screenIfaceResult == EOK) {
-        	   createPixmapResult = 0; //EOK
-           } else {
-               log_message(LOG_ERROR, "bgrCreatePixmap::screen_set_pixmap_property_iv(SCREEN_PROPERTY_FORMAT) returned non-zero: %d ", screenIfaceResult);
-               createPixmapResult = -3;
-           }
+  if ((addRect[2] <= 0) || (addRect[3] <= 0)) {
+    return;
+  }
+  if ((rect[2] <= 0) || (rect[3] <= 0)) {
+    memcpy(rect, addRect, 4 * sizeof(int));
+    return;
+  }
+  x2 = (rect[0] + rect[2] > addRect[0] + addRect[2]) ? rect[0] + rect[2] : addRect[0] + addRect[2];
+  y2 = (rect[1] + rect[3] > addRect[1] + addRect[3]) ? rect[1] + rect[3] : addRect[1] + addRect[3];
+  rect[0] = (rect[0] < addRect[0]) ? rect[0] : addRect[0];
+  rect[1] = (rect[1] < addRect[1]) ? rect[1] : addRect[1];
+  rect[2] = x2 - rect[0];
+  rect[3] = y2 - rect[1];
+}
+
+// Adds a changed window area to the damage of the next post, clipped to the window buffer.
+void bgrAddDamage(bgrScrWinContexts *pScrWinCtxt, const int *rect) {
+  bgrDamageList *pDamage = &(pScrWinCtxt->scrWinFrameDamage);
+  int clipped[4];
+
+  clipped[0] = (rect[0] > 0) ? rect[0] : 0;
+  clipped[1] = (rect[1] > 0) ? rect[1] : 0;
+  clipped[2] = ((rect[0] + rect[2] < pScrWinCtxt->scrWinBufferSize[0]) ? rect[0] + rect[2] : pScrWinCtxt->scrWinBufferSize[0]) - clipped[0];
+  clipped[3] = ((rect[1] + rect[3] < pScrWinCtxt->scrWinBufferSize[1]) ? rect[1] + rect[3] : pScrWinCtxt->scrWinBufferSize[1]) - clipped[1];
+  if ((clipped[2] <= 0) || (clipped[3] <= 0)) {
+    return;
+  }
+
+  if (pDamage->count < BGR_MAX_DAMAGE_RECTS) {
+    memcpy(pDamage->rects[pDamage->count], clipped, sizeof(clipped));
+    pDamage->count++;
+  } else {
+    bgrUnionRect(pDamage->rects[BGR_MAX_DAMAGE_RECTS - 1], clipped);
+  }
+}
+
+// Union of the damage added since the last post. w and h are 0 if nothing changed.
+static void bgrGetFrameDamage(bgrScrWinContexts *pScrWinCtxt, int *unionRect) {
+  int i;
+
+  memset(unionRect, 0, 4 * sizeof(int));
+  for (i = 0; i < pScrWinCtxt->scrWinFrameDamage.count; i++) {
+    bgrUnionRect(unionRect, pScrWinCtxt->scrWinFrameDamage.rects[i]);
+  }
+}
+
+// The area of the current render buffer that has to be redrawn from the image: the damage added so far
+// plus whatever changed while this buffer was not the one being rendered.
+void bgrGetRepaintRect(bgrScrWinContexts *pScrWinCtxt, int *repaintRect) {
+  bgrGetFrameDamage(pScrWinCtxt, repaintRect);
+  bgrUnionRect(repaintRect, pScrWinCtxt->scrWinBufferDamage[pScrWinCtxt->scrWinBufferIdx]);
+}
+
+// Posts the current render buffer with the union of the frame damage as dirty rectangle, then moves on to
+// the next render buffer. The other buffers inherit the damage, as they still hold the previous content there.
+// Nothing is posted if nothing changed.
+int bgrPresentWindow(bgrScrWinContexts *pScrWinCtxt) {
+  gfxBuffer renderBuffer;
+  int presentResult = -1;
+  int screenIfaceResult;
+  int i;
+
+  bgrGetFrameDamage(pScrWinCtxt, pScrWinCtxt->scrWinDirtyRect);
+  pScrWinCtxt->scrWinFrameDamage.count = 0;
+  if ((pScrWinCtxt->scrWinDirtyRect[2] <= 0) || (pScrWinCtxt->scrWinDirtyRect[3] <= 0)) {
+    log_message(LOG_DEBUG, "bgrPresentWindow: no damage, post skipped");
+    return 0;
+  }
+  log_message(LOG_DEBUG, "bgrPresentWindow: dirty rect x:%d, y:%d, w:%d, h:%d", pScrWinCtxt->scrWinDirtyRect[0], pScrWinCtxt->scrWinDirtyRect[1], pScrWinCtxt->scrWinDirtyRect[2], pScrWinCtxt->scrWinDirtyRect[3]);
+
+  screenIfaceResult = displayWindowBuffer(pScrWinCtxt->scrWin, pScrWinCtxt->scrWinBuffer, pScrWinCtxt->scrWinDirtyRect);
+  if (screenIfaceResult == EOK) {
+    for (i = 0; i < pScrWinCtxt->scrWinBufferCount; i++) {
+      if (i == pScrWinCtxt->scrWinBufferIdx) {
+        memset(pScrWinCtxt->scrWinBufferDamage[i], 0, 4 * sizeof(int));
+      } else {
+        bgrUnionRect(pScrWinCtxt->scrWinBufferDamage[i], pScrWinCtxt->scrWinDirtyRect);
+      }
+    }
+
+    if (pScrWinCtxt->scrWinBufferCount > 1) {
+      screenIfaceResult = gfx->getRenderBuffer(pScrWinCtxt->scrWin, &renderBuffer);
+      if (screenIfaceResult == EOK) {
+        for (i = 0; i < pScrWinCtxt->scrWinBufferCount; i++) {
+          if (pScrWinCtxt->scrWinBuffers[i] == renderBuffer) {
+            pScrWinCtxt->scrWinBufferIdx = i;
+            pScrWinCtxt->scrWinBuffer = renderBuffer;
+            break;
+          }
+        }
+        if (i == pScrWinCtxt->scrWinBufferCount) {
+          log_message(LOG_ERROR, "bgrPresentWindow: next render buffer is not one of the window buffers");
+          presentResult = -3;
         } else {
-            log_message(LOG_ERROR, "bgrCreatePixmap::screen_set_pixmap_property_iv(SCREEN_PROPERTY_USAGE) returned non-zero: %d ", screenIfaceResult);
-            createPixmapResult = -2;
+          log_message(LOG_DEBUG, "bgrPresentWindow: rendering into buffer %d next", pScrWinCtxt->scrWinBufferIdx);
+          presentResult = 0; //EOK
         }
+      } else {
+        log_message(LOG_ERROR, "bgrPresentWindow::getRenderBuffer() returned non-zero: %d ", screenIfaceResult);
+        presentResult = -2;
+      }
     } else {
-        log_message(LOG_ERROR, "bgrCreatePixmap::screen_create_pixmap() returned non-zero: %d ", screenIfaceResult);
-        createPixmapResult = -1;
+      presentResult = 0; //EOK
+    }
+  } else {
+    log_message(LOG_ERROR, "bgrPresentWindow::displayWindowBuffer() returned non-zero: %d ", screenIfaceResult);
+    presentResult = -1;
+  }
+
+  return presentResult;
+}
+
+int bgrCreatePixmap(gfxContext ctx, gfxPixmap *pPix) {
+	int createPixmapResult;
+
+    createPixmapResult = gfx->createPixmap(ctx, pPix);
+    if (createPixmapResult != EOK) {
+        log_message(LOG_ERROR, "bgrCreatePixmap::%s createPixmap() returned non-zero: %d ", gfx->name, createPixmapResult);
     }
 
 	return createPixmapResult;
 }
 
 
-int bgrResetTxtPixmapBuffer(bgrTxtPixmapData *pTxtPixmapData, int *pixmap_size, fr_grBufferProps *pBuffProps) {
+// Returns the text pixmap buffer ready for rendering a text box of up to width x height at (0, 0).
+// The buffer is created on first use and only re-created if a taller box is needed. Otherwise just the
+// pixels the previous text wrote (ftCanvasProps.txtDirtyRect) are cleared back to black.
+int bgrPrepareTxtPixmap(bgrTxtPixmapData *pTxtPixmapData, int width, int height, fr_grBufferProps *pBuffProps) {
+  fr_textBox *pDirty = &(pTxtPixmapData->ftCanvasProps.txtDirtyRect);
+  gfxBufferInfo bufInfo;
   int createResult = -1;
-  int screenIfaceResult;
-
-  if (pTxtPixmapData->txtPixmapBufferState == eHandleUninit)
-  {
-    screenIfaceResult = screen_set_pixmap_property_iv(pTxtPixmapData->txtPixmap, SCREEN_PROPERTY_BUFFER_SIZE, pixmap_size);
-    if (screenIfaceResult != EOK) {
-      log_message(LOG_ERROR, "bgrResetTxtPixmapBuffer::screen_set_pixmap_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) returned non-zero: %d ", screenIfaceResult);
-      createResult = -1;
+  int screenIfaceResult = EOK;
+  _uint8 *pRow;
+  int y;
+
+  if ((pTxtPixmapData->txtPixmapBufferState == eHandleValid) &&
+      (width <= pTxtPixmapData->txtPixmapSize[0]) && (height <= pTxtPixmapData->txtPixmapSize[1])) {
+    pRow = (_uint8 *)pTxtPixmapData->pTxtPixmapBuffer + pDirty->bb_start_y * pTxtPixmapData->txtPixmapBufferStride + pDirty->bb_start_x * 4;
+    for (y = 0; y < pDirty->bb_height; y++) {
+      pkFillRgbx((uint32_t *)pRow, pDirty->bb_width, 0xff000000u);
+      pRow += pTxtPixmapData->txtPixmapBufferStride;
     }
+    memset(pDirty, 0, sizeof(fr_textBox));
+    createResult = 0; //EOK
   } else {
-    screenIfaceResult = screen_destroy_pixmap_buffer (pTxtPixmapData->txtPixmap);
-    pTxtPixmapData->txtPixmapBufferState = eHandleUninit;
-  }
+    if (pTxtPixmapData->txtPixmapBufferState == eHandleValid) {
+      gfx->destroyPixmapBuffer(pTxtPixmapData->txtPixmap);
+      pTxtPixmapData->txtPixmapBufferState = eHandleUninit;
+      if (height < pTxtPixmapData->txtPixmapSize[1]) {
+        height = pTxtPixmapData->txtPixmapSize[1];
+      }
+      log_message(LOG_INFO, "bgrPrepareTxtPixmap: text pixmap grows to %dx%d", width, height);
+    }
+    pTxtPixmapData->txtPixmapSize[0] = width;
+    pTxtPixmapData->txtPixmapSize[1] = height;
 
-  if (screenIfaceResult == EOK) {
-    screenIfaceResult = screen_create_pixmap_buffer(pTxtPixmapData->txtPixmap);
+    screenIfaceResult = gfx->createPixmapBuffer(pTxtPixmapData->txtPixmap, width, height, ePixFmt_XRGB8888, &(pTxtPixmapData->txtPixmapBuffer));
     if (screenIfaceResult == EOK) {
       pTxtPixmapData->txtPixmapBufferState = eHandleValid;
-      screenIfaceResult = screen_get_pixmap_property_pv(pTxtPixmapData->txtPixmap, SCREEN_PROPERTY_RENDER_BUFFERS, (void **)&(pTxtPixmapData->txtPixmapBuffer));
+      screenIfaceResult = gfx->getBufferInfo(pTxtPixmapData->txtPixmapBuffer, &bufInfo);
       if (screenIfaceResult == EOK) {
-        screenIfaceResult = screen_get_buffer_property_pv(pTxtPixmapData->txtPixmapBuffer, SCREEN_PROPERTY_POINTER, &(pTxtPixmapData->pTxtPixmapBuffer));
-        if (screenIfaceResult == EOK) {
-          screenIfaceResult = screen_get_buffer_property_iv(pTxtPixmapData->txtPixmapBuffer, SCREEN_PROPERTY_STRIDE, &(pTxtPixmapData->txtPixmapBufferStride));
-          if (screenIfaceResult == EOK) {
-            pBuffProps->fr_pix_buf_data = pTxtPixmapData->pTxtPixmapBuffer;
-            pBuffProps->fr_buf_size_x = pixmap_size[0];
-            pBuffProps->fr_buf_size_y = pixmap_size[1];
-            pBuffProps->fr_bpp = 4; //@fix: Should be in bgrTxtPixmapData or Screen/WindowData
-            createResult = 0; //EOK
-          } else {
-            log_message(LOG_ERROR, "bgrResetTxtPixmapBuffer::screen_get_buffer_property_iv(SCREEN_PROPERTY_STRIDE) returned non-zero: %d ", screenIfaceResult);
-            createResult = -5;
-          }
-        } else {
-          log_message(LOG_ERROR, "bgrResetTxtPixmapBuffer::screen_get_buffer_property_pv(SCREEN_PROPERTY_POINTER) returned non-zero: %d ", screenIfaceResult);
-          createResult = -4;
+        pTxtPixmapData->pTxtPixmapBuffer = bufInfo.pData;
+        pTxtPixmapData->txtPixmapBufferStride = bufInfo.stride;
+        // A new buffer is not guaranteed to be cleared
+        pRow = (_uint8 *)pTxtPixmapData->pTxtPixmapBuffer;
+        for (y = 0; y < pTxtPixmapData->txtPixmapSize[1]; y++) {
+          pkFillRgbx((uint32_t *)pRow, pTxtPixmapData->txtPixmapSize[0], 0xff000000u);
+          pRow += pTxtPixmapData->txtPixmapBufferStride;
         }
+        memset(pDirty, 0, sizeof(fr_textBox));
+        log_message(LOG_DEBUG, "bgrPrepareTxtPixmap: text pixmap %dx%d created", pTxtPixmapData->txtPixmapSize[0], pTxtPixmapData->txtPixmapSize[1]);
+        createResult = 0; //EOK
       } else {
-        log_message(LOG_ERROR, "bgrResetTxtPixmapBuffer::screen_get_window_property_iv(SCREEN_PROPERTY_BUFFER_SIZE) returned non-zero: %d ", screenIfaceResult);
-        createResult = -3;
+        log_message(LOG_ERROR, "bgrPrepareTxtPixmap::getBufferInfo() returned non-zero: %d ", screenIfaceResult);
+        createResult = -2;
       }
     } else {
-      log_message(LOG_ERROR, "bgrResetTxtPixmapBuffer::screen_create_window_buffers(1) returned non-zero: %d ", screenIfaceResult);
-      createResult = -2;
+      log_message(LOG_ERROR, "bgrPrepareTxtPixmap::createPixmapBuffer(%dx%d) returned non-zero: %d ", width, height, screenIfaceResult);
+      createResult = -1;
     }
   }
 
+  if (createResult == 0) {
+    pBuffProps->fr_pix_buf_data = pTxtPixmapData->pTxtPixmapBuffer;
+    pBuffProps->fr_buf_size_x = pTxtPixmapData->txtPixmapSize[0];
+    pBuffProps->fr_buf_size_y = pTxtPixmapData->txtPixmapSize[1];
+    pBuffProps->fr_bpp = 4; //@fix: Should be in bgrTxtPixmapData or Screen/WindowData
+    pBuffProps->fr_stride = pTxtPixmapData->txtPixmapBufferStride;
+  }
 
   return createResult;
 }
 
 
+// Exposes the window render buffer for direct CPU rendering. Pending blits into it are flushed first.
+int bgrGetWindowBufferProps(bgrScrWinContexts *pScrWinCtxt, fr_grBufferProps *pBuffProps) {
+  gfxBufferInfo bufInfo;
+  int getPropsResult = -1;
+  int screenIfaceResult;
+
+  screenIfaceResult = gfx->finish(pScrWinCtxt->scrCtx);
+  if (screenIfaceResult == EOK) {
+    screenIfaceResult = gfx->getBufferInfo(pScrWinCtxt->scrWinBuffer, &bufInfo);
+    if (screenIfaceResult == EOK) {
+      pScrWinCtxt->pScrWinBuffer = bufInfo.pData;
+      pScrWinCtxt->scrWinBufferStride = bufInfo.stride;
+      pBuffProps->fr_pix_buf_data = pScrWinCtxt->pScrWinBuffer;
+      pBuffProps->fr_buf_size_x = pScrWinCtxt->scrWinBufferSize[0];
+      pBuffProps->fr_buf_size_y = pScrWinCtxt->scrWinBufferSize[1];
+      pBuffProps->fr_bpp = pfBitsPerPixel(bufInfo.format) / 8; //Text is only rendered into RGBX8888 windows, see main()
+      pBuffProps->fr_stride = pScrWinCtxt->scrWinBufferStride;
+      getPropsResult = 0; //EOK
+    } else {
+      log_message(LOG_ERROR, "bgrGetWindowBufferProps::getBufferInfo() returned non-zero: %d ", screenIfaceResult);
+      getPropsResult = -2;
+    }
+  } else {
+    log_message(LOG_ERROR, "bgrGetWindowBufferProps::finish() returned non-zero: %d ", screenIfaceResult);
+    getPropsResult = -1;
+  }
+
+  return getPropsResult;
+}
+
+
 void bgrGetEnvText(char *txtStr, int maxTxtSize) {
 char* envVarVal;
 const char envVarName[] = "BOOT_TEXT_STR";
@@ -777,24 +1711,30 @@ const char envVarErrorTxt[] = "Environment variable BOOT_TEXT_STR is not set!";
 }
 
 
-int bgrInitScreenWindow(bgrScrWinContexts *pScrWinCtxt) {
+int bgrInitScreenContext(bgrScrWinContexts *pScrWinCtxt) {
   int screenIfaceResult = -1;
 
   log_message(LOG_DEBUG, "Create Context ...");
-  screenIfaceResult = screen_create_context(&(pScrWinCtxt->scrCtx), pScrWinCtxt->scrFlags);
+  screenIfaceResult = gfx->createContext(&(pScrWinCtxt->scrCtx));
   if (screenIfaceResult != EOK) {
-    log_message(LOG_ERROR, "screen_create_context() returned non-zero: %d.", screenIfaceResult);
+    log_message(LOG_ERROR, "%s createContext() returned non-zero: %d.", gfx->name, screenIfaceResult);
     return -1;
-  } else {
-    log_message(LOG_DEBUG, "screen_create_context() completed.");
-    pScrWinCtxt->scrCtxState = eHandleValid;
+  }
+  log_message(LOG_DEBUG, "%s createContext() completed.", gfx->name);
+  pScrWinCtxt->scrCtxState = eHandleValid;
+
+  return 0;
+}
+
+// Window and window buffers, in the context made by bgrInitScreenContext(). The context is left to
+// bgrCleanupScrWinContexts(), as pixmaps may be created in it concurrently.
+int bgrInitScreenWindow(bgrScrWinContexts *pScrWinCtxt) {
+  int screenIfaceResult = -1;
 
     //@@fix: passing multiple parameters of same structure
     screenIfaceResult = bgrCreateWindow(pScrWinCtxt);
     if (screenIfaceResult != EOK) {
       log_message(LOG_ERROR, "createWindow() returned non-zero: %d", screenIfaceResult);
-      screen_destroy_context(pScrWinCtxt->scrCtx);
-      pScrWinCtxt->scrCtxState = eHandleUninit;
       return -1;
     } else {
       log_message(LOG_DEBUG, "createWindow() completed.");
@@ -805,64 +1745,286 @@ int bgrInitScreenWindow(bgrScrWinContexts *pScrWinCtxt) {
       pScrWinCtxt->scrWinDirtyRect[3] = pScrWinCtxt->scrWinBufferSize[1];
     }
     log_message(LOG_INFO, "Screen parameters: Screen size:%d,%d, Buffer size:%d,%d", pScrWinCtxt->scrWinSize[0], pScrWinCtxt->scrWinSize[1], pScrWinCtxt->scrWinBufferSize[0], pScrWinCtxt->scrWinBufferSize[1]);
-    screenIfaceResult = createWindowBuffers(&(pScrWinCtxt->scrWin), (void **)&(pScrWinCtxt->scrWinBuffer));
+    screenIfaceResult = createWindowBuffers(pScrWinCtxt->scrWin, pScrWinCtxt->scrWinBufferCount, pScrWinCtxt->scrWinBuffers);
     if (screenIfaceResult != EOK) {
-        log_message(LOG_ERROR, "createWindowBuffers (SCREEN_PROPERTY_SIZE) returned non-zero: %d", screenIfaceResult);
-        screen_destroy_window(pScrWinCtxt->scrWin);
+        log_message(LOG_ERROR, "createWindowBuffers() returned non-zero: %d", screenIfaceResult);
+        gfx->destroyWindow(pScrWinCtxt->scrWin);
         pScrWinCtxt->scrWinState = eHandleUninit;
-        screen_destroy_context(pScrWinCtxt->scrCtx);
-        pScrWinCtxt->scrCtxState = eHandleUninit;
         return -1;
     } else {
-        log_message(LOG_INFO, "createWindowBuffers() completed.");
+        log_message(LOG_INFO, "createWindowBuffers(%d) completed.", pScrWinCtxt->scrWinBufferCount);
+        pScrWinCtxt->scrWinBufferIdx = 0;
+        pScrWinCtxt->scrWinBuffer = pScrWinCtxt->scrWinBuffers[0];
+        memset(pScrWinCtxt->scrWinBufferDamage, 0, sizeof(pScrWinCtxt->scrWinBufferDamage));
     }
 
+  return screenIfaceResult;
+}
+
+
+// Fills a window buffer area with black, for the parts of a repaint not covered by the image.
+static int bgrFillWindowRect(bgrScrWinContexts *pScrWinCtxt, int x, int y, int width, int height) {
+  int screenIfaceResult = EOK;
+
+  if ((width > 0) && (height > 0)) {
+    screenIfaceResult = gfx->fill(pScrWinCtxt->scrCtx, pScrWinCtxt->scrWinBuffer, (int[]){x, y, width, height}, 0xff000000u);
+    if (screenIfaceResult != EOK) {
+      log_message(LOG_ERROR, "bgrFillWindowRect::fill() returned non-zero: %d", screenIfaceResult);
+    }
   }
 
   return screenIfaceResult;
 }
 
+// Size of an image fitted into boundSize with its aspect ratio kept: the size ZOOM displays it at.
+void bgrCalcFitSize(int imgWidth, int imgHeight, const int *boundSize, int *fitSize) {
+  float img_aspect = (float)imgWidth / imgHeight;
+  float display_aspect = (float)boundSize[0] / boundSize[1];
+
+  if (img_aspect > display_aspect) {  // Image is wider than display
+    fitSize[0] = boundSize[0];
+    fitSize[1] = boundSize[0] / img_aspect;
+  } else {  // Image is taller than display
+    fitSize[0] = boundSize[1] * img_aspect;
+    fitSize[1] = boundSize[1];
+  }
+}
+
+// Window area (x, y, w, h) an imgWidth x imgHeight image is displayed in with scaleMode (eScaleModes), centered
+// in boundSize. With NONE and FILL it may reach past the window; the blit crops it.
+void bgrCalcImageRect(int imgWidth, int imgHeight, const int *boundSize, int scaleMode, int *rect) {
+  switch (scaleMode) {
+    case eScale_NONE:
+      rect[2] = imgWidth;
+      rect[3] = imgHeight;
+      break;
+    case eScale_STRETCH:
+      rect[2] = boundSize[0];
+      rect[3] = boundSize[1];
+      break;
+    case eScale_FILL:
+      if ((long long)imgWidth * boundSize[1] > (long long)imgHeight * boundSize[0]) {  // Wider than the window: height fills it
+        rect[2] = (int)((long long)imgWidth * boundSize[1] / imgHeight);
+        rect[3] = boundSize[1];
+      } else {
+        rect[2] = boundSize[0];
+        rect[3] = (int)((long long)imgHeight * boundSize[0] / imgWidth);
+      }
+      break;
+    default:  // ZOOM, and SHIFT_UP/SHIFT_DOWN which move the ZOOM image by half a line
+      bgrCalcFitSize(imgWidth, imgHeight, boundSize, &rect[2]);
+      break;
+  }
+  rect[0] = (boundSize[0] - rect[2]) / 2;
+  rect[1] = (boundSize[1] - rect[3]) / 2;
+}
+
+// Scales the decoded image in software into imgScaledPixmapBuffer: the part of imageRect inside the window,
+// mirrored and shifted as the modes ask. Done once per decoded image; blits then copy from it 1:1.
+static int ilScaleImagePixmap(bgrImgPixmapData *pImgPxmpData, bgrScrWinContexts *pScrWinCtxt, const int *imageRect) {
+  const int scaleMode = ilEffectiveScaleMode();
+  psScaleParams scaleParams;
+  gfxBufferInfo srcInfo;
+  gfxBufferInfo dstInfo;
+  int visible[4];
+  int scaleResult;
+
+  visible[0] = (imageRect[0] > 0) ? imageRect[0] : 0;
+  visible[1] = (imageRect[1] > 0) ? imageRect[1] : 0;
+  visible[2] = ((imageRect[0] + imageRect[2] < pScrWinCtxt->scrWinBufferSize[0]) ? imageRect[0] + imageRect[2] : pScrWinCtxt->scrWinBufferSize[0]) - visible[0];
+  visible[3] = ((imageRect[1] + imageRect[3] < pScrWinCtxt->scrWinBufferSize[1]) ? imageRect[1] + imageRect[3] : pScrWinCtxt->scrWinBufferSize[1]) - visible[1];
+  if ((visible[2] <= 0) || (visible[3] <= 0)) {
+    log_message(LOG_ERROR, "ilScaleImagePixmap: image area %d,%d %dx%d is outside of the window", imageRect[0], imageRect[1], imageRect[2], imageRect[3]);
+    return -1;
+  }
+
+  if (pImgPxmpData->imgScaledPixmapState != eHandleValid) {
+    scaleResult = bgrCreatePixmap(pScrWinCtxt->scrCtx, &(pImgPxmpData->imgScaledPixmap));
+    if (scaleResult != EOK) {
+      log_message(LOG_ERROR, "ilScaleImagePixmap::bgrCreatePixmap() returned non-zero: %d", scaleResult);
+      return -2;
+    }
+    pImgPxmpData->imgScaledPixmapState = eHandleValid;
+  }
+  if ((pImgPxmpData->imgScaledPixmapBufferState == eHandleValid) &&
+      ((pImgPxmpData->imgScaledSize[0] != visible[2]) || (pImgPxmpData->imgScaledSize[1] != visible[3]))) {
+    gfx->destroyPixmapBuffer(pImgPxmpData->imgScaledPixmap);
+    pImgPxmpData->imgScaledPixmapBufferState = eHandleUninit;
+  }
+  if (pImgPxmpData->imgScaledPixmapBufferState != eHandleValid) {
+    scaleResult = gfx->createPixmapBuffer(pImgPxmpData->imgScaledPixmap, visible[2], visible[3], pScrWinCtxt->scrWinFormat, &(pImgPxmpData->imgScaledPixmapBuffer));
+    if (scaleResult != EOK) {
+      log_message(LOG_ERROR, "ilScaleImagePixmap::createPixmapBuffer(%dx%d) returned non-zero: %d", visible[2], visible[3], scaleResult);
+      return -3;
+    }
+    pImgPxmpData->imgScaledPixmapBufferState = eHandleValid;
+    pImgPxmpData->imgScaledSize[0] = visible[2];
+    pImgPxmpData->imgScaledSize[1] = visible[3];
+  }
+  if ((gfx->getBufferInfo(pImgPxmpData->imgPixmapBuffer, &srcInfo) != EOK) ||
+      (gfx->getBufferInfo(pImgPxmpData->imgScaledPixmapBuffer, &dstInfo) != EOK)) {
+    log_message(LOG_ERROR, "ilScaleImagePixmap::getBufferInfo() failed");
+    return -4;
+  }
+
+  memset(&scaleParams, 0, sizeof(scaleParams));
+  scaleParams.scaledWidth = imageRect[2];
+  scaleParams.scaledHeight = imageRect[3];
+  scaleParams.outX = visible[0] - imageRect[0];
+  scaleParams.outY = visible[1] - imageRect[1];
+  scaleParams.outWidth = visible[2];
+  scaleParams.outHeight = visible[3];
+  scaleParams.mirror = (mirror_mode != eMirror_DISABLED);
+  scaleParams.shiftY = (scaleMode == eScale_SHIFT_UP) ? 128 : ((scaleMode == eScale_SHIFT_DOWN) ? -128 : 0);
+  switch (scaler_mode) {
+    case eScaler_NEAREST:
+      scaleParams.filter = ePsFilter_NEAREST;
+      break;
+    case eScaler_BILINEAR:
+      scaleParams.filter = ePsFilter_BILINEAR;
+      break;
+    case eScaler_AREA:
+      scaleParams.filter = ePsFilter_AREA;
+      break;
+    default:
+      scaleParams.filter = psAutoFilter(pImgPxmpData->imgWidth, pImgPxmpData->imgHeight, imageRect[2], imageRect[3]);
+      break;
+  }
+  if ((scaleParams.shiftY != 0) && (scaleParams.filter == ePsFilter_AREA)) {
+    scaleParams.filter = ePsFilter_BILINEAR;   //Area boxes sit on whole source rows, a half line shift needs interpolation
+  }
+
+  if (dstInfo.format == ePixFmt_XRGB8888) {
+    scaleResult = psScaleRgbx(srcInfo.pData, pImgPxmpData->imgWidth, pImgPxmpData->imgHeight, srcInfo.stride,
+                              dstInfo.pData, dstInfo.stride, &scaleParams);
+  } else {
+    //The scaler works on XRGB8888 only: scale into a temporary buffer, then convert once into the window format
+    uint32_t *pScaled = malloc((size_t)visible[2] * visible[3] * sizeof(uint32_t));
+
+    if (pScaled == NULL) {
+      log_message(LOG_ERROR, "ilScaleImagePixmap: no memory for %dx%d scaled rows", visible[2], visible[3]);
+      return -5;
+    }
+    scaleResult = psScaleRgbx(srcInfo.pData, pImgPxmpData->imgWidth, pImgPxmpData->imgHeight, srcInfo.stride,
+                              pScaled, visible[2] * (int)sizeof(uint32_t), &scaleParams);
+    if (scaleResult == 0) {
+      scaleResult = pfConvertImage(dstInfo.pData, dstInfo.stride, dstInfo.format, pScaled, visible[2] * (int)sizeof(uint32_t),
+                                   ePixFmt_XRGB8888, visible[2], visible[3], NULL);
+    }
+    free(pScaled);
+  }
+  if (scaleResult != 0) {
+    log_message(LOG_ERROR, "ilScaleImagePixmap::psScaleRgbx() returned non-zero: %d", scaleResult);
+    return -5;
+  }
+  memcpy(pImgPxmpData->imgScaledRect, visible, sizeof(visible));
+  log_message(LOG_INFO, "Image %dx%d scaled in software (%s%s) to %dx%d, %dx%d of it visible", pImgPxmpData->imgWidth, pImgPxmpData->imgHeight,
+              psFilterName(scaleParams.filter), scaleParams.mirror ? ", mirrored" : "", imageRect[2], imageRect[3], visible[2], visible[3]);
+
+  return 0;
+}
 
-int bgrBlitImagePixmap(bgrImgPixmapData *imgPxmpData, bgrScrWinContexts *pScrWinCtxt) {
-  float img_aspect = 1280/768;
-  float display_aspect = 1280/768;
+// Blits the image into the window buffer as the scale mode places it, limited to clipRect (x, y, w, h; NULL for all of it).
+// Within clipRect, the letterbox area around the image is filled black.
+int bgrBlitImagePixmap(bgrImgPixmapData *imgPxmpData, bgrScrWinContexts *pScrWinCtxt, const int *clipRect) {
+  gfxBuffer srcBuffer = imgPxmpData->imgPixmapBuffer;
+  int srcWidth = imgPxmpData->imgWidth;
+  int srcHeight = imgPxmpData->imgHeight;
+  int imageRect[4];
   int dest_width;
   int dest_height;
   int dest_x = 0;
   int dest_y = 0;
+  int clip[4];
+  int clip_x2, clip_y2;
+  int damage[4];
+  int src_x1, src_y1, src_x2, src_y2;
   int screenIfaceResult;
-  static int attribs[200] = {0};
+  gfxBlitParams blitParams;
 
-  // Calculate aspect ratio and fit to display
-  img_aspect = (float)(imgPxmpData->img.w) / imgPxmpData->img.h;
-  display_aspect = (float)(pScrWinCtxt->scrWinBufferSize[0]) / pScrWinCtxt->scrWinBufferSize[1];
-  log_message(LOG_INFO, "Aspect Ratio Data: .img.w:%d, .img.h:%d, img_aspect:%.2f, .scrWinSize[0]:%d, .scrWinSize[1]:%d, display_aspect:%.2f ", imgPxmpData->img.w, imgPxmpData->img.h, img_aspect, pScrWinCtxt->scrWinSize[0], pScrWinCtxt->scrWinSize[1], display_aspect );
+  bgrCalcImageRect(imgPxmpData->imgWidth, imgPxmpData->imgHeight, pScrWinCtxt->scrWinBufferSize, ilEffectiveScaleMode(), imageRect);
+  if (ilSwScalerActive()) {
+    if (imgPxmpData->imgScaledRect[2] == 0) {
+      screenIfaceResult = ilScaleImagePixmap(imgPxmpData, pScrWinCtxt, imageRect);
+      if (screenIfaceResult != EOK) {
+        return screenIfaceResult;
+      }
+    }
+    memcpy(imageRect, imgPxmpData->imgScaledRect, sizeof(imageRect));
+    srcBuffer = imgPxmpData->imgScaledPixmapBuffer;
+    srcWidth = imageRect[2];
+    srcHeight = imageRect[3];
+  }
+  dest_x = imageRect[0];
+  dest_y = imageRect[1];
+  dest_width = imageRect[2];
+  dest_height = imageRect[3];
+  log_message(LOG_INFO, "Blit Attribute Data: dest_x:%d, dest_y:%d, dest_width:%d, dest_height:%d ", dest_x, dest_y, dest_width, dest_height);
 
-  if (img_aspect > display_aspect) {  // Image is wider than display
-    dest_width = pScrWinCtxt->scrWinBufferSize[0];
-    dest_height = pScrWinCtxt->scrWinBufferSize[0] / img_aspect;
-  } else {  // Image is taller than display
-    dest_width = pScrWinCtxt->scrWinBufferSize[1] * img_aspect;
-    dest_height = pScrWinCtxt->scrWinBufferSize[1];
+  if (clipRect != NULL) {
+    memcpy(clip, clipRect, sizeof(clip));
+  } else {
+    clip[0] = 0;
+    clip[1] = 0;
+    clip[2] = pScrWinCtxt->scrWinBufferSize[0];
+    clip[3] = pScrWinCtxt->scrWinBufferSize[1];
+  }
+  if ((clip[2] <= 0) || (clip[3] <= 0)) {
+    return EOK;
+  }
+  clip_x2 = clip[0] + clip[2];
+  clip_y2 = clip[1] + clip[3];
+
+  // Letterbox parts of the clip rect: above, below, left and right of the image
+  screenIfaceResult = bgrFillWindowRect(pScrWinCtxt, clip[0], clip[1], clip[2], dest_y - clip[1]);
+  screenIfaceResult |= bgrFillWindowRect(pScrWinCtxt, clip[0], dest_y + dest_height, clip[2], clip_y2 - (dest_y + dest_height));
+  if ((clip[1] < dest_y + dest_height) && (clip_y2 > dest_y)) {
+    int band_y = (clip[1] > dest_y) ? clip[1] : dest_y;
+    int band_h = ((clip_y2 < dest_y + dest_height) ? clip_y2 : dest_y + dest_height) - band_y;
+    screenIfaceResult |= bgrFillWindowRect(pScrWinCtxt, clip[0], band_y, dest_x - clip[0], band_h);
+    screenIfaceResult |= bgrFillWindowRect(pScrWinCtxt, dest_x + dest_width, band_y, clip_x2 - (dest_x + dest_width), band_h);
+  }
+  if (screenIfaceResult != EOK) {
+    return screenIfaceResult;
   }
 
-  dest_x = (pScrWinCtxt->scrWinBufferSize[0] - dest_width) / 2;
-  dest_y = (pScrWinCtxt->scrWinBufferSize[1] - dest_height) / 2;
-  log_message(LOG_INFO, "Blit Attribute Data: dest_x:%d, dest_y:%d, dest_width:%d, dest_height:%d ", dest_x, dest_y, dest_width, dest_height);
+  // Image part of the clip rect, mapped back to whole source pixels. The destination is snapped to
+  // those, then clamped to the clip rect again, as snapping can grow it by a pixel when the image is scaled.
+  if (clip[0] < dest_x) clip[0] = dest_x;
+  if (clip[1] < dest_y) clip[1] = dest_y;
+  if (clip_x2 > dest_x + dest_width) clip_x2 = dest_x + dest_width;
+  if (clip_y2 > dest_y + dest_height) clip_y2 = dest_y + dest_height;
+  if ((clip[0] >= clip_x2) || (clip[1] >= clip_y2)) {
+    return EOK;
+  }
+  damage[0] = clip[0];
+  damage[1] = clip[1];
+  damage[2] = clip_x2;
+  damage[3] = clip_y2;
+  src_x1 = (int)((long long)(clip[0] - dest_x) * srcWidth / dest_width);
+  src_y1 = (int)((long long)(clip[1] - dest_y) * srcHeight / dest_height);
+  src_x2 = (int)(((long long)(clip_x2 - dest_x) * srcWidth + dest_width - 1) / dest_width);
+  src_y2 = (int)(((long long)(clip_y2 - dest_y) * srcHeight + dest_height - 1) / dest_height);
+  clip[0] = dest_x + (int)((long long)src_x1 * dest_width / srcWidth);
+  clip[1] = dest_y + (int)((long long)src_y1 * dest_height / srcHeight);
+  clip_x2 = dest_x + (int)(((long long)src_x2 * dest_width + srcWidth - 1) / srcWidth);
+  clip_y2 = dest_y + (int)(((long long)src_y2 * dest_height + srcHeight - 1) / srcHeight);
+  if (clip[0] < damage[0]) clip[0] = damage[0];
+  if (clip[1] < damage[1]) clip[1] = damage[1];
+  if (clip_x2 > damage[2]) clip_x2 = damage[2];
+  if (clip_y2 > damage[3]) clip_y2 = damage[3];
 
   // Set up the attributes for blitting an image
-  setup_blit_attributes(0, 0, imgPxmpData->img.w, imgPxmpData->img.h,
-            dest_x, dest_y, dest_width, dest_height,
-            255, SCREEN_TRANSPARENCY_NONE, SCREEN_QUALITY_NICEST,
-            attribs);
+  blitParams = (gfxBlitParams){ src_x1, src_y1, src_x2 - src_x1, src_y2 - src_y1,
+                                 clip[0], clip[1], clip_x2 - clip[0], clip_y2 - clip[1],
+                                 255, gfx_Transparency_None, gfx_Quality_Nicest };
 
-
-  log_message(LOG_DEBUG, "Image screen blit ...");
-  screenIfaceResult = screen_blit(pScrWinCtxt->scrCtx, pScrWinCtxt->scrWinBuffer, imgPxmpData->imgPixmapBuffer, attribs);
+  log_message(LOG_DEBUG, "Image blit ...");
+  screenIfaceResult = gfx->blit(pScrWinCtxt->scrCtx, pScrWinCtxt->scrWinBuffer, srcBuffer, &blitParams);
   if ( screenIfaceResult != EOK) {
-    log_message(LOG_ERROR, "screen_blit() returned non-zero: %d", screenIfaceResult);
+    log_message(LOG_ERROR, "%s blit() returned non-zero: %d", gfx->name, screenIfaceResult);
   } else {
-    log_message(LOG_INFO, "screen_blit() completed!!!");
+    log_message(LOG_INFO, "Image blit completed!!!");
   }
 
   return screenIfaceResult;
@@ -870,70 +2032,308 @@ int bgrBlitImagePixmap(bgrImgPixmapData *imgPxmpData, bgrScrWinContexts *pScrWin
 
 
 void bgrCleanupScrWinContexts (bgrScrWinContexts *pScrWinCtxt) {
-  if (pScrWinCtxt->scrCtxState == eHandleValid) {
-    screen_destroy_context(pScrWinCtxt->scrCtx);
-    pScrWinCtxt->scrCtxState = eHandleUninit;
-  }
   if (pScrWinCtxt->scrWinState == eHandleValid) {
-    screen_destroy_window(pScrWinCtxt->scrWin);
+    gfx->destroyWindow(pScrWinCtxt->scrWin);
     pScrWinCtxt->scrWinState = eHandleUninit;
   }
+  if (pScrWinCtxt->scrCtxState == eHandleValid) {
+    gfx->destroyContext(pScrWinCtxt->scrCtx);
+    pScrWinCtxt->scrCtxState = eHandleUninit;
+  }
 }
 
 //@fix: Following 2 are begging to be abstracted
 void bgrCleanupImgPxmpContexts (bgrImgPixmapData *imgPxmpData) {
   if (imgPxmpData->imgPixmapState == eHandleValid) {
-    screen_destroy_pixmap(imgPxmpData->imgPixmap);
+    gfx->destroyPixmap(imgPxmpData->imgPixmap);
     imgPxmpData->imgPixmapState = eHandleUninit;
+    imgPxmpData->imgPixmapBufferState = eHandleUninit;
+  }
+  if (imgPxmpData->imgScaledPixmapState == eHandleValid) {
+    gfx->destroyPixmap(imgPxmpData->imgScaledPixmap);
+    imgPxmpData->imgScaledPixmapState = eHandleUninit;
+    imgPxmpData->imgScaledPixmapBufferState = eHandleUninit;
+  }
+#ifdef __QNX__
+  if (imgPxmpData->imgLibState == eHandleValid) {
+    img_lib_detach(imgPxmpData->imgLib);
+    imgPxmpData->imgLibState = eHandleUninit;
   }
+#endif
 }
 
 void bgrCleanupTxtPxmpContexts (bgrTxtPixmapData *txtPxmpData) {
   if (txtPxmpData->txtPixmapState == eHandleValid) {
-    screen_destroy_pixmap(txtPxmpData->txtPixmap);
+    gfx->destroyPixmap(txtPxmpData->txtPixmap);
     txtPxmpData->txtPixmapState = eHandleUninit;
   }
 }
 
 
 int bgrGetScreenDpi(bgrScrWinContexts *pScrWinCtxt) {
+  int getDpiResult;
+
+  getDpiResult = gfx->getDisplayDpi(pScrWinCtxt->scrWin, &(pScrWinCtxt->scrDispDpi));
+  if (getDpiResult != EOK) {
+    log_message(LOG_WARNING, "getScreenDpi::%s getDisplayDpi() returned non-zero: %d", gfx->name, getDpiResult);
+  }
+  return getDpiResult;
+}
+
+// Timestamps a startup milestone, once. Logged as CLOCK_MONOTONIC time (time since boot on QNX) and as
+// time since main() was entered.
+void bgrMarkStage(eStartupStages stage) {
+  long long nowUs, sinceStartUs;
+
+  if (stageMarked[stage]) {
+    return;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &(stageTimes[stage]));
+  stageMarked[stage] = 1;
+  trcInstant(stageNames[stage]);
+  nowUs = (long long)stageTimes[stage].tv_sec * 1000000 + stageTimes[stage].tv_nsec / 1000;
+  sinceStartUs = nowUs - ((long long)stageTimes[eStage_START].tv_sec * 1000000 + stageTimes[eStage_START].tv_nsec / 1000);
+  log_message(LOG_INFO, "Stage %-13s at %lld.%03lld ms monotonic, +%lld.%03lld ms since start", stageNames[stage], nowUs / 1000, nowUs % 1000, sinceStartUs / 1000, sinceStartUs % 1000);
+}
+
+// Adds a file name and its identity (mtime, size, inode) to a frame cache key. Returns non-zero if the file can not be stat()-ed.
+static int bgrHashFileInputs(uint64_t *pKey, const char *fileName) {
+  struct stat fileStat;
+
+  *pKey = fcHashStr(*pKey, fileName);
+  if (stat(fileName, &fileStat) != 0) {
+    return -1;
+  }
+  *pKey = fcHashInt(*pKey, (long long)fileStat.st_mtim.tv_sec);
+  *pKey = fcHashInt(*pKey, (long long)fileStat.st_mtim.tv_nsec);   /* A same-size edit within one second is a new input too */
+  *pKey = fcHashInt(*pKey, (long long)fileStat.st_size);
+  *pKey = fcHashInt(*pKey, (long long)fileStat.st_ino);
+  return 0;
+}
+
+// Key of everything the first complete frame is composed from, except the window size, known once the window exists.
+// Returns non-zero if the image can not be stat()-ed; the frame can not be trusted then.
+static int bgrFrameCacheInputsKey(bgrInitTaskData *pData, const char *txtStr, uint64_t *pKey) {
+  char atlasFileName[PARAM_MAX_LENGTH];
+  uint64_t key = FC_HASH_INIT;
+
+  if (bgrHashFileInputs(&key, pData->pImgData->imgFileName) != 0) {
+    return -1;
+  }
+  key = fcHashStr(key, gfx->name);
+  key = fcHashInt(key, pData->pWinCtxt->scrWinRotation);
+  key = fcHashInt(key, pData->pWinCtxt->scrWinFormat);
+  key = fcHashInt(key, scale_mode);
+  key = fcHashInt(key, mirror_mode);
+  key = fcHashInt(key, scaler_mode);
+  key = fcHashInt(key, txtSrc);
+  if (txtSrc != eTxtSrc_NONE) {
+    key = fcHashStr(key, txtStr);
+    bgrHashFileInputs(&key, pData->pTxtData->ttfFileName);
+    if (params[PARAM_ATLAS].was_passed) {
+      getParamValueByIndex(PARAM_ATLAS, PARAM_COUNT, params, atlasFileName);
+      bgrHashFileInputs(&key, atlasFileName);
+    }
+    key = fcHashInt(key, TXT_POINT_SIZE);
+    key = fcHashInt(key, txtComposeMode);
+    key = fcHashInt(key, txtColor);
+  }
+  *pKey = key;
+  return 0;
+}
+
+// Writes a posted window buffer to the frame cache. A failure only costs the next boot its shortcut.
+static void bgrStoreFrameCache(bgrScrWinContexts *pScrWinCtxt, gfxBuffer postedBuffer, const char *fileName, uint64_t key) {
+  gfxBufferInfo bufInfo;
   int screenIfaceResult;
-  int getDpiResult = -1;
-  int screenSize_mm[2];
-  int screenDiag_mm;
-  int screenDiag_in;
-  int screenRes[2];
-  int screenDiag_pix;
-
-  screenIfaceResult = screen_get_window_property_pv(pScrWinCtxt->scrWin , SCREEN_PROPERTY_DISPLAY, (void **)&(pScrWinCtxt->scrDisp));
+
+  screenIfaceResult = gfx->finish(pScrWinCtxt->scrCtx);
   if (screenIfaceResult == EOK) {
-    screenIfaceResult = screen_get_display_property_iv(pScrWinCtxt->scrDisp, SCREEN_PROPERTY_PHYSICAL_SIZE, screenSize_mm);
-    if (screenIfaceResult == EOK) {
-      screenDiag_mm = (int)round(sqrt(screenSize_mm[0] * screenSize_mm[0] + screenSize_mm[1] * screenSize_mm[1]));
-      screenDiag_in = (screenDiag_mm * 10) / 254;
-      if (screenDiag_in == 0) {
-        pScrWinCtxt->scrDispDpi = 0;
-        getDpiResult = 0;
-      } else {
-        screenIfaceResult = screen_get_display_property_iv(pScrWinCtxt->scrDisp, SCREEN_PROPERTY_SIZE, screenRes);
-        if (screenIfaceResult == EOK) {
-          screenDiag_pix = (int)round(sqrt(screenRes[0] * screenRes[0] + screenRes[1] * screenRes[1]));
-          pScrWinCtxt->scrDispDpi = screenDiag_pix/screenDiag_in;
-          getDpiResult = 0;
-        } else {
-          log_message(LOG_WARNING, "getScreenDpi::screen_get_window_property_pv(SCREEN_PROPERTY_SIZE) returned non-zero: %d", screenIfaceResult);
-          getDpiResult = -3;;
-        }
-      }
-    } else {
-      log_message(LOG_WARNING, "getScreenDpi::screen_get_window_property_pv(SCREEN_PROPERTY_PHYSICAL_SIZE) returned non-zero: %d", screenIfaceResult);
-      getDpiResult = -2;
+    screenIfaceResult = gfx->getBufferInfo(postedBuffer, &bufInfo);
+  }
+  if (screenIfaceResult == EOK) {
+    screenIfaceResult = fcStore(fileName, key, pScrWinCtxt->scrWinBufferSize[0], pScrWinCtxt->scrWinBufferSize[1], bufInfo.format, bufInfo.pData, bufInfo.stride);
+  }
+  if (screenIfaceResult != EOK) {
+    log_message(LOG_WARNING, "Frame cache not stored: %d", screenIfaceResult);
+  }
+}
+
+// Blocks until the channel delivers a text different from txtStr, which then holds the new text. Returns non-zero on channel errors.
+static int bgrWaitNewText(tcChannel *pChannel, char *txtStr, int maxTxtSize) {
+  char currentText[PARAM_MAX_LENGTH];
+  int waitResult;
+
+  strncpy(currentText, txtStr, PARAM_MAX_LENGTH);
+  do {
+    waitResult = tcWaitText(pChannel, txtStr, maxTxtSize);
+    if (waitResult < 0) {
+      log_message(LOG_ERROR, "tcWaitText() returned non-zero: %d", waitResult);
+      return waitResult;
+    }
+  } while ((waitResult != 0) || (0 == strncmp(currentText, txtStr, PARAM_MAX_LENGTH)));
+  log_message(LOG_DEBUG, "New text received: %s", txtStr);
+
+  return 0;
+}
+
+// Control socket queries: "?stats" returns the frame statistics.
+static int bgrAnswerQuery(const char *query, char *reply, int maxReplySize) {
+  if (0 == strcmp(query, FS_QUERY)) {
+    return fsReport(reply, maxReplySize);
+  }
+  log_message(LOG_WARNING, "Unknown control socket query: %s", query);
+  return snprintf(reply, maxReplySize, "unknown query\n\n");
+}
+
+// Startup tasks, run by the init scheduler. Each one only touches what its dependencies have finished.
+static int ilTaskContext(void *arg) {
+  bgrInitTaskData *pData = (bgrInitTaskData *)arg;
+
+  return bgrInitScreenContext(pData->pWinCtxt);
+}
+
+// Depends on: context
+static int ilTaskWindow(void *arg) {
+  bgrInitTaskData *pData = (bgrInitTaskData *)arg;
+  int taskResult;
+
+  taskResult = bgrInitScreenWindow(pData->pWinCtxt);
+  if (taskResult == EOK) {
+    bgrMarkStage(eStage_WINDOW);
+  }
+  return taskResult;
+}
+
+// Depends on: window (and DPI, with text). Loads a cached frame straight into the window render buffer; a miss or a bad file is not an error.
+static int ilTaskFrameCache(void *arg) {
+  bgrInitTaskData *pData = (bgrInitTaskData *)arg;
+  bgrScrWinContexts *pScrWinCtxt = pData->pWinCtxt;
+  fr_grBufferProps buffProps;
+  int taskResult;
+
+  pData->frameCacheKey = fcHashInt(pData->frameCacheKey, pScrWinCtxt->scrWinBufferSize[0]);
+  pData->frameCacheKey = fcHashInt(pData->frameCacheKey, pScrWinCtxt->scrWinBufferSize[1]);
+  if (txtSrc != eTxtSrc_NONE) {
+    pData->frameCacheKey = fcHashInt(pData->frameCacheKey, pScrWinCtxt->scrDispDpi);   /* Sets the glyph pixel size */
+  }
+  taskResult = bgrGetWindowBufferProps(pScrWinCtxt, &buffProps);
+  if (taskResult == EOK) {
+    taskResult = fcLoad(pData->frameCacheFile, pData->frameCacheKey, pScrWinCtxt->scrWinBufferSize[0], pScrWinCtxt->scrWinBufferSize[1],
+                        pScrWinCtxt->scrWinFormat, buffProps.fr_pix_buf_data, buffProps.fr_stride);
+    pData->frameCacheHit = (taskResult == 0);
+  }
+  if (taskResult < 0) {
+    log_message(LOG_WARNING, "Frame cache not loaded: %d", taskResult);
+  }
+  return 0;
+}
+
+// Depends on: window (and frame cache, if enabled). The window size bounds the decoded image size.
+static int ilTaskImage(void *arg) {
+  bgrInitTaskData *pData = (bgrInitTaskData *)arg;
+  int taskResult;
+
+  if (pData->frameCacheHit) {
+    return 0;
+  }
+  pData->pImgData->imgDecodeBound[0] = pData->pWinCtxt->scrWinBufferSize[0];
+  pData->pImgData->imgDecodeBound[1] = pData->pWinCtxt->scrWinBufferSize[1];
+  pData->pImgData->imgRotationAngle = pData->pWinCtxt->scrWinSwRotation;
+  //Decoded straight into the window format, unless the rotation or scaler kernels (XRGB8888 only) still work on the pixmap
+  pData->pImgData->imgPixmapFormat = ((pData->pImgData->imgRotationAngle == 0) && !ilSwScalerActive()) ? pData->pWinCtxt->scrWinFormat : ePixFmt_XRGB8888;
+  //Bands only for the boot image: a later reload would post the image over the text.
+  //Not for an image rotated or scaled in software either: rows decoded are not the rows displayed.
+  pData->pImgData->pImgBandWin = ((pData->pImgData->imgBandRows > 0) && (pData->pImgData->imgRotationAngle == 0) && !ilSwScalerActive()) ?
+                                 pData->pWinCtxt : NULL;
+  taskResult = bgrCreatePixmap(pData->pWinCtxt->scrCtx, &(pData->pImgData->imgPixmap));
+  if (taskResult != EOK) {
+    log_message(LOG_ERROR, "createPixmap(imgPixmap) returned non-zero: %d", taskResult);
+    return -1;
+  }
+  pData->pImgData->imgPixmapState = eHandleValid;
+  taskResult = bgrLoadImagePixmap(pData->pImgData);
+  pData->pImgData->pImgBandWin = NULL;
+  if (taskResult != EOK) {
+    log_message(LOG_ERROR, "bgrLoadImagePixmap() returned non-zero: %d", taskResult);
+    return -2;
+  }
+  bgrMarkStage(eStage_IMAGE_DECODED);
+  return 0;
+}
+
+// No dependencies (frame cache, if enabled). With an atlas, FreeType stays unloaded unless a glyph is missing from it.
+static int ilTaskFontOpen(void *arg) {
+  bgrInitTaskData *pData = (bgrInitTaskData *)arg;
+
+  if (pData->frameCacheHit || params[PARAM_ATLAS].was_passed) {
+    return 0;
+  }
+  return ftOpenFont(pData->pTxtData->ttfFileName);
+}
+
+// Depends on: window
+static int ilTaskDpi(void *arg) {
+  bgrScrWinContexts *pScrWinCtxt = ((bgrInitTaskData *)arg)->pWinCtxt;
+  int taskResult;
+
+  taskResult = bgrGetScreenDpi(pScrWinCtxt);
+  if ((taskResult != EOK) || (pScrWinCtxt->scrDispDpi == 0)) {
+    log_message(LOG_WARNING, "bgrGetScreenDpi() did not get DPI. Result: %d, DPI: %d", taskResult, pScrWinCtxt->scrDispDpi);
+    pScrWinCtxt->scrDispDpi = ftCalcDpi(TFT_WIDTH_MM, TFT_HEIGHT_MM, TFT_HORIZONTAL_RESOLUTION, TFT_VERTICAL_RESOLUTION);
+  }
+  if ( (pScrWinCtxt->scrDispDpi > 200) || (pScrWinCtxt->scrDispDpi < 50)) {
+    log_message(LOG_WARNING, "DPI of %d is suspicious.", pScrWinCtxt->scrDispDpi);
+  }
+  //The DPI a -atlas file has to be baked at
+  log_message(LOG_INFO, "Display DPI: %d", pScrWinCtxt->scrDispDpi);
+  return 0;
+}
+
+// Depends on: font open, DPI. Text pixmap and sized font or atlas: everything the first text render needs.
+static int ilTaskText(void *arg) {
+  bgrInitTaskData *pData = (bgrInitTaskData *)arg;
+  bgrTxtPixmapData *pTxtPixmapData = pData->pTxtData;
+  int dpi = pData->pWinCtxt->scrDispDpi;
+  char atlasFileName[PARAM_MAX_LENGTH];
+  int taskResult;
+
+  if (pData->frameCacheHit) {
+    return 0;
+  }
+
+  //BLEND mode renders straight into the window buffer, no text pixmap needed.
+  if (txtComposeMode == fr_Compose_Opaque) {
+    log_message(LOG_DEBUG, "createPixmap(txtPixmap) ...");
+    taskResult = bgrCreatePixmap(pData->pWinCtxt->scrCtx, &(pTxtPixmapData->txtPixmap));
+    if (taskResult != EOK) {
+      log_message(LOG_ERROR, "createPixmap(txtPixmap) returned non-zero: %d", taskResult);
+      return -1;
+    }
+    pTxtPixmapData->txtPixmapState = eHandleValid;
+    log_message(LOG_INFO, "createPixmap(txtPixmap) completed.");
+  }
+
+  taskResult = fr_Err_Atlas;
+  if (params[PARAM_ATLAS].was_passed) {
+    getParamValueByIndex(PARAM_ATLAS, PARAM_COUNT, params, atlasFileName);
+    taskResult = ftInitAtlas(atlasFileName, pTxtPixmapData->ttfFileName, TXT_POINT_SIZE, dpi);
+    if (taskResult != fr_OK) {
+      log_message(LOG_WARNING, "ftInitAtlas(%s) returned non-zero: %d. Falling back to FreeType.", atlasFileName, taskResult);
+      taskResult = ftInitFont(pTxtPixmapData->ttfFileName, TXT_POINT_SIZE, dpi);
     }
   } else {
-    log_message(LOG_WARNING, "getScreenDpi::screen_get_window_property_pv(SCREEN_PROPERTY_DISPLAY) returned non-zero: %d", screenIfaceResult);
-    getDpiResult = -1;
+    taskResult = ftSetFontSize(TXT_POINT_SIZE, dpi);
   }
-  return getDpiResult;
+  if (taskResult != fr_OK) {
+    log_message(LOG_ERROR, "Font %s at %dpt, dpi:%d could not be set up: %d", pTxtPixmapData->ttfFileName, TXT_POINT_SIZE, dpi, taskResult);
+    return -2;
+  }
+  log_message(LOG_INFO, "ftInitFont() completed.");
+  pData->txtLineHeight = frGetLineHeight();
+  bgrMarkStage(eStage_FONT_READY);
+
+  return 0;
 }
 
 int main(int argc, char *argv[])
@@ -943,17 +2343,33 @@ int main(int argc, char *argv[])
   bgrTxtPixmapData grTxtPxmpData;
 
   fr_grBufferProps ftGrBuffProps;
+  tcChannel txtChannel;
+  int txtChannelOpen = 0;
 
-  static int attribs[200] = {0};
+  gfxBlitParams blitParams;
   char txtStr[PARAM_MAX_LENGTH];
   char tmpParamStr[PARAM_MAX_LENGTH];
-  char currentText[PARAM_MAX_LENGTH];
+  char frameCacheFile[PARAM_MAX_LENGTH];
   int screenIfaceResult = -1;
   int strWidth, strHeight, maxPenPos_y;
-
-
+  int prevTxtRect[4] = {0, 0, 0, 0};
+  int txtRect[4];
+  int repaintRect[4];
+  int txtWinPos[2];
+  int txtLineHeight = 0;
+  int txtReady = 0;
+  int frameCacheStore = 0;
+  gfxBuffer postedBuffer;
+  isScheduler initSched;
+  bgrInitTaskData initTaskData;
+  int taskContext, taskWindow, taskImage;
+  int taskFontOpen = -1, taskDpi = -1, taskText = -1, taskFrameCache = -1;
+  uint64_t traceStart, traceUpdate;
+  uint64_t updateReceived = 0;
+
+
+   clock_gettime(CLOCK_MONOTONIC, &(stageTimes[eStage_START]));
    log_init(LOG_DEFAULT);
-   memset(attribs, SCREEN_BLIT_END, sizeof(attribs));
    memset(&ftGrBuffProps, 0, sizeof(fr_grBufferProps));
 
    // Parse arguments, validate, and use parameters
@@ -961,6 +2377,22 @@ int main(int argc, char *argv[])
        ParseResult prsArgReslt = parse_arguments(argc, argv, PARAM_COUNT, params);
 
        if (prsArgReslt == PARSE_SUCCESS) {
+           if (params[PARAM_LOG_BIN].was_passed) {
+               getParamValueByIndex(PARAM_LOG_BIN, PARAM_COUNT, params, tmpParamStr);
+               log_binary_start(tmpParamStr);
+           }
+           if (params[PARAM_TRACE].was_passed) {
+               getParamValueByIndex(PARAM_TRACE, PARAM_COUNT, params, tmpParamStr);
+               if (trcStart(tmpParamStr) == 0) {
+                   trcThreadName("main");
+                   trcSpan("parse arguments", (uint64_t)stageTimes[eStage_START].tv_sec * 1000000000u + stageTimes[eStage_START].tv_nsec, trcNow());
+               }
+           }
+           fsStart();
+           //From here on a slow console no longer stalls the callers; the queue is drained at exit
+           if (logAsyncEnabled && (log_async_start(logOverflowMode) != 0)) {
+               log_message(LOG_WARNING, "log_async_start() failed, log lines are written synchronously");
+           }
            switch (txtSrc) {
                case eTxtSrc_PARAM:
                    if (getParamValueByIndex(PARAM_TEXT, PARAM_COUNT, params, txtStr) != 0) {
@@ -987,9 +2419,21 @@ int main(int argc, char *argv[])
 
            //Init Screen, Screen Window, Window Buffer(s)
            memset(&grWinCtxt, 0, sizeof(grWinCtxt));
-           grWinCtxt.scrFlags = SCREEN_APPLICATION_CONTEXT;
-           grWinCtxt.scrWinFormat = SCREEN_FORMAT_RGBX8888;
-           grWinCtxt.scrWinUsage = SCREEN_USAGE_WRITE | SCREEN_USAGE_READ | SCREEN_USAGE_NATIVE | SCREEN_USAGE_ROTATION;
+           memset(&grTxtPxmpData, 0, sizeof(bgrTxtPixmapData));
+           grWinCtxt.scrWinBufferCount = winBufferCount;
+
+           if (gfx == &gfxSoftBackend) {
+               //The software framebuffer stands in for the target TFT; its DPI is left to the fallback below
+               tmpParamStr[0] = 0;
+               if (params[PARAM_SOFT_OUT].was_passed) {
+                   getParamValueByIndex(PARAM_SOFT_OUT, PARAM_COUNT, params, tmpParamStr);
+               }
+               gfxSoftConfigure(TFT_HORIZONTAL_RESOLUTION, TFT_VERTICAL_RESOLUTION, 0, tmpParamStr);
+           }
+           log_message(LOG_INFO, "Graphics backend: %s", gfx->name);
+           if ((scaler_mode == eScaler_HW) && ilSwScalerActive()) {
+               log_message(LOG_WARNING, "-scaler=HW: the %s blit can not mirror or shift the image, it is scaled in software", gfx->name);
+           }
 
            if (getParamValueByIndex(PARAM_ROTATION, PARAM_COUNT, params, tmpParamStr) != 0) {
                log_message(LOG_ERROR, "getParamValueByIndex(PARAM_ROTATION) returned non-zero after (parse_arguments() == PARSE_SUCCESS)");
@@ -997,74 +2441,167 @@ int main(int argc, char *argv[])
            } else {
                tmpParamStr[3] = 0;
                grWinCtxt.scrWinRotation = atoi(tmpParamStr);
-               if (grWinCtxt.scrWinRotation != 0 ) {
-                   grWinCtxt.scrWinUsage |= SCREEN_USAGE_ROTATION;
-               }
            }
-
-           screenIfaceResult = bgrInitScreenWindow(&grWinCtxt);
-           if (screenIfaceResult != EOK) {
-               log_message(LOG_ERROR, "bgrInitScreenWindow() returned non-zero: %d", screenIfaceResult);
-               return -1;
-           } else {
-               log_message(LOG_INFO, "bgrInitScreenWindow() completed.");
+           grWinCtxt.scrWinFormat = winFormat;
+           if ((winFormat != ePixFmt_XRGB8888) && (txtComposeMode == fr_Compose_Blend)) {
+               //The glyph blend kernels write RGBX8888 pixels straight into the window buffer
+               log_message(LOG_WARNING, "-textMode=BLEND needs an RGBX8888 window, PIXMAP used with -winFormat=%s", pfFormatName(winFormat));
+               txtComposeMode = fr_Compose_Opaque;
            }
 
            memset(&grImgPxmpData, 0, sizeof(bgrImgPixmapData));
+           grImgPxmpData.imgBandRows = imgBandRows;
            if (getParamValueByIndex(PARAM_FILE, PARAM_COUNT, params, grImgPxmpData.imgFileName) != 0) {
                log_message(LOG_ERROR, "getParamValueByIndex(PARAM_FILE) returned non-zero after (parse_arguments() == PARSE_SUCCESS)");
                return -1;
            }
-           screenIfaceResult = bgrCreatePixmap(&(grWinCtxt.scrCtx), &(grImgPxmpData.imgPixmap));
-           if (screenIfaceResult != EOK) {
-               log_message(LOG_ERROR, "createPixmap(screen_pix) returned non-zero: %d", screenIfaceResult);
-               bgrCleanupScrWinContexts(&grWinCtxt);
-               return -1;
-           } else {
-               log_message(LOG_INFO, "createPixmap(screen_pix) completed.");
-           }
-
-           //Init Text: Pixmap, buffer, Freetype, Font face.
            if (txtSrc != eTxtSrc_NONE) {
-               memset(&grTxtPxmpData, 0, sizeof(bgrTxtPixmapData));
                if (getParamValueByIndex(PARAM_FONT, PARAM_COUNT, params, grTxtPxmpData.ttfFileName) != 0) {
                    log_message(LOG_ERROR, "getParamValueByIndex(PARAM_FONT) returned non-zero after (parse_arguments() == PARSE_SUCCESS)");
                    return -1;
                }
-               log_message(LOG_DEBUG, "createPixmap(screen_pix_text) ...");
-               screenIfaceResult = bgrCreatePixmap(&(grWinCtxt.scrCtx), &(grTxtPxmpData.txtPixmap));
-               if (screenIfaceResult != EOK) {
-                   log_message(LOG_ERROR, "createPixmap(screen_pix_text) returned non-zero: %d", screenIfaceResult);
-                   bgrCleanupScrWinContexts(&grWinCtxt);
-                   bgrCleanupImgPxmpContexts (&grImgPxmpData);
-                   return -1;
-               } else {
-                   log_message(LOG_INFO, "createPixmap(screen_pix_text) completed.");
+               if (params[PARAM_CTRL].was_passed) {
+                   getParamValueByIndex(PARAM_CTRL, PARAM_COUNT, params, tmpParamStr);
+                   if (tcOpen(&txtChannel, tmpParamStr) != 0) {
+                       log_message(LOG_ERROR, "tcOpen(%s) failed", tmpParamStr);
+                       return -1;
+                   }
+                   tcSetQueryHandler(&txtChannel, bgrAnswerQuery);
+                   txtChannelOpen = 1;
                }
+           }
 
-               screenIfaceResult = bgrGetScreenDpi(&grWinCtxt);
-               if ((screenIfaceResult != EOK) || (grWinCtxt.scrDispDpi == 0)) {
-                   log_message(LOG_WARNING, "bgrGetScreenDpi() did not get DPI. Result: %d, DPI: %d", screenIfaceResult, grWinCtxt.scrDispDpi);
-                   grWinCtxt.scrDispDpi = ftCalcDpi(TFT_WIDTH_MM, TFT_HEIGHT_MM, TFT_HORIZONTAL_RESOLUTION, TFT_VERTICAL_RESOLUTION);
+           //Screen setup, image decode and font loading run concurrently. The text tasks are only waited
+           //for after the image frame is up.
+           //  context -> window -> dpi --+
+           //                    -> image +--> text
+           //  font open -----------------+
+           //The image waits for the window, as it is decoded at no more than the size it is displayed at.
+           //With a frame cache, image and font open wait for the cache task (after window) and do nothing on a hit.
+           initTaskData.pWinCtxt = &grWinCtxt;
+           initTaskData.pImgData = &grImgPxmpData;
+           initTaskData.pTxtData = &grTxtPxmpData;
+           initTaskData.txtLineHeight = 0;
+           initTaskData.frameCacheFile = NULL;
+           initTaskData.frameCacheKey = 0;
+           initTaskData.frameCacheHit = 0;
+           if (params[PARAM_FRAME_CACHE].was_passed) {
+               getParamValueByIndex(PARAM_FRAME_CACHE, PARAM_COUNT, params, frameCacheFile);
+               if (bgrFrameCacheInputsKey(&initTaskData, txtStr, &(initTaskData.frameCacheKey)) == 0) {
+                   initTaskData.frameCacheFile = frameCacheFile;
+                   frameCacheStore = 1;
+               } else {
+                   log_message(LOG_WARNING, "Frame cache disabled, %s can not be stat()-ed", grImgPxmpData.imgFileName);
                }
-               if ( (grWinCtxt.scrDispDpi > 200) || (grWinCtxt.scrDispDpi < 50)) {
-                   log_message(LOG_WARNING, "DPI of %d is suspicious.", grWinCtxt.scrDispDpi);
+           }
+           screenIfaceResult = isInit(&initSched, initThreadCount);
+           if (screenIfaceResult == EOK) {
+               taskContext = isAddTask(&initSched, "context", ilTaskContext, &initTaskData, NULL, 0);
+               taskWindow = isAddTask(&initSched, "window", ilTaskWindow, &initTaskData, (int[]){taskContext}, 1);
+               if (txtSrc != eTxtSrc_NONE) {
+                   taskDpi = isAddTask(&initSched, "dpi", ilTaskDpi, &initTaskData, (int[]){taskWindow}, 1);
+               }
+               if (initTaskData.frameCacheFile != NULL) {
+                   //The DPI is part of the key when there is text
+                   taskFrameCache = isAddTask(&initSched, "frame cache", ilTaskFrameCache, &initTaskData, (int[]){taskWindow, taskDpi}, (taskDpi >= 0) ? 2 : 1);
+               }
+               taskImage = isAddTask(&initSched, "image", ilTaskImage, &initTaskData, (int[]){taskWindow, taskFrameCache}, (taskFrameCache >= 0) ? 2 : 1);
+               if (txtSrc != eTxtSrc_NONE) {
+                   taskFontOpen = isAddTask(&initSched, "font open", ilTaskFontOpen, &initTaskData, &taskFrameCache, (taskFrameCache >= 0) ? 1 : 0);
+                   taskText = isAddTask(&initSched, "text", ilTaskText, &initTaskData, (int[]){taskFontOpen, taskDpi}, 2);
                }
+               screenIfaceResult = isStart(&initSched);
+               if (screenIfaceResult != EOK) {
+                   log_message(LOG_ERROR, "isStart() returned non-zero: %d", screenIfaceResult);
+                   isShutdown(&initSched);
+               }
+           } else {
+               log_message(LOG_ERROR, "isInit(%d) returned non-zero: %d", initThreadCount, screenIfaceResult);
+           }
+           if (screenIfaceResult == EOK) {
+               traceStart = trcBegin();
+               screenIfaceResult = isWait(&initSched, taskWindow);
+               if (screenIfaceResult == EOK) {
+                   screenIfaceResult = isWait(&initSched, taskImage);
+               }
+               trcEnd("wait window and image", traceStart);
+               if (screenIfaceResult != EOK) {
+                   log_message(LOG_ERROR, "Window or image initialization failed: %d", screenIfaceResult);
+                   isShutdown(&initSched);
+               } else if (txtSrc == eTxtSrc_NONE) {
+                   isShutdown(&initSched);
+               }
+           }
+           if (screenIfaceResult != EOK) {
+               if (txtChannelOpen) {
+                   tcClose(&txtChannel);
+               }
+               bgrCleanupScrWinContexts(&grWinCtxt);
+               bgrCleanupImgPxmpContexts (&grImgPxmpData);
+               bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
+               return -1;
+           }
+           log_message(LOG_INFO, "Window and image ready.");
 
-               screenIfaceResult = ftInitFont(grTxtPxmpData.ttfFileName, 16, grWinCtxt.scrDispDpi);
-               if (screenIfaceResult != fr_OK) {
-                   log_message(LOG_ERROR, "ftInitFont(ttfFileName:%s, 16, dpi:%d) returned non-zero: %d", grTxtPxmpData.ttfFileName, grWinCtxt.scrDispDpi, screenIfaceResult);
+           //A cached frame is posted as it is. Image and font are only set up once a new text needs them.
+           if (initTaskData.frameCacheHit) {
+               frameCacheStore = 0;
+               if (txtSrc != eTxtSrc_NONE) {
+                   isShutdown(&initSched);
+               }
+               bgrAddDamage(&grWinCtxt, (int[]){0, 0, grWinCtxt.scrWinBufferSize[0], grWinCtxt.scrWinBufferSize[1]});
+               screenIfaceResult = bgrPresentWindow(&grWinCtxt);
+               if (screenIfaceResult == EOK) {
+                   log_message(LOG_INFO, "Cached frame posted.");
+                   bgrMarkStage(eStage_FIRST_FRAME);
+                   if (txtSrc != eTxtSrc_NONE) {
+                       bgrMarkStage(eStage_TEXT_FRAME);
+                   }
+                   if (txtChannelOpen) {
+                       screenIfaceResult = bgrWaitNewText(&txtChannel, txtStr, sizeof(txtStr));
+                       updateReceived = trcNow();
+                   } else {
+                       while (1) {
+                           pause();
+                       }
+                   }
+               } else {
+                   log_message(LOG_ERROR, "bgrPresentWindow() returned non-zero: %d", screenIfaceResult);
+               }
+               if (screenIfaceResult == EOK) {
+                   initTaskData.frameCacheHit = 0;
+                   grImgPxmpData.imgBandRows = 0;   //The cached frame stays up until the text frame replaces it
+                   traceStart = trcBegin();
+                   screenIfaceResult = ilTaskImage(&initTaskData);
+                   if (screenIfaceResult == EOK) {
+                       screenIfaceResult = ilTaskFontOpen(&initTaskData);
+                   }
+                   if (screenIfaceResult == EOK) {
+                       screenIfaceResult = ilTaskText(&initTaskData);
+                   }
+                   trcEnd("deferred image and text init", traceStart);
+                   if (screenIfaceResult != EOK) {
+                       log_message(LOG_ERROR, "Deferred image and text initialization failed: %d", screenIfaceResult);
+                   }
+               }
+               if (screenIfaceResult != EOK) {
+                   if (txtChannelOpen) {
+                       tcClose(&txtChannel);
+                   }
                    bgrCleanupScrWinContexts(&grWinCtxt);
                    bgrCleanupImgPxmpContexts (&grImgPxmpData);
                    bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
                    return -1;
-               } else {
-                   log_message(LOG_INFO, "ftInitFont() completed.");
                }
+               txtLineHeight = initTaskData.txtLineHeight;
+               txtReady = 1;
            }
 
            while (1) {
+               traceUpdate = trcNow();
+               traceStart = traceUpdate;
                screenIfaceResult =  bgrLoadImagePixmap(&grImgPxmpData);
+               fsStageEnd(eFsStage_LOAD_IMAGE, traceStart);
                if (screenIfaceResult != EOK) {
                    log_message(LOG_ERROR, "bgrLoadImagePixmap() returned non-zero: %d", screenIfaceResult);
                    bgrCleanupScrWinContexts(&grWinCtxt);
@@ -1072,10 +2609,22 @@ int main(int argc, char *argv[])
                    bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
                    return -1;
                } else {
-                   log_message(LOG_INFO, "bgrLoadImagePixmap(screen_pix) completed.");
+                   log_message(LOG_INFO, "bgrLoadImagePixmap(imgPixmap) completed.");
+                   bgrMarkStage(eStage_IMAGE_DECODED);
                }
 
-               screenIfaceResult =  bgrBlitImagePixmap(&grImgPxmpData, &grWinCtxt);
+               //A new image changes everything; otherwise only the area of the previous text is redrawn from the image
+               if (grImgPxmpData.imgDecoded) {
+                   bgrAddDamage(&grWinCtxt, (int[]){0, 0, grWinCtxt.scrWinBufferSize[0], grWinCtxt.scrWinBufferSize[1]});
+                   grImgPxmpData.imgDecoded = 0;
+               }
+               bgrAddDamage(&grWinCtxt, prevTxtRect);
+               bgrGetRepaintRect(&grWinCtxt, repaintRect);
+
+               traceStart = trcNow();
+               screenIfaceResult =  bgrBlitImagePixmap(&grImgPxmpData, &grWinCtxt, repaintRect);
+               fsStageEnd(eFsStage_BLIT_IMAGE, traceStart);
+               fsAddBlitBytes((uint64_t)repaintRect[2] * repaintRect[3] * (pfBitsPerPixel(grWinCtxt.scrWinFormat) / 8));
                if (screenIfaceResult != EOK) {
                    log_message(LOG_ERROR, "bgrBlitImagePixmap(imgPxmp) returned non-zero: %d", screenIfaceResult);
                    bgrCleanupScrWinContexts(&grWinCtxt);
@@ -1086,18 +2635,52 @@ int main(int argc, char *argv[])
                    log_message(LOG_INFO, "bgrBlitImagePixmap(imgPxmp) completed.");
                }
 
-               if (txtSrc != eTxtSrc_NONE) {
-                 //QNX resets the buffer faster than any method I tried to clear the previous dirty rectangle.
-                 screenIfaceResult = bgrResetTxtPixmapBuffer(&grTxtPxmpData, grWinCtxt.scrWinSize, &ftGrBuffProps);
-
+               if (txtReady) {
+                 //Metrics only, no rasterization: the text box is known before any pixel work.
                  log_message(LOG_DEBUG, "frCalcStrPixelSize() for text:%s ", txtStr);
+                 traceStart = trcNow();
                  frCalcStrPixelSize(&maxPenPos_y, &strWidth, &strHeight, txtStr);
+                 fsStageEnd(eFsStage_MEASURE_TEXT, traceStart);
                  if ((strWidth < 1) || (strHeight < 1)) {
                    log_message(LOG_WARNING, "frCalcStrPixelSize() returned strWidth:%d, strHeight:%d", strWidth, strHeight);
                  }
 
-                 grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_x = 0;
-                 grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_y = grWinCtxt.scrWinSize[1] - strHeight - 1;
+                 if (strWidth > grWinCtxt.scrWinBufferSize[0]) {
+                   strWidth = grWinCtxt.scrWinBufferSize[0];
+                 }
+                 txtWinPos[0] = 0;
+                 txtWinPos[1] = grWinCtxt.scrWinBufferSize[1] - strHeight - 1;
+
+                 if (txtComposeMode == fr_Compose_Blend) {
+                   //Text is blended over the image already in the window buffer
+                   screenIfaceResult = bgrGetWindowBufferProps(&grWinCtxt, &ftGrBuffProps);
+                   if (screenIfaceResult != EOK) {
+                     log_message(LOG_ERROR, "bgrGetWindowBufferProps() returned non-zero: %d", screenIfaceResult);
+                     bgrCleanupScrWinContexts(&grWinCtxt);
+                     bgrCleanupImgPxmpContexts (&grImgPxmpData);
+                     bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
+                     return -1;
+                   }
+                   grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_x = txtWinPos[0];
+                   grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_y = txtWinPos[1];
+                 } else {
+                   //Text goes to the top left of the text strip, which is blitted to the text position
+                   traceStart = trcNow();
+                   screenIfaceResult = bgrPrepareTxtPixmap(&grTxtPxmpData, grWinCtxt.scrWinBufferSize[0], (strHeight > txtLineHeight) ? strHeight : txtLineHeight, &ftGrBuffProps);
+                   fsStageEnd(eFsStage_PREPARE_TEXT, traceStart);
+                   if (screenIfaceResult != EOK) {
+                     log_message(LOG_ERROR, "bgrPrepareTxtPixmap() returned non-zero: %d", screenIfaceResult);
+                     bgrCleanupScrWinContexts(&grWinCtxt);
+                     bgrCleanupImgPxmpContexts (&grImgPxmpData);
+                     bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
+                     return -1;
+                   }
+                   grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_x = 0;
+                   grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_y = 0;
+                 }
+                 ftGrBuffProps.fr_composeMode = txtComposeMode;
+                 ftGrBuffProps.fr_fgColor = txtColor;
+
                  grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_width = strWidth;
                  grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_height = strHeight;
                  grTxtPxmpData.ftCanvasProps.penPos.pen_x = 0 << 6;
@@ -1106,7 +2689,9 @@ int main(int argc, char *argv[])
                  log_message(LOG_DEBUG, "bb_start_x:%d, bb_start_y:%d, bb_width:%d, bb_height:%d, pen_x:%d, pen_y:%d", grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_x, grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_y, grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_width, grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_height, grTxtPxmpData.ftCanvasProps.penPos.pen_x, grTxtPxmpData.ftCanvasProps.penPos.pen_y);
 
                  //screenIfaceResult = ftRender(txtBoundBox, penPos, &txtDirtyRect, txtStr);
+                 traceStart = trcNow();
                  screenIfaceResult = ftRender(ftGrBuffProps, &(grTxtPxmpData.ftCanvasProps), txtStr);
+                 fsStageEnd(eFsStage_RENDER_TEXT, traceStart);
                  if ( screenIfaceResult != fr_OK) {
                  log_message(LOG_ERROR, "ftRender() returned non-zero: %d", screenIfaceResult);
                    bgrCleanupScrWinContexts(&grWinCtxt);
@@ -1117,52 +2702,117 @@ int main(int argc, char *argv[])
                    log_message(LOG_INFO, "ftRender() completed!!!");
                  }
 
-                   // Set up the attributes for blitting text
-                 setup_blit_attributes(grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_x,    /*src_x*/
-                                       grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_y,    /*src_y*/
-                                       grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_width,      /*src_width*/
-                                       grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_height,     /*src_height*/
-                                       grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_x,    /*dest_x*/
-                                       grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_y,    /*dest_y*/
-                                       grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_width,      /*dest_width*/
-                                       grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_height,     /*dest_height*/
-                                       255,                       /*global alpha*/
-                                       SCREEN_TRANSPARENCY_NONE,
-                                       SCREEN_QUALITY_NICEST,
-                                       attribs);
-
-                 log_message(LOG_DEBUG, "screen blit ...");
-                 screenIfaceResult = screen_blit(grWinCtxt.scrCtx, grWinCtxt.scrWinBuffer, grTxtPxmpData.txtPixmapBuffer, attribs);
-                 if ( screenIfaceResult != EOK) {
-                   log_message(LOG_ERROR, "screen_blit() returned non-zero: %d", screenIfaceResult);
-                   bgrCleanupScrWinContexts(&grWinCtxt);
-                   bgrCleanupImgPxmpContexts (&grImgPxmpData);
-                   bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
-                   return -1;
+                 //BLEND changes only the glyph pixels, PIXMAP replaces the whole text box
+                 if (txtComposeMode == fr_Compose_Blend) {
+                   txtRect[0] = grTxtPxmpData.ftCanvasProps.txtDirtyRect.bb_start_x;
+                   txtRect[1] = grTxtPxmpData.ftCanvasProps.txtDirtyRect.bb_start_y;
+                   txtRect[2] = grTxtPxmpData.ftCanvasProps.txtDirtyRect.bb_width;
+                   txtRect[3] = grTxtPxmpData.ftCanvasProps.txtDirtyRect.bb_height;
                  } else {
-                   log_message(LOG_INFO, "screen_blit() for text completed!!!");
+                   txtRect[0] = txtWinPos[0];
+                   txtRect[1] = txtWinPos[1];
+                   txtRect[2] = grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_width;
+                   txtRect[3] = grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_height;
+                 }
+                 bgrAddDamage(&grWinCtxt, txtRect);
+                 memcpy(prevTxtRect, txtRect, sizeof(prevTxtRect));
+                 fsAddBlitBytes((uint64_t)txtRect[2] * txtRect[3] * (pfBitsPerPixel(grWinCtxt.scrWinFormat) / 8));
+
+                 if (txtComposeMode == fr_Compose_Opaque) {
+                   blitParams = (gfxBlitParams){ grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_x,    /*src_x*/
+                                                 grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_start_y,    /*src_y*/
+                                                 grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_width,      /*src_width*/
+                                                 grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_height,     /*src_height*/
+                                                 txtWinPos[0],                                          /*dest_x*/
+                                                 txtWinPos[1],                                          /*dest_y*/
+                                                 grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_width,      /*dest_width*/
+                                                 grTxtPxmpData.ftCanvasProps.txtBoundBox.bb_height,     /*dest_height*/
+                                                 255,                       /*global alpha*/
+                                                 gfx_Transparency_None,
+                                                 gfx_Quality_Nicest };
+
+                   log_message(LOG_DEBUG, "text blit ...");
+                   traceStart = trcNow();
+                   screenIfaceResult = gfx->blit(grWinCtxt.scrCtx, grWinCtxt.scrWinBuffer, grTxtPxmpData.txtPixmapBuffer, &blitParams);
+                   fsStageEnd(eFsStage_BLIT_TEXT, traceStart);
+                   if ( screenIfaceResult != EOK) {
+                     log_message(LOG_ERROR, "%s blit() returned non-zero: %d", gfx->name, screenIfaceResult);
+                     bgrCleanupScrWinContexts(&grWinCtxt);
+                     bgrCleanupImgPxmpContexts (&grImgPxmpData);
+                     bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
+                     return -1;
+                   } else {
+                     log_message(LOG_INFO, "blit() for text completed!!!");
+                   }
                  }
                }
 
                //Image and text rendered & blitted to screen buffer. Next, display window to make anything change
-               log_message(LOG_DEBUG, "displayWindowBuffer() ...");
-               screenIfaceResult = displayWindowBuffer(&(grWinCtxt.scrWin), grWinCtxt.scrWinBuffer, grWinCtxt.scrWinDirtyRect);
+               log_message(LOG_DEBUG, "bgrPresentWindow() ...");
+               postedBuffer = grWinCtxt.scrWinBuffer;
+               traceStart = trcNow();
+               screenIfaceResult = bgrPresentWindow(&grWinCtxt);
+               fsStageEnd(eFsStage_PRESENT, traceStart);
+               fsStageEnd(eFsStage_UPDATE, traceUpdate);
+               fsFrameEnd(updateReceived, grWinCtxt.scrWinDirtyRect);
+               updateReceived = 0;
                if ( screenIfaceResult != EOK) {
-                   log_message(LOG_ERROR, "displayWindowBuffer() returned non-zero: %d", screenIfaceResult);
+                   log_message(LOG_ERROR, "bgrPresentWindow() returned non-zero: %d", screenIfaceResult);
                    bgrCleanupScrWinContexts(&grWinCtxt);
                    bgrCleanupImgPxmpContexts (&grImgPxmpData);
                    bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
                   return -1;
                } else {
-                   log_message(LOG_INFO, "displayWindowBuffer() completed!!!");
+                   log_message(LOG_INFO, "bgrPresentWindow() completed!!!");
+                   bgrMarkStage(eStage_FIRST_FRAME);
+                   if (txtReady) {
+                       bgrMarkStage(eStage_TEXT_FRAME);
+                   }
                }
 
-               strncpy(currentText, txtStr, PARAM_MAX_LENGTH);
+               //The first complete frame, text included, is what the next boot can post straight away
+               if (frameCacheStore && (txtReady || (txtSrc == eTxtSrc_NONE))) {
+                   bgrStoreFrameCache(&grWinCtxt, postedBuffer, frameCacheFile, initTaskData.frameCacheKey);
+                   frameCacheStore = 0;
+               }
 
-               do {
-                   usleep(10000);
-                   bgrGetEnvText(txtStr, sizeof(txtStr));
-               } while (0 == strncmp(currentText, txtStr, PARAM_MAX_LENGTH));
+               //The first pass posted the image alone. The text goes in a second frame, once its tasks are done.
+               if ((txtSrc != eTxtSrc_NONE) && !txtReady) {
+                   traceStart = trcBegin();
+                   screenIfaceResult = isWait(&initSched, taskText);
+                   isShutdown(&initSched);
+                   trcEnd("wait text tasks", traceStart);
+                   if (screenIfaceResult != EOK) {
+                       log_message(LOG_ERROR, "Text initialization failed: %d", screenIfaceResult);
+                       if (txtChannelOpen) {
+                           tcClose(&txtChannel);
+                       }
+                       bgrCleanupScrWinContexts(&grWinCtxt);
+                       bgrCleanupImgPxmpContexts (&grImgPxmpData);
+                       bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
+                       return -1;
+                   }
+                   txtLineHeight = initTaskData.txtLineHeight;
+                   txtReady = 1;
+                   continue;
+               }
+
+               //Sleep until a different text arrives. Without an update channel the text never changes.
+               if (txtChannelOpen) {
+                   screenIfaceResult = bgrWaitNewText(&txtChannel, txtStr, sizeof(txtStr));
+                   updateReceived = trcNow();
+                   if (screenIfaceResult != EOK) {
+                       tcClose(&txtChannel);
+                       bgrCleanupScrWinContexts(&grWinCtxt);
+                       bgrCleanupImgPxmpContexts (&grImgPxmpData);
+                       bgrCleanupTxtPxmpContexts (&grTxtPxmpData);
+                       return -1;
+                   }
+               } else {
+                   while (1) {
+                       pause();
+                   }
+               }
            }
 
 
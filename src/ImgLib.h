@@ -8,54 +8,132 @@
 #ifndef SRC_LIB_IMGLIB_IMGLIB_IMGLIB_H_
 #define SRC_LIB_IMGLIB_IMGLIB_IMGLIB_H_
 
+#include "GfxBackend.h"
+
+#define BGR_MAX_WIN_BUFFERS GFX_MAX_WIN_BUFFERS
+#define BGR_MAX_DAMAGE_RECTS 8
+
 typedef enum {
   eTxtSrc_NONE = 0,
   eTxtSrc_PARAM,
   eTxtSrc_ENVVAR
 } eTextSources;
 
+typedef enum {
+  eScale_NONE = 0,
+  eScale_STRETCH,
+  eScale_ZOOM,
+  eScale_FILL,
+  eScale_SHIFT_UP,
+  eScale_SHIFT_DOWN
+} eScaleModes;
+
+typedef enum {
+  eMirror_DISABLED = 0,
+  eMirror_NORMAL,
+  eMirror_STRETCH,
+  eMirror_ZOOM,
+  eMirror_FILL
+} eMirrorModes;
+
+typedef enum {
+  eScaler_AUTO = 0,
+  eScaler_HW,
+  eScaler_NEAREST,
+  eScaler_BILINEAR,
+  eScaler_AREA
+} eScalerModes;
+
 typedef enum {
   eHandleUninit = 0,
   eHandleValid,
   eHandleUbound
 } egfxHandleState;
 
+/* Startup milestones, timestamped once each on CLOCK_MONOTONIC (time since boot on QNX) */
+typedef enum {
+  eStage_START = 0,        /* main() entered */
+  eStage_WINDOW,           /* Context, window and window buffers created */
+  eStage_FIRST_BAND,       /* First rows of a progressively decoded image posted */
+  eStage_IMAGE_DECODED,    /* Splash image in its pixmap */
+  eStage_FIRST_FRAME,      /* Image posted: first pixel */
+  eStage_FONT_READY,       /* Font or atlas loaded, text pixmap created */
+  eStage_TEXT_FRAME,       /* Image and text posted */
+  eStage_COUNT
+} eStartupStages;
+
+typedef struct {
+  int rects[BGR_MAX_DAMAGE_RECTS][4];  /* x, y, width, height */
+  int count;
+} bgrDamageList;
+
 
 typedef struct {
-  screen_context_t scrCtx;
+  gfxContext scrCtx;
   egfxHandleState scrCtxState;
-  int scrFlags;
-  screen_window_t scrWin;
+  gfxWindow scrWin;
   egfxHandleState scrWinState;
-  screen_buffer_t scrWinBuffer;
+  gfxBuffer scrWinBuffer;               /* Current render buffer, one of scrWinBuffers[] */
+  gfxBuffer scrWinBuffers[BGR_MAX_WIN_BUFFERS];
+  int scrWinBufferCount;
+  int scrWinBufferIdx;
+  int scrWinBufferDamage[BGR_MAX_WIN_BUFFERS][4];  /* Per buffer: area changed since it was last rendered */
   int scrWinSize[2];
   int scrWinBufferSize[2];
-  int scrWinDirtyRect[4];
-  int scrWinFormat;
-  int scrWinUsage;
+  int scrWinDirtyRect[4];               /* Posted with the last frame */
+  bgrDamageList scrWinFrameDamage;     /* Changed since the last post */
   int scrWinRotation;
-  screen_display_t scrDisp;
+  int scrWinSwRotation;                 /* Part of scrWinRotation the backend did not apply */
+  ePixFormats scrWinFormat;             /* Window buffer format: XRGB8888 or RGB565 */
+  void *pScrWinBuffer;
+  int scrWinBufferStride;
   int scrDispDpi;
 
 } bgrScrWinContexts;
 
 typedef struct {
-  screen_pixmap_t imgPixmap;
+  gfxPixmap imgPixmap;
   egfxHandleState imgPixmapState;
-  screen_buffer_t imgPixmapBuffer;
+  gfxBuffer imgPixmapBuffer;
   egfxHandleState imgPixmapBufferState;
+  ePixFormats imgPixmapFormat;   /* The window format, or XRGB8888 where software rotation or scaling works on the pixmap */
+  int imgWidth;
+  int imgHeight;
+#ifdef __QNX__
   img_t img;
+  img_lib_t imgLib;
+  egfxHandleState imgLibState;
+  uint8_t *pImgNative;           /* Rows in the decoder's own format, converted into the pixmap as they complete. NULL: decoded into the pixmap */
+  ePixFormats imgNativeFormat;
+  int imgNativeStride;
+  int imgRowsConverted;
+  int imgConvertFailed;
+  uint32_t imgPalette[256];      /* PAL and MONO palette as XRGB8888, taken from the decoder with the first row converted */
+  int imgPaletteReady;
+#endif
   char imgFileName[PARAM_MAX_LENGTH];
-  img_fixed_t imgRotationAngle;
+  int imgRotationAngle;          /* Degrees, clockwise */
+  int imgDecodeBound[2];         /* Size the image is displayed in; larger images are downscaled while decoding. 0: full size */
+  bgrScrWinContexts *pImgBandWin;  /* Window decoded rows are posted to while decoding. NULL: nothing until decoded */
+  int imgBandRows;               /* Pixmap rows per posted band */
+  int imgBandPosted;             /* Pixmap rows posted so far */
+  gfxPixmap imgScaledPixmap;     /* Software scaled image, 1:1 with the window area it covers. Only with a software scaler */
+  egfxHandleState imgScaledPixmapState;
+  gfxBuffer imgScaledPixmapBuffer;
+  egfxHandleState imgScaledPixmapBufferState;
+  int imgScaledSize[2];          /* Size of imgScaledPixmapBuffer */
+  int imgScaledRect[4];          /* Window area imgScaledPixmapBuffer holds. Width 0: not scaled yet */
+  struct stat imgFileStat;       /* Source file identity at the last decode */
+  int imgDecoded;                /* A new image was decoded and is not on screen yet */
 } bgrImgPixmapData;
 
 
 typedef struct {
-  screen_pixmap_t txtPixmap;
+  gfxPixmap txtPixmap;
   egfxHandleState txtPixmapState;
-  screen_buffer_t txtPixmapBuffer;
+  gfxBuffer txtPixmapBuffer;
   egfxHandleState txtPixmapBufferState;
-  int txtPixmapSize;
+  int txtPixmapSize[2];          /* Text strip: window width x tallest text line */
   void *pTxtPixmapBuffer;
   int txtPixmapBufferStride;
   char ttfFileName[PARAM_MAX_LENGTH];
@@ -63,24 +141,28 @@ typedef struct {
 } bgrTxtPixmapData;
 
 
-void rotateImage180(unsigned char *data, int width, int height, int bytesPerPixel);
+#ifdef __QNX__
 int getBytesPerPixel(img_t img);
-//static int decode_setup(uintptr_t data, img_t *img, unsigned flags);
-//static void decode_abort(uintptr_t data, img_t *img);
-int load_image(screen_window_t screen_win, const char *path);
-int LoadImg(img_t *img, const char *path);
+#endif
 
-//int createWindow(screen_context_t *pScreen_ctx, screen_window_t *pScreen_win, int *screen_size, int *buffer_size);
 int bgrCreateWindow(bgrScrWinContexts *pScrWinCtxt);
-int createWindowBuffers(screen_window_t *pScreen_win, void **screen_buf);
-int displayWindowBuffer(screen_window_t *pScreen_win, screen_buffer_t screen_bufer, int *dirty_rect);
-int bgrCreatePixmap(screen_context_t *pScreen_ctx, screen_pixmap_t *pScreen_pix);
-int bgrResetTxtPixmapBuffer(bgrTxtPixmapData *pTxtPixmapData, int *pixmap_size, fr_grBufferProps *pBuffProps);
+int createWindowBuffers(gfxWindow win, int bufferCount, gfxBuffer *pBuffers);
+int displayWindowBuffer(gfxWindow win, gfxBuffer buffer, int *dirty_rect);
+void bgrUnionRect(int *rect, const int *addRect);
+void bgrAddDamage(bgrScrWinContexts *pScrWinCtxt, const int *rect);
+void bgrGetRepaintRect(bgrScrWinContexts *pScrWinCtxt, int *repaintRect);
+int bgrPresentWindow(bgrScrWinContexts *pScrWinCtxt);
+int bgrCreatePixmap(gfxContext ctx, gfxPixmap *pPix);
+int bgrPrepareTxtPixmap(bgrTxtPixmapData *pTxtPixmapData, int width, int height, fr_grBufferProps *pBuffProps);
+int bgrGetWindowBufferProps(bgrScrWinContexts *pScrWinCtxt, fr_grBufferProps *pBuffProps);
 int bgrLoadImagePixmap(bgrImgPixmapData *pImgPxmpData);
-int bgrBlitImagePixmap(bgrImgPixmapData *imgPxmpData, bgrScrWinContexts *pScrWinCtxt);
+void bgrCalcFitSize(int imgWidth, int imgHeight, const int *boundSize, int *fitSize);
+void bgrCalcImageRect(int imgWidth, int imgHeight, const int *boundSize, int scaleMode, int *rect);
+int bgrBlitImagePixmap(bgrImgPixmapData *imgPxmpData, bgrScrWinContexts *pScrWinCtxt, const int *clipRect);
 void bgrCleanupScrWinContexts (bgrScrWinContexts *pScrWinCtxt);
 void bgrCleanupImgPxmpContexts (bgrImgPixmapData *imgPxmpData);
 void bgrCleanupTxtPxmpContexts (bgrTxtPixmapData *txtPxmpData);
 int bgrGetScreenDpi(bgrScrWinContexts *pScrWinCtxt);
+void bgrMarkStage(eStartupStages stage);
 
 #endif /* SRC_LIB_IMGLIB_IMGLIB_IMGLIB_H_ */
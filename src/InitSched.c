@@ -0,0 +1,218 @@
+/*
+ * InitSched.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file InitSched.c
+ *
+ *  @brief Startup task scheduler on a small pthread pool.
+ *
+ *  All tasks are added before isStart(). A task may only depend on tasks added
+ *  before it, so the graph can not have cycles. When a task fails, every task
+ *  depending on it, directly or not, is skipped with IS_ERR_DEP_FAILED.
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <string.h>
+
+#include "logger.h"
+#include "InitSched.h"
+#include "Trace.h"
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+static long long isElapsedUs(const struct timespec *pBase, const struct timespec *pTime) {
+  return (long long)(pTime->tv_sec - pBase->tv_sec) * 1000000 + (pTime->tv_nsec - pBase->tv_nsec) / 1000;
+}
+
+static int isFinished(const isTask *pTask) {
+  return (pTask->state == eTask_DONE) || (pTask->state == eTask_FAILED) || (pTask->state == eTask_SKIPPED);
+}
+
+// Called with the lock held. Skips pending tasks behind a failed one and returns the id of a task
+// whose dependencies are all done, or -1 if none can run yet.
+static int isFindRunnable(isScheduler *pSched) {
+  isTask *pTask;
+  int runnable = -1;
+  int depsDone;
+  int i, d;
+
+  for (i = 0; (i < pSched->taskCount) && (runnable < 0); i++) {
+    pTask = &(pSched->tasks[i]);
+    if (pTask->state != eTask_PENDING) {
+      continue;
+    }
+    depsDone = 1;
+    for (d = 0; d < pTask->depCount; d++) {
+      eTaskStates depState = pSched->tasks[pTask->deps[d]].state;
+      if ((depState == eTask_FAILED) || (depState == eTask_SKIPPED)) {
+        // Dependencies come earlier in the list, so one pass propagates skips down the whole graph
+        pTask->state = eTask_SKIPPED;
+        pTask->result = IS_ERR_DEP_FAILED;
+        pSched->finishedCount++;
+        log_message(LOG_WARNING, "isTask %s skipped, %s did not succeed", pTask->name, pSched->tasks[pTask->deps[d]].name);
+        pthread_cond_broadcast(&(pSched->cond));
+        depsDone = 0;
+        break;
+      }
+      if (depState != eTask_DONE) {
+        depsDone = 0;
+      }
+    }
+    if (depsDone) {
+      runnable = i;
+    }
+  }
+
+  return runnable;
+}
+
+static void *isWorker(void *arg) {
+  isScheduler *pSched = (isScheduler *)arg;
+  isTask *pTask;
+  int taskId;
+  int result;
+  uint64_t traceStart;
+
+  trcThreadName("init worker");
+  pthread_mutex_lock(&(pSched->lock));
+  while (pSched->finishedCount < pSched->taskCount) {
+    taskId = isFindRunnable(pSched);
+    if (taskId < 0) {
+      if (pSched->finishedCount < pSched->taskCount) {
+        pthread_cond_wait(&(pSched->cond), &(pSched->lock));
+      }
+      continue;
+    }
+
+    pTask = &(pSched->tasks[taskId]);
+    pTask->state = eTask_RUNNING;
+    clock_gettime(CLOCK_MONOTONIC, &(pTask->startTime));
+    pthread_mutex_unlock(&(pSched->lock));
+
+    traceStart = trcBegin();
+    result = pTask->fn(pTask->arg);
+    trcEnd(pTask->name, traceStart);
+
+    pthread_mutex_lock(&(pSched->lock));
+    clock_gettime(CLOCK_MONOTONIC, &(pTask->endTime));
+    pTask->result = result;
+    pTask->state = (result == 0) ? eTask_DONE : eTask_FAILED;
+    pSched->finishedCount++;
+    log_message((result == 0) ? LOG_INFO : LOG_ERROR, "isTask %-12s %s: %lld.%03lld .. %lld.%03lld ms", pTask->name, (result == 0) ? "done" : "failed",
+                isElapsedUs(&(pSched->baseTime), &(pTask->startTime)) / 1000, isElapsedUs(&(pSched->baseTime), &(pTask->startTime)) % 1000,
+                isElapsedUs(&(pSched->baseTime), &(pTask->endTime)) / 1000, isElapsedUs(&(pSched->baseTime), &(pTask->endTime)) % 1000);
+    pthread_cond_broadcast(&(pSched->cond));
+  }
+  pthread_mutex_unlock(&(pSched->lock));
+
+  return NULL;
+}
+
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+int isInit(isScheduler *pSched, int threadCount) {
+  memset(pSched, 0, sizeof(isScheduler));
+  if ((threadCount < 1) || (threadCount > IS_MAX_THREADS)) {
+    log_message(LOG_ERROR, "isInit: %d threads not supported", threadCount);
+    return -1;
+  }
+  pSched->threadCount = threadCount;
+  if (pthread_mutex_init(&(pSched->lock), NULL) != 0) {
+    log_message(LOG_ERROR, "isInit::pthread_mutex_init() failed");
+    return -2;
+  }
+  if (pthread_cond_init(&(pSched->cond), NULL) != 0) {
+    log_message(LOG_ERROR, "isInit::pthread_cond_init() failed");
+    pthread_mutex_destroy(&(pSched->lock));
+    return -3;
+  }
+  return 0;
+}
+
+// Returns the task id, or negative on error. deps are ids returned by earlier isAddTask() calls.
+int isAddTask(isScheduler *pSched, const char *name, isTaskFn fn, void *arg, const int *deps, int depCount) {
+  isTask *pTask;
+  int d;
+
+  if (pSched->started || (pSched->taskCount >= IS_MAX_TASKS) || (depCount < 0) || (depCount > IS_MAX_DEPS)) {
+    log_message(LOG_ERROR, "isAddTask(%s): scheduler started or task/dependency limit reached", name);
+    return -1;
+  }
+  for (d = 0; d < depCount; d++) {
+    if ((deps[d] < 0) || (deps[d] >= pSched->taskCount)) {
+      log_message(LOG_ERROR, "isAddTask(%s): invalid dependency %d", name, deps[d]);
+      return -2;
+    }
+  }
+
+  pTask = &(pSched->tasks[pSched->taskCount]);
+  memset(pTask, 0, sizeof(isTask));
+  pTask->name = name;
+  pTask->fn = fn;
+  pTask->arg = arg;
+  memcpy(pTask->deps, deps, depCount * sizeof(int));
+  pTask->depCount = depCount;
+  pTask->state = eTask_PENDING;
+
+  return pSched->taskCount++;
+}
+
+int isStart(isScheduler *pSched) {
+  int i;
+
+  clock_gettime(CLOCK_MONOTONIC, &(pSched->baseTime));
+  pSched->started = 1;
+  for (i = 0; i < pSched->threadCount; i++) {
+    if (pthread_create(&(pSched->threads[i]), NULL, isWorker, pSched) != 0) {
+      log_message(LOG_ERROR, "isStart::pthread_create() failed for worker %d", i);
+      break;
+    }
+  }
+  pSched->threadCount = i;
+  if (i == 0) {
+    return -1;
+  }
+  log_message(LOG_DEBUG, "isStart: %d tasks on %d threads", pSched->taskCount, pSched->threadCount);
+  return 0;
+}
+
+// Blocks until the task has finished. Returns its result: 0, the task error or IS_ERR_DEP_FAILED.
+int isWait(isScheduler *pSched, int taskId) {
+  int result;
+
+  if ((taskId < 0) || (taskId >= pSched->taskCount)) {
+    return -1;
+  }
+  pthread_mutex_lock(&(pSched->lock));
+  while (!isFinished(&(pSched->tasks[taskId]))) {
+    pthread_cond_wait(&(pSched->cond), &(pSched->lock));
+  }
+  result = pSched->tasks[taskId].result;
+  pthread_mutex_unlock(&(pSched->lock));
+
+  return result;
+}
+
+// Waits for every task to finish and releases the pool.
+void isShutdown(isScheduler *pSched) {
+  int i;
+
+  for (i = 0; i < pSched->threadCount; i++) {
+    pthread_join(pSched->threads[i], NULL);
+  }
+  pSched->threadCount = 0;
+  pthread_cond_destroy(&(pSched->cond));
+  pthread_mutex_destroy(&(pSched->lock));
+}
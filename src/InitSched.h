@@ -0,0 +1,64 @@
+/*
+ * InitSched.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Startup task scheduler: independent init steps run concurrently on a small
+ *  pthread pool, each one as soon as the tasks it depends on have succeeded.
+ */
+
+#ifndef SRC_INITSCHED_H_
+#define SRC_INITSCHED_H_
+
+#include <pthread.h>
+#include <time.h>
+
+#define IS_MAX_TASKS    16
+#define IS_MAX_DEPS     4
+#define IS_MAX_THREADS  4
+
+/* Result of a task skipped because one of its dependencies failed */
+#define IS_ERR_DEP_FAILED  (-1000)
+
+typedef int (*isTaskFn)(void *arg);   /* Returns 0 on success */
+
+typedef enum {
+  eTask_PENDING = 0,
+  eTask_RUNNING,
+  eTask_DONE,
+  eTask_FAILED,
+  eTask_SKIPPED
+} eTaskStates;
+
+typedef struct {
+  const char *name;
+  isTaskFn fn;
+  void *arg;
+  int deps[IS_MAX_DEPS];
+  int depCount;
+  eTaskStates state;
+  int result;
+  struct timespec startTime;
+  struct timespec endTime;
+} isTask;
+
+typedef struct {
+  isTask tasks[IS_MAX_TASKS];
+  int taskCount;
+  int finishedCount;
+  pthread_t threads[IS_MAX_THREADS];
+  int threadCount;
+  int started;
+  struct timespec baseTime;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} isScheduler;
+
+int isInit(isScheduler *pSched, int threadCount);
+int isAddTask(isScheduler *pSched, const char *name, isTaskFn fn, void *arg, const int *deps, int depCount);
+int isStart(isScheduler *pSched);
+int isWait(isScheduler *pSched, int taskId);
+void isShutdown(isScheduler *pSched);
+
+#endif /* SRC_INITSCHED_H_ */
@@ -0,0 +1,456 @@
+/*
+ * PixFormat.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file PixFormat.c
+ *
+ *  @brief Pixel format conversion into the display formats, with SIMD variants.
+ *
+ *  Every source format has a kernel into XRGB8888. Into RGB565, sources other than
+ *  RGB565 itself go through XRGB8888 in chunks of PF_CHUNK pixels held on the stack,
+ *  so the source and destination rows are still walked once.
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <string.h>
+
+#include "PixKernels.h"
+#include "PixFormat.h"
+
+#define PF_CHUNK   256    /* Pixels per step when converting into RGB565 through XRGB8888; a multiple of 8 */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define PF_USE_NEON
+#elif defined(__SSE2__)
+ #include <emmintrin.h>
+ #define PF_USE_SSE2
+ #if defined(__SSSE3__)
+  #include <tmmintrin.h>
+  #define PF_USE_SSSE3
+ #endif
+#endif
+
+
+/******************************************************************************
+  File Scope Variables
+ ******************************************************************************/
+static const struct {
+  const char *name;
+  int bits;
+} pfFormats[ePixFmt_COUNT] = {
+  [ePixFmt_INVALID]     = { "INVALID",     0  },
+  [ePixFmt_XRGB8888]    = { "XRGB8888",    32 },
+  [ePixFmt_XBGR8888]    = { "XBGR8888",    32 },
+  [ePixFmt_XRGB8888_BE] = { "XRGB8888_BE", 32 },
+  [ePixFmt_XBGR8888_BE] = { "XBGR8888_BE", 32 },
+  [ePixFmt_RGB888]      = { "RGB888",      24 },
+  [ePixFmt_BGR888]      = { "BGR888",      24 },
+  [ePixFmt_RGB565]      = { "RGB565",      16 },
+  [ePixFmt_RGB565_BE]   = { "RGB565_BE",   16 },
+  [ePixFmt_XRGB1555]    = { "XRGB1555",    16 },
+  [ePixFmt_XRGB1555_BE] = { "XRGB1555_BE", 16 },
+  [ePixFmt_G8]          = { "G8",          8  },
+  [ePixFmt_A8]          = { "A8",          8  },
+  [ePixFmt_PAL8]        = { "PAL8",        8  },
+  [ePixFmt_PAL4]        = { "PAL4",        4  },
+  [ePixFmt_PAL1]        = { "PAL1",        1  }
+};
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+// 0xXXRRGGBB -> 0xffRRGGBB, a plain loop the compiler vectorizes
+static void pfSetAlpha(uint32_t *dst, const uint32_t *src, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        dst[i] = src[i] | 0xff000000u;
+    }
+}
+
+// 0xXXBBGGRR -> 0xffRRGGBB
+static void pfXbgrToXrgb(uint32_t *dst, const uint32_t *src, int count) {
+    uint32_t p;
+    int i = 0;
+
+#if defined(PF_USE_NEON)
+    const uint8x16_t alpha = vdupq_n_u8(0xff);
+
+    // vld4 splits the bytes into R, G, B, X planes; storing them back as B, G, R, 0xff swaps the words
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t px = vld4q_u8((const uint8_t *)(src + i));
+        uint8x16_t r = px.val[0];
+        px.val[0] = px.val[2];
+        px.val[2] = r;
+        px.val[3] = alpha;
+        vst4q_u8((uint8_t *)(dst + i), px);
+    }
+#elif defined(PF_USE_SSE2)
+    const __m128i green = _mm_set1_epi32(0x0000ff00);
+    const __m128i low = _mm_set1_epi32(0x000000ff);
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i r = _mm_slli_epi32(_mm_and_si128(v, low), 16);
+        __m128i b = _mm_and_si128(_mm_srli_epi32(v, 16), low);
+        v = _mm_or_si128(_mm_or_si128(_mm_and_si128(v, green), alpha), _mm_or_si128(r, b));
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+#endif
+
+    for (; i < count; i++) {
+        p = src[i];
+        dst[i] = 0xff000000u | (p & 0x0000ff00u) | ((p & 0xffu) << 16) | ((p >> 16) & 0xffu);
+    }
+}
+
+// Big endian words are rare in practice; the two shifts below are left to the compiler's vectorizer.
+static void pfBe32ToXrgb(uint32_t *dst, const uint32_t *src, int count, int bgr) {
+    uint32_t p;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        p = src[i];
+        // Bytes X, B, G, R read little endian are 0xRRGGBBXX; X, R, G, B need a full byte swap
+        dst[i] = 0xff000000u | (bgr ? (p >> 8) : (((p & 0xff00u) << 8) | ((p >> 8) & 0xff00u) | (p >> 24)));
+    }
+}
+
+// Byte triplets R, G, B (bgr: B, G, R) -> 0xffRRGGBB
+static void pf24ToXrgb(uint32_t *dst, const uint8_t *src, int count, int bgr) {
+    uint32_t w0, w1, w2;
+    int i = 0;
+
+#if defined(PF_USE_NEON)
+    const uint8x16_t alpha = vdupq_n_u8(0xff);
+
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x3_t in = vld3q_u8(src + (size_t)i * 3);
+        uint8x16x4_t px;
+        px.val[0] = bgr ? in.val[0] : in.val[2];
+        px.val[1] = in.val[1];
+        px.val[2] = bgr ? in.val[2] : in.val[0];
+        px.val[3] = alpha;
+        vst4q_u8((uint8_t *)(dst + i), px);
+    }
+#elif defined(PF_USE_SSSE3)
+    const __m128i rgbShuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i bgrShuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i shuffle = bgr ? bgrShuffle : rgbShuffle;
+    const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+
+    // 16 byte loads take 12 bytes each: stop while 4 more source bytes are there to over-read
+    for (; i + 6 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + (size_t)i * 3));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+#endif
+
+    // Four pixels from three little endian words: B, G, R byte order is already the XRGB8888 one
+    for (; i + 4 <= count; i += 4) {
+        memcpy(&w0, src + (size_t)i * 3, 4);
+        memcpy(&w1, src + (size_t)i * 3 + 4, 4);
+        memcpy(&w2, src + (size_t)i * 3 + 8, 4);
+        dst[i]     = w0 & 0x00ffffffu;
+        dst[i + 1] = ((w0 >> 24) | (w1 << 8)) & 0x00ffffffu;
+        dst[i + 2] = ((w1 >> 16) | (w2 << 16)) & 0x00ffffffu;
+        dst[i + 3] = w2 >> 8;
+        if (!bgr) {
+            dst[i]     = (dst[i] & 0xff00u) | ((dst[i] & 0xffu) << 16) | (dst[i] >> 16);
+            dst[i + 1] = (dst[i + 1] & 0xff00u) | ((dst[i + 1] & 0xffu) << 16) | (dst[i + 1] >> 16);
+            dst[i + 2] = (dst[i + 2] & 0xff00u) | ((dst[i + 2] & 0xffu) << 16) | (dst[i + 2] >> 16);
+            dst[i + 3] = (dst[i + 3] & 0xff00u) | ((dst[i + 3] & 0xffu) << 16) | (dst[i + 3] >> 16);
+        }
+        dst[i] |= 0xff000000u;
+        dst[i + 1] |= 0xff000000u;
+        dst[i + 2] |= 0xff000000u;
+        dst[i + 3] |= 0xff000000u;
+    }
+    for (; i < count; i++) {
+        const uint8_t *p = src + (size_t)i * 3;
+        dst[i] = bgr ? (0xff000000u | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0])
+                     : (0xff000000u | ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2]);
+    }
+}
+
+// 5 bit red and blue around a 6 (RGB565) or 5 (XRGB1555) bit green, widened by replicating the top bits,
+// so 0x1f becomes 0xff and 0 stays 0
+static inline uint32_t pfExpand16(uint32_t p, int gBits) {
+    uint32_t r = (p >> (5 + gBits)) & 0x1fu;
+    uint32_t g = (p >> 5) & ((1u << gBits) - 1);
+    uint32_t b = p & 0x1fu;
+
+    r = (r << 3) | (r >> 2);
+    g = (g << (8 - gBits)) | (g >> (2 * gBits - 8));
+    b = (b << 3) | (b >> 2);
+    return 0xff000000u | (r << 16) | (g << 8) | b;
+}
+
+static void pf16ToXrgb(uint32_t *dst, const uint16_t *src, int count, int gBits, int bigEndian) {
+    uint32_t p;
+    int i = 0;
+
+#if defined(PF_USE_NEON)
+    const uint16x8_t mask5 = vdupq_n_u16(0x1f);
+    const uint16x8_t gMask = vdupq_n_u16((uint16_t)((1 << gBits) - 1));
+    const int16x8_t rShift = vdupq_n_s16((int16_t)-(5 + gBits));
+    const int16x8_t gUp = vdupq_n_s16((int16_t)(8 - gBits));
+    const int16x8_t gDown = vdupq_n_s16((int16_t)-(2 * gBits - 8));
+    const uint8x8_t alpha = vdup_n_u8(0xff);
+
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t v = vld1q_u16(src + i);
+        uint16x8_t r, g, b;
+        uint8x8x4_t px;
+
+        if (bigEndian) {
+            v = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(v)));
+        }
+        r = vandq_u16(vshlq_u16(v, rShift), mask5);
+        g = vandq_u16(vshrq_n_u16(v, 5), gMask);
+        b = vandq_u16(v, mask5);
+        px.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+        px.val[1] = vmovn_u16(vorrq_u16(vshlq_u16(g, gUp), vshlq_u16(g, gDown)));
+        px.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+        px.val[3] = alpha;
+        vst4_u8((uint8_t *)(dst + i), px);
+    }
+#elif defined(PF_USE_SSE2)
+    const __m128i mask5 = _mm_set1_epi16(0x1f);
+    const __m128i gMask = _mm_set1_epi16((short)((1 << gBits) - 1));
+    const __m128i rShift = _mm_cvtsi32_si128(5 + gBits);
+    const __m128i gUp = _mm_cvtsi32_si128(8 - gBits);
+    const __m128i gDown = _mm_cvtsi32_si128(2 * gBits - 8);
+    const __m128i alpha = _mm_set1_epi16((short)0xff00);
+
+    // Channels widened in 16-bit lanes, then G:B and 0xff:R word pairs interleave into 0xffRRGGBB
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i r, g, b, gb, ar;
+
+        if (bigEndian) {
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+        r = _mm_and_si128(_mm_srl_epi16(v, rShift), mask5);
+        g = _mm_and_si128(_mm_srli_epi16(v, 5), gMask);
+        b = _mm_and_si128(v, mask5);
+        r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+        g = _mm_or_si128(_mm_sll_epi16(g, gUp), _mm_srl_epi16(g, gDown));
+        b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+        gb = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+        ar = _mm_or_si128(r, alpha);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(gb, ar));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(gb, ar));
+    }
+#endif
+
+    for (; i < count; i++) {
+        p = src[i];
+        if (bigEndian) {
+            p = ((p & 0xffu) << 8) | (p >> 8);
+        }
+        dst[i] = pfExpand16(p, gBits);
+    }
+}
+
+static void pfPal8ToXrgb(uint32_t *dst, const uint8_t *src, int count, const uint32_t *palette) {
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        dst[i]     = palette[src[i]] | 0xff000000u;
+        dst[i + 1] = palette[src[i + 1]] | 0xff000000u;
+        dst[i + 2] = palette[src[i + 2]] | 0xff000000u;
+        dst[i + 3] = palette[src[i + 3]] | 0xff000000u;
+    }
+    for (; i < count; i++) {
+        dst[i] = palette[src[i]] | 0xff000000u;
+    }
+}
+
+// PAL4 and PAL1: indexes packed from the most significant bits of each byte
+static void pfPalBitsToXrgb(uint32_t *dst, const uint8_t *src, int count, const uint32_t *palette, int bits) {
+    const int perByte = 8 / bits;
+    const uint32_t mask = (1u << bits) - 1;
+    uint32_t byte = 0;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if ((i % perByte) == 0) {
+            byte = src[i / perByte];
+        }
+        dst[i] = palette[(byte >> (8 - bits * (1 + i % perByte))) & mask] | 0xff000000u;
+    }
+}
+
+static int pfToXrgb(uint32_t *dst, const void *src, ePixFormats srcFmt, int count, const uint32_t *palette) {
+    switch (srcFmt) {
+        case ePixFmt_XRGB8888:
+            pfSetAlpha(dst, (const uint32_t *)src, count);
+            return 0;
+        case ePixFmt_XBGR8888:
+            pfXbgrToXrgb(dst, (const uint32_t *)src, count);
+            return 0;
+        case ePixFmt_XRGB8888_BE:
+        case ePixFmt_XBGR8888_BE:
+            pfBe32ToXrgb(dst, (const uint32_t *)src, count, srcFmt == ePixFmt_XBGR8888_BE);
+            return 0;
+        case ePixFmt_RGB888:
+        case ePixFmt_BGR888:
+            pf24ToXrgb(dst, (const uint8_t *)src, count, srcFmt == ePixFmt_BGR888);
+            return 0;
+        case ePixFmt_RGB565:
+        case ePixFmt_RGB565_BE:
+            pf16ToXrgb(dst, (const uint16_t *)src, count, 6, srcFmt == ePixFmt_RGB565_BE);
+            return 0;
+        case ePixFmt_XRGB1555:
+        case ePixFmt_XRGB1555_BE:
+            pf16ToXrgb(dst, (const uint16_t *)src, count, 5, srcFmt == ePixFmt_XRGB1555_BE);
+            return 0;
+        case ePixFmt_G8:
+        case ePixFmt_A8:
+            pkCoverageToRgbx(dst, (const uint8_t *)src, count);
+            return 0;
+        case ePixFmt_PAL8:
+        case ePixFmt_PAL4:
+        case ePixFmt_PAL1:
+            if (palette == NULL) {
+                return -1;
+            }
+            if (srcFmt == ePixFmt_PAL8) {
+                pfPal8ToXrgb(dst, (const uint8_t *)src, count, palette);
+            } else {
+                pfPalBitsToXrgb(dst, (const uint8_t *)src, count, palette, pfFormats[srcFmt].bits);
+            }
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+// 0xAARRGGBB -> RGB565, truncating to the top 5/6/5 bits
+static void pfXrgbTo565(uint16_t *dst, const uint32_t *src, int count) {
+    uint32_t p;
+    int i = 0;
+
+#if defined(PF_USE_NEON)
+    // R into the top byte, then G and B shifted in below it: vsri keeps the bits already placed
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t px = vld4_u8((const uint8_t *)(src + i));
+        uint16x8_t out = vshll_n_u8(px.val[2], 8);
+        out = vsriq_n_u16(out, vshll_n_u8(px.val[1], 8), 5);
+        out = vsriq_n_u16(out, vshll_n_u8(px.val[0], 8), 11);
+        vst1q_u16(dst + i, out);
+    }
+#elif defined(PF_USE_SSE2)
+    const __m128i rMask = _mm_set1_epi32(0xf800);
+    const __m128i gMask = _mm_set1_epi32(0x07e0);
+    const __m128i bMask = _mm_set1_epi32(0x001f);
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i + 4));
+
+        a = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(a, 8), rMask), _mm_and_si128(_mm_srli_epi32(a, 5), gMask)),
+                         _mm_and_si128(_mm_srli_epi32(a, 3), bMask));
+        b = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(b, 8), rMask), _mm_and_si128(_mm_srli_epi32(b, 5), gMask)),
+                         _mm_and_si128(_mm_srli_epi32(b, 3), bMask));
+        // Sign extended, the 16-bit values survive the signed saturating pack unchanged
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a, b));
+    }
+#endif
+
+    for (; i < count; i++) {
+        p = src[i];
+        dst[i] = (uint16_t)(((p >> 8) & 0xf800u) | ((p >> 5) & 0x07e0u) | ((p >> 3) & 0x001fu));
+    }
+}
+
+static void pfSwap16(uint16_t *dst, const uint16_t *src, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        dst[i] = (uint16_t)((src[i] << 8) | (src[i] >> 8));
+    }
+}
+
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+int pfBitsPerPixel(ePixFormats fmt) {
+  return ((fmt > ePixFmt_INVALID) && (fmt < ePixFmt_COUNT)) ? pfFormats[fmt].bits : 0;
+}
+
+int pfRowBytes(ePixFormats fmt, int width) {
+  return (int)(((long long)width * pfBitsPerPixel(fmt) + 7) / 8);
+}
+
+int pfIsDisplayFormat(ePixFormats fmt) {
+  return (fmt == ePixFmt_XRGB8888) || (fmt == ePixFmt_RGB565);
+}
+
+int pfConvertRow(void *dst, ePixFormats dstFmt, const void *src, ePixFormats srcFmt, int count, const uint32_t *palette) {
+  uint32_t chunk[PF_CHUNK];
+  int done, n;
+
+  if (count <= 0) {
+    return 0;
+  }
+  if (dstFmt == ePixFmt_XRGB8888) {
+    return pfToXrgb((uint32_t *)dst, src, srcFmt, count, palette);
+  }
+  if (dstFmt != ePixFmt_RGB565) {
+    return -1;
+  }
+
+  if (srcFmt == ePixFmt_RGB565) {
+    memcpy(dst, src, (size_t)count * 2);
+  } else if (srcFmt == ePixFmt_RGB565_BE) {
+    pfSwap16((uint16_t *)dst, (const uint16_t *)src, count);
+  } else if (srcFmt == ePixFmt_XRGB8888) {
+    pfXrgbTo565((uint16_t *)dst, (const uint32_t *)src, count);
+  } else {
+    for (done = 0; done < count; done += n) {
+      n = (count - done < PF_CHUNK) ? count - done : PF_CHUNK;
+      if (pfToXrgb(chunk, (const uint8_t *)src + pfRowBytes(srcFmt, done), srcFmt, n, palette) != 0) {
+        return -1;
+      }
+      pfXrgbTo565((uint16_t *)dst + done, chunk, n);
+    }
+  }
+
+  return 0;
+}
+
+int pfConvertImage(void *dst, int dstStride, ePixFormats dstFmt, const void *src, int srcStride, ePixFormats srcFmt,
+                   int width, int height, const uint32_t *palette) {
+  int y;
+
+  for (y = 0; y < height; y++) {
+    if (pfConvertRow((uint8_t *)dst + (size_t)y * dstStride, dstFmt, (const uint8_t *)src + (size_t)y * srcStride, srcFmt, width, palette) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+uint16_t pfPackRgb565(uint32_t color) {
+  return (uint16_t)(((color >> 8) & 0xf800u) | ((color >> 5) & 0x07e0u) | ((color >> 3) & 0x001fu));
+}
+
+const char *pfFormatName(ePixFormats fmt) {
+  return ((fmt >= ePixFmt_INVALID) && (fmt < ePixFmt_COUNT)) ? pfFormats[fmt].name : "UNKNOWN";
+}
@@ -0,0 +1,62 @@
+/*
+ * PixFormat.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Pixel format conversion between the formats decoders produce and the two display
+ *  formats windows and pixmaps can have: XRGB8888 (what Screen calls RGBX8888) and RGB565.
+ *  Row kernels with NEON (aarch64), SSE2/SSSE3 (x86) and scalar implementations,
+ *  selected at compile time like PixKernels.
+ */
+
+#ifndef SRC_PIXFORMAT_H_
+#define SRC_PIXFORMAT_H_
+
+#include <stdint.h>
+
+/* Names follow libimg. Alpha is not kept: the ARGB/ABGR/ARGB1555 variants convert as their X twins. */
+typedef enum {
+  ePixFmt_INVALID = 0,
+  ePixFmt_XRGB8888,            /* Little endian 0xXXRRGGBB words. Display format */
+  ePixFmt_XBGR8888,            /* Little endian 0xXXBBGGRR words */
+  ePixFmt_XRGB8888_BE,         /* Bytes X, R, G, B */
+  ePixFmt_XBGR8888_BE,         /* Bytes X, B, G, R */
+  ePixFmt_RGB888,              /* Bytes R, G, B */
+  ePixFmt_BGR888,              /* Bytes B, G, R */
+  ePixFmt_RGB565,              /* Little endian 16 bit words. Display format */
+  ePixFmt_RGB565_BE,
+  ePixFmt_XRGB1555,            /* Little endian 16 bit words */
+  ePixFmt_XRGB1555_BE,
+  ePixFmt_G8,                  /* Gray */
+  ePixFmt_A8,                  /* Alpha only: shown as white over black, i.e. as gray */
+  ePixFmt_PAL8,                /* Indexes into a palette of XRGB8888 entries */
+  ePixFmt_PAL4,                /* Two indexes per byte, high nibble first */
+  ePixFmt_PAL1,                /* Eight indexes per byte, most significant bit first. MONO: PAL1 with a black and white palette */
+  ePixFmt_COUNT
+} ePixFormats;
+
+/* Bits per pixel of fmt, 0 if it is not a valid format. */
+int pfBitsPerPixel(ePixFormats fmt);
+
+/* Bytes a row of width pixels takes, without padding. */
+int pfRowBytes(ePixFormats fmt, int width);
+
+/* Non-zero for the formats windows and pixmaps can have: XRGB8888 and RGB565. */
+int pfIsDisplayFormat(ePixFormats fmt);
+
+/* Converts the first count pixels of row src (srcFmt) into dst (dstFmt, a display format). XRGB8888 output
+ * has X = 0xff. palette holds the XRGB8888 entries for the PAL formats (2, 16 or 256 of them), NULL for
+ * the others. src and dst must not overlap. Returns 0, or -1 for an unsupported pair. */
+int pfConvertRow(void *dst, ePixFormats dstFmt, const void *src, ePixFormats srcFmt, int count, const uint32_t *palette);
+
+/* pfConvertRow() for each row of a width x height image. Strides are in bytes. */
+int pfConvertImage(void *dst, int dstStride, ePixFormats dstFmt, const void *src, int srcStride, ePixFormats srcFmt,
+                   int width, int height, const uint32_t *palette);
+
+/* The XRGB8888 color 0xAARRGGBB packed as RGB565. */
+uint16_t pfPackRgb565(uint32_t color);
+
+const char *pfFormatName(ePixFormats fmt);
+
+#endif /* SRC_PIXFORMAT_H_ */
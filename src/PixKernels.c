@@ -0,0 +1,401 @@
+/*
+ * PixKernels.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file PixKernels.c
+ *
+ *  @brief Row oriented pixel kernels with SIMD variants.
+ *
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <string.h>
+
+#include "PixKernels.h"
+
+#define PK_ROTATE_TILE   32    /* Tile side in pixels: 32 source and 32 destination rows of a tile stay in L1 */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define PK_USE_NEON
+#elif defined(__AVX2__)
+ #include <immintrin.h>
+ #define PK_USE_AVX2
+ #define PK_USE_SSE2
+#elif defined(__SSE2__)
+ #include <emmintrin.h>
+ #define PK_USE_SSE2
+#endif
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+// Exact, rounded (fg * a + bg * (255 - a)) / 255
+static inline uint32_t pkBlendChannel(uint32_t fg, uint32_t bg, uint32_t a) {
+    uint32_t t = fg * a + bg * (255 - a);
+    return (t + ((t + 128) >> 8) + 128) >> 8;
+}
+
+// a[i] <-> b[count - 1 - i] for all i: two distinct rows swapped and mirrored in one pass
+static void pkSwapMirrored(uint32_t *a, uint32_t *b, int count) {
+    uint32_t tmp;
+    int i = 0;
+
+#if defined(PK_USE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t va = vld1q_u32(a + i);
+        uint32x4_t vb = vld1q_u32(b + count - 4 - i);
+        va = vrev64q_u32(va);
+        vb = vrev64q_u32(vb);
+        vst1q_u32(a + i, vcombine_u32(vget_high_u32(vb), vget_low_u32(vb)));
+        vst1q_u32(b + count - 4 - i, vcombine_u32(vget_high_u32(va), vget_low_u32(va)));
+    }
+#elif defined(PK_USE_AVX2)
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + count - 8 - i));
+        _mm256_storeu_si256((__m256i *)(a + i), _mm256_permutevar8x32_epi32(vb, reverse));
+        _mm256_storeu_si256((__m256i *)(b + count - 8 - i), _mm256_permutevar8x32_epi32(va, reverse));
+    }
+#elif defined(PK_USE_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + count - 4 - i));
+        _mm_storeu_si128((__m128i *)(a + i), _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 1, 2, 3)));
+        _mm_storeu_si128((__m128i *)(b + count - 4 - i), _mm_shuffle_epi32(va, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        tmp = a[i];
+        a[i] = b[count - 1 - i];
+        b[count - 1 - i] = tmp;
+    }
+}
+
+// Mirrors one row in place: the two halves are swapped mirrored, the middle pixel of an odd row stays
+static void pkMirrorRow(uint32_t *row, int count) {
+    pkSwapMirrored(row, row + (count + 1) / 2, count / 2);
+}
+
+// Stores the transposed 4x4 block of src rows: dst[k][i] = src[i][k]
+static inline void pkTranspose4(uint32_t *const dst[4], const uint32_t *const src[4]) {
+#if defined(PK_USE_NEON)
+    uint32x4x2_t t01 = vtrnq_u32(vld1q_u32(src[0]), vld1q_u32(src[1]));
+    uint32x4x2_t t23 = vtrnq_u32(vld1q_u32(src[2]), vld1q_u32(src[3]));
+    vst1q_u32(dst[0], vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])));
+    vst1q_u32(dst[1], vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])));
+    vst1q_u32(dst[2], vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+    vst1q_u32(dst[3], vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+#elif defined(PK_USE_SSE2)
+    __m128i r0 = _mm_loadu_si128((const __m128i *)src[0]);
+    __m128i r1 = _mm_loadu_si128((const __m128i *)src[1]);
+    __m128i r2 = _mm_loadu_si128((const __m128i *)src[2]);
+    __m128i r3 = _mm_loadu_si128((const __m128i *)src[3]);
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    _mm_storeu_si128((__m128i *)dst[0], _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)dst[1], _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)dst[2], _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128((__m128i *)dst[3], _mm_unpackhi_epi64(t2, t3));
+#else
+    int i, k;
+
+    for (k = 0; k < 4; k++) {
+        for (i = 0; i < 4; i++) {
+            dst[k][i] = src[i][k];
+        }
+    }
+#endif
+}
+
+// Out of place quarter turn, walked in square tiles so the column-wise side of the transpose stays in cache.
+// Clockwise: dst[x][srcHeight - 1 - y] = src[y][x]. Counterclockwise: dst[srcWidth - 1 - x][y] = src[y][x].
+static void pkRotate90(const uint8_t *src, int srcWidth, int srcHeight, int srcStride, uint8_t *dst, int dstStride, int clockwise) {
+    const uint32_t *srcRows[4];
+    uint32_t *dstRows[4];
+    int tileX, tileY, tileX2, tileY2;
+    int x, y, k;
+
+#define PK_SRC_PX(py, px) (((const uint32_t *)(src + (size_t)(py) * srcStride)) + (px))
+#define PK_DST_PX(py, px) (((uint32_t *)(dst + (size_t)(py) * dstStride)) + (px))
+#define PK_ROTATE_PX(py, px) do { \
+        if (clockwise) { \
+            *PK_DST_PX(px, srcHeight - 1 - (py)) = *PK_SRC_PX(py, px); \
+        } else { \
+            *PK_DST_PX(srcWidth - 1 - (px), py) = *PK_SRC_PX(py, px); \
+        } \
+    } while (0)
+
+    for (tileY = 0; tileY < srcHeight; tileY += PK_ROTATE_TILE) {
+        tileY2 = (tileY + PK_ROTATE_TILE < srcHeight) ? tileY + PK_ROTATE_TILE : srcHeight;
+        for (tileX = 0; tileX < srcWidth; tileX += PK_ROTATE_TILE) {
+            tileX2 = (tileX + PK_ROTATE_TILE < srcWidth) ? tileX + PK_ROTATE_TILE : srcWidth;
+
+            for (y = tileY; y + 4 <= tileY2; y += 4) {
+                for (x = tileX; x + 4 <= tileX2; x += 4) {
+                    // Clockwise reads the 4 rows bottom up, so each transposed row comes out in destination order
+                    for (k = 0; k < 4; k++) {
+                        if (clockwise) {
+                            srcRows[k] = PK_SRC_PX(y + 3 - k, x);
+                            dstRows[k] = PK_DST_PX(x + k, srcHeight - 4 - y);
+                        } else {
+                            srcRows[k] = PK_SRC_PX(y + k, x);
+                            dstRows[k] = PK_DST_PX(srcWidth - 1 - x - k, y);
+                        }
+                    }
+                    pkTranspose4(dstRows, srcRows);
+                }
+                for (; x < tileX2; x++) {
+                    for (k = 0; k < 4; k++) {
+                        PK_ROTATE_PX(y + k, x);
+                    }
+                }
+            }
+            for (; y < tileY2; y++) {
+                for (x = tileX; x < tileX2; x++) {
+                    PK_ROTATE_PX(y, x);
+                }
+            }
+        }
+    }
+#undef PK_ROTATE_PX
+#undef PK_SRC_PX
+#undef PK_DST_PX
+}
+
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+const char *pkKernelVariant(void) {
+#if defined(PK_USE_NEON)
+    return "neon";
+#elif defined(PK_USE_AVX2)
+    return "avx2";
+#elif defined(PK_USE_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+
+void pkCoverageToRgbx(uint32_t *dst, const uint8_t *src, int count) {
+    int i = 0;
+
+#if defined(PK_USE_NEON)
+    const uint8x16_t alpha = vdupq_n_u8(0xff);
+
+    // vst4 interleaves the 4 planes: C,C,C,0xff -> 0xffCCCCCC little endian
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t px;
+        uint8x16_t c = vld1q_u8(src + i);
+        px.val[0] = c;
+        px.val[1] = c;
+        px.val[2] = c;
+        px.val[3] = alpha;
+        vst4q_u8((uint8_t *)(dst + i), px);
+    }
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t px;
+        uint8x8_t c = vld1_u8(src + i);
+        px.val[0] = c;
+        px.val[1] = c;
+        px.val[2] = c;
+        px.val[3] = vget_low_u8(alpha);
+        vst4_u8((uint8_t *)(dst + i), px);
+    }
+#elif defined(PK_USE_AVX2)
+    // Each 128-bit lane expands 4 coverage bytes: lane 0 takes bytes 0..3, lane 1 bytes 4..7
+    const __m256i expand = _mm256_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1,
+                                            4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+    const __m256i alpha = _mm256_set1_epi32((int)0xff000000);
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i c = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i *)(src + i)));
+        c = _mm256_or_si256(_mm256_shuffle_epi8(c, expand), alpha);
+        _mm256_storeu_si256((__m256i *)(dst + i), c);
+    }
+#elif defined(PK_USE_SSE2)
+    const __m128i alpha = _mm_set1_epi8((char)0xff);
+
+    // (c,c) and (c,0xff) byte pairs, interleaved as 16-bit words give C,C,C,0xff
+    for (; i + 16 <= count; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i ccLo = _mm_unpacklo_epi8(c, c);
+        __m128i caLo = _mm_unpacklo_epi8(c, alpha);
+        __m128i ccHi = _mm_unpackhi_epi8(c, c);
+        __m128i caHi = _mm_unpackhi_epi8(c, alpha);
+        _mm_storeu_si128((__m128i *)(dst + i),      _mm_unpacklo_epi16(ccLo, caLo));
+        _mm_storeu_si128((__m128i *)(dst + i + 4),  _mm_unpackhi_epi16(ccLo, caLo));
+        _mm_storeu_si128((__m128i *)(dst + i + 8),  _mm_unpacklo_epi16(ccHi, caHi));
+        _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(ccHi, caHi));
+    }
+    // Glyph rows are often narrower than 16 pixels
+    for (; i + 8 <= count; i += 8) {
+        __m128i c = _mm_loadl_epi64((const __m128i *)(src + i));
+        __m128i cc = _mm_unpacklo_epi8(c, c);
+        __m128i ca = _mm_unpacklo_epi8(c, alpha);
+        _mm_storeu_si128((__m128i *)(dst + i),     _mm_unpacklo_epi16(cc, ca));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(cc, ca));
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = 0xff000000u | ((uint32_t)src[i] * 0x010101u);
+    }
+}
+
+
+void pkBlendCoverageRgbx(uint32_t *dst, const uint8_t *src, int count, uint32_t color) {
+    const uint32_t fgR = (color >> 16) & 0xff;
+    const uint32_t fgG = (color >> 8) & 0xff;
+    const uint32_t fgB = color & 0xff;
+    int i = 0;
+
+#if defined(PK_USE_NEON)
+    const uint8x8_t vFgR = vdup_n_u8(fgR);
+    const uint8x8_t vFgG = vdup_n_u8(fgG);
+    const uint8x8_t vFgB = vdup_n_u8(fgB);
+    const uint8x8_t vMax = vdup_n_u8(0xff);
+
+    // Deinterleave 8 pixels into B,G,R,X planes; vraddhn(t, t >> 8 rounded) is the exact /255
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t px = vld4_u8((const uint8_t *)(dst + i));
+        uint8x8_t a = vld1_u8(src + i);
+        uint8x8_t inv = vsub_u8(vMax, a);
+        uint16x8_t t;
+
+        t = vmlal_u8(vmull_u8(px.val[0], inv), vFgB, a);
+        px.val[0] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        t = vmlal_u8(vmull_u8(px.val[1], inv), vFgG, a);
+        px.val[1] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        t = vmlal_u8(vmull_u8(px.val[2], inv), vFgR, a);
+        px.val[2] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        t = vmlal_u8(vmull_u8(px.val[3], inv), vMax, a);
+        px.val[3] = vraddhn_u16(t, vrshrq_n_u16(t, 8));
+        vst4_u8((uint8_t *)(dst + i), px);
+    }
+#elif defined(PK_USE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vMax = _mm_set1_epi16(255);
+    const __m128i vRound = _mm_set1_epi16(128);
+    const __m128i vFg = _mm_unpacklo_epi8(_mm_set1_epi32((int)(color | 0xff000000)), zero);
+
+    // 4 pixels per step, 2 pixels per 16-bit register half
+    for (; i + 4 <= count; i += 4) {
+        uint32_t cov4;
+        __m128i d, a, aLo, aHi, dLo, dHi, tLo, tHi;
+
+        memcpy(&cov4, src + i, sizeof(cov4));
+        if (cov4 == 0) {
+            continue;
+        }
+        d = _mm_loadu_si128((const __m128i *)(dst + i));
+        a = _mm_cvtsi32_si128((int)cov4);
+        a = _mm_unpacklo_epi8(a, a);
+        a = _mm_unpacklo_epi16(a, a);       // each coverage byte repeated for the 4 channels
+        aLo = _mm_unpacklo_epi8(a, zero);
+        aHi = _mm_unpackhi_epi8(a, zero);
+        dLo = _mm_unpacklo_epi8(d, zero);
+        dHi = _mm_unpackhi_epi8(d, zero);
+
+        tLo = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(vFg, aLo), _mm_mullo_epi16(dLo, _mm_sub_epi16(vMax, aLo))), vRound);
+        tHi = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(vFg, aHi), _mm_mullo_epi16(dHi, _mm_sub_epi16(vMax, aHi))), vRound);
+        tLo = _mm_srli_epi16(_mm_add_epi16(tLo, _mm_srli_epi16(tLo, 8)), 8);
+        tHi = _mm_srli_epi16(_mm_add_epi16(tHi, _mm_srli_epi16(tHi, 8)), 8);
+
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(tLo, tHi));
+    }
+#endif
+
+    for (; i < count; i++) {
+        uint32_t a = src[i];
+        uint32_t bg = dst[i];
+
+        if (a == 0) {
+            continue;
+        }
+        dst[i] = (pkBlendChannel(0xff, bg >> 24, a) << 24)
+               | (pkBlendChannel(fgR, (bg >> 16) & 0xff, a) << 16)
+               | (pkBlendChannel(fgG, (bg >> 8) & 0xff, a) << 8)
+               | pkBlendChannel(fgB, bg & 0xff, a);
+    }
+}
+
+
+void pkFillRgbx(uint32_t *dst, int count, uint32_t value) {
+    int i = 0;
+
+#if defined(PK_USE_NEON)
+    const uint32x4_t v = vdupq_n_u32(value);
+
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u32(dst + i, v);
+        vst1q_u32(dst + i + 4, v);
+    }
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u32(dst + i, v);
+    }
+#elif defined(PK_USE_AVX2)
+    const __m256i v = _mm256_set1_epi32((int)value);
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i *)(dst + i), v);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i *)(dst + i), _mm256_castsi256_si128(v));
+    }
+#elif defined(PK_USE_SSE2)
+    const __m128i v = _mm_set1_epi32((int)value);
+
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+        _mm_storeu_si128((__m128i *)(dst + i + 4), v);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = value;
+    }
+}
+
+
+void pkRotate180Rgbx(void *pixels, int width, int height, int stride) {
+    uint8_t *top = (uint8_t *)pixels;
+    uint8_t *bottom = top + (size_t)(height - 1) * stride;
+
+    for (; top < bottom; top += stride, bottom -= stride) {
+        pkSwapMirrored((uint32_t *)top, (uint32_t *)bottom, width);
+    }
+    if (top == bottom) {
+        pkMirrorRow((uint32_t *)top, width);
+    }
+}
+
+
+void pkRotate90Rgbx(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride) {
+    pkRotate90((const uint8_t *)src, srcWidth, srcHeight, srcStride, (uint8_t *)dst, dstStride, 1);
+}
+
+
+void pkRotate270Rgbx(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride) {
+    pkRotate90((const uint8_t *)src, srcWidth, srcHeight, srcStride, (uint8_t *)dst, dstStride, 0);
+}
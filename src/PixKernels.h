@@ -0,0 +1,38 @@
+/*
+ * PixKernels.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Row oriented pixel kernels used by the text and image compositing paths.
+ *  Each kernel has a NEON (aarch64), SSE2/AVX2 (x86) and a scalar implementation,
+ *  selected at compile time.
+ */
+
+#ifndef SRC_PIXKERNELS_H_
+#define SRC_PIXKERNELS_H_
+
+#include <stdint.h>
+
+/* Expands count 8-bit coverage values into opaque gray RGBX8888 pixels (0xffCCCCCC). */
+void pkCoverageToRgbx(uint32_t *dst, const uint8_t *src, int count);
+
+/* Blends count pixels of color (0x00RRGGBB, taken as opaque) over the RGBX8888 pixels in dst,
+ * using the 8-bit coverage values as alpha. Zero coverage leaves the destination untouched. */
+void pkBlendCoverageRgbx(uint32_t *dst, const uint8_t *src, int count, uint32_t color);
+
+/* Sets count RGBX8888 pixels to value. */
+void pkFillRgbx(uint32_t *dst, int count, uint32_t value);
+
+/* Rotates a width x height RGBX8888 image by 180 degrees in place. stride is in bytes. */
+void pkRotate180Rgbx(void *pixels, int width, int height, int stride);
+
+/* Rotates a srcWidth x srcHeight RGBX8888 image by 90 degrees clockwise (270: counterclockwise) into
+ * dst, which is srcHeight pixels wide and srcWidth rows high. Strides are in bytes; src and dst must not overlap. */
+void pkRotate90Rgbx(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride);
+void pkRotate270Rgbx(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride);
+
+/* Name of the kernel variant compiled in, for logs and benchmarks. */
+const char *pkKernelVariant(void);
+
+#endif /* SRC_PIXKERNELS_H_ */
@@ -0,0 +1,430 @@
+/*
+ * PixScale.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file PixScale.c
+ *
+ *  @brief Software RGBX8888 scaler: nearest, bilinear and area averaging.
+ *
+ *  All filters work row by row in the output: per output column source positions
+ *  are computed once, then each output row is a gather, a blend of two horizontally
+ *  scaled source rows, or a box sum of the source rows it covers. 16.16 fixed point.
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "PixScale.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define PS_USE_NEON
+#elif defined(__AVX2__)
+ #include <immintrin.h>
+ #define PS_USE_AVX2
+ #define PS_USE_SSE2
+#elif defined(__SSE2__)
+ #include <emmintrin.h>
+ #define PS_USE_SSE2
+#endif
+
+#define PS_ROW(base, stride, y) ((uint32_t *)((uint8_t *)(base) + (size_t)(y) * (stride)))
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+// Scaled column/row of output index i, left-right mirrored if asked for
+static inline int psScaledColumn(const psScaleParams *p, int i) {
+    int c = p->outX + i;
+    return p->mirror ? p->scaledWidth - 1 - c : c;
+}
+
+// Source position, 16.16, of the center of scaled pixel index: (index + 0.5 + shift / 256) * srcSize / scaledSize - 0.5
+static inline int64_t psSourcePos(int index, int srcSize, int scaledSize, int shift256) {
+    return (((int64_t)index * 256 + 128 + shift256) * srcSize * 256) / scaledSize - 32768;
+}
+
+// Two source taps and the 8 bit weight of the second, clamped to the image edges
+static inline void psLinearTaps(int64_t pos, int srcSize, int *pIdx0, int *pIdx1, uint32_t *pFrac) {
+    int idx;
+
+    if (pos <= 0) {
+        *pIdx0 = 0;
+        *pIdx1 = 0;
+        *pFrac = 0;
+        return;
+    }
+    idx = (int)(pos >> 16);
+    if (idx >= srcSize - 1) {
+        *pIdx0 = srcSize - 1;
+        *pIdx1 = srcSize - 1;
+        *pFrac = 0;
+        return;
+    }
+    *pIdx0 = idx;
+    *pIdx1 = idx + 1;
+    *pFrac = (uint32_t)(pos & 0xffff) >> 8;
+}
+
+// (a * (256 - f) + b * f) / 256 on all 4 channels, two at a time in 16 bit lanes of a word
+static inline uint32_t psLerp(uint32_t a, uint32_t b, uint32_t f) {
+    uint32_t rb = (((a & 0x00ff00ffu) * (256 - f) + (b & 0x00ff00ffu) * f) >> 8) & 0x00ff00ffu;
+    uint32_t ag = (((a >> 8) & 0x00ff00ffu) * (256 - f) + ((b >> 8) & 0x00ff00ffu) * f) & 0xff00ff00u;
+    return rb | ag;
+}
+
+// dst[i] = srcRow[xIdx[i]]
+static void psGatherRow(uint32_t *dst, const uint32_t *srcRow, const int *xIdx, int count) {
+    int i = 0;
+
+#if defined(PS_USE_AVX2)
+    for (; i + 8 <= count; i += 8) {
+        __m256i idx = _mm256_loadu_si256((const __m256i *)(xIdx + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_i32gather_epi32((const int *)srcRow, idx, 4));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = srcRow[xIdx[i]];
+    }
+}
+
+// Vertical bilinear step: dst = row0 * (256 - f) + row1 * f, per channel
+static void psBlendRows(uint32_t *dst, const uint32_t *row0, const uint32_t *row1, int count, uint32_t f) {
+    int i = 0;
+
+#if defined(PS_USE_NEON)
+    const uint16_t w0 = (uint16_t)(256 - f);
+    const uint16_t w1 = (uint16_t)f;
+
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t a = vld1q_u8((const uint8_t *)(row0 + i));
+        uint8x16_t b = vld1q_u8((const uint8_t *)(row1 + i));
+        uint16x8_t lo = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(a)), w0), vmovl_u8(vget_low_u8(b)), w1);
+        uint16x8_t hi = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(a)), w0), vmovl_u8(vget_high_u8(b)), w1);
+        vst1q_u8((uint8_t *)(dst + i), vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+#elif defined(PS_USE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w0 = _mm_set1_epi16((short)(256 - f));
+    const __m128i w1 = _mm_set1_epi16((short)f);
+
+    // Products stay below 256 * 255, so the low 16 bits of the unsigned multiply are exact
+    for (; i + 4 <= count; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(row0 + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(row1 + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0), _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = psLerp(row0[i], row1[i], f);
+    }
+}
+
+// colSum[4 * i + channel] += channel of srcRow[i]
+static void psAccumulateRow(uint32_t *colSum, const uint32_t *srcRow, int count) {
+    const uint8_t *pBytes = (const uint8_t *)srcRow;
+    int i = 0;
+
+#if defined(PS_USE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t px = vld1q_u8(pBytes + (size_t)i * 4);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(px));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(px));
+        uint32_t *pSum = colSum + (size_t)i * 4;
+
+        vst1q_u32(pSum, vaddw_u16(vld1q_u32(pSum), vget_low_u16(lo)));
+        vst1q_u32(pSum + 4, vaddw_u16(vld1q_u32(pSum + 4), vget_high_u16(lo)));
+        vst1q_u32(pSum + 8, vaddw_u16(vld1q_u32(pSum + 8), vget_low_u16(hi)));
+        vst1q_u32(pSum + 12, vaddw_u16(vld1q_u32(pSum + 12), vget_high_u16(hi)));
+    }
+#elif defined(PS_USE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i *)(pBytes + (size_t)i * 4));
+        __m128i lo = _mm_unpacklo_epi8(px, zero);
+        __m128i hi = _mm_unpackhi_epi8(px, zero);
+        __m128i *pSum = (__m128i *)(colSum + (size_t)i * 4);
+
+        _mm_storeu_si128(pSum, _mm_add_epi32(_mm_loadu_si128(pSum), _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(pSum + 1, _mm_add_epi32(_mm_loadu_si128(pSum + 1), _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(pSum + 2, _mm_add_epi32(_mm_loadu_si128(pSum + 2), _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(pSum + 3, _mm_add_epi32(_mm_loadu_si128(pSum + 3), _mm_unpackhi_epi16(hi, zero)));
+    }
+#endif
+    for (; i < count; i++) {
+        colSum[i * 4]     += pBytes[i * 4];
+        colSum[i * 4 + 1] += pBytes[i * 4 + 1];
+        colSum[i * 4 + 2] += pBytes[i * 4 + 2];
+        colSum[i * 4 + 3] += pBytes[i * 4 + 3];
+    }
+}
+
+static int psScaleNearest(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride, const psScaleParams *p) {
+    const int identity = !p->mirror && (p->scaledWidth == srcWidth);
+    int *xIdx;
+    int64_t pos;
+    int prevSy = -1;
+    int x, y, sy;
+
+    xIdx = malloc(sizeof(int) * p->outWidth);
+    if (xIdx == NULL) {
+        return -2;
+    }
+    for (x = 0; x < p->outWidth; x++) {
+        xIdx[x] = (int)(((int64_t)psScaledColumn(p, x) * 2 + 1) * srcWidth / (2 * (int64_t)p->scaledWidth));
+        if (xIdx[x] >= srcWidth) {
+            xIdx[x] = srcWidth - 1;
+        }
+    }
+
+    for (y = 0; y < p->outHeight; y++) {
+        uint32_t *pDstRow = PS_ROW(dst, dstStride, y);
+
+        pos = (((int64_t)(p->outY + y) * 256 + 128 + p->shiftY) * srcHeight) / (256 * (int64_t)p->scaledHeight);
+        sy = (pos < 0) ? 0 : ((pos >= srcHeight) ? srcHeight - 1 : (int)pos);
+        if (sy == prevSy) {
+            // Upscaling repeats source rows: copy the row just produced
+            memcpy(pDstRow, PS_ROW(dst, dstStride, y - 1), (size_t)p->outWidth * 4);
+        } else if (identity) {
+            memcpy(pDstRow, PS_ROW(src, srcStride, sy) + p->outX, (size_t)p->outWidth * 4);
+        } else {
+            psGatherRow(pDstRow, PS_ROW(src, srcStride, sy), xIdx, p->outWidth);
+        }
+        prevSy = sy;
+    }
+
+    free(xIdx);
+    return 0;
+}
+
+// One source row scaled horizontally into rowBuf
+static void psBilinearRowH(uint32_t *rowBuf, const uint32_t *srcRow, const int *xIdx0, const int *xIdx1, const uint32_t *xFrac, int count) {
+    int x;
+
+    for (x = 0; x < count; x++) {
+        rowBuf[x] = (xFrac[x] == 0) ? srcRow[xIdx0[x]] : psLerp(srcRow[xIdx0[x]], srcRow[xIdx1[x]], xFrac[x]);
+    }
+}
+
+static int psScaleBilinear(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride, const psScaleParams *p) {
+    const int identity = !p->mirror && (p->scaledWidth == srcWidth);
+    int *xIdx0, *xIdx1;
+    uint32_t *xFrac;
+    uint32_t *rowBuf[2];
+    int cacheSy[2] = {-1, -1};
+    int slotA, slotB;
+    int sy0, sy1;
+    uint32_t fy;
+    int x, y;
+
+    xIdx0 = malloc(sizeof(int) * p->outWidth);
+    xIdx1 = malloc(sizeof(int) * p->outWidth);
+    xFrac = malloc(sizeof(uint32_t) * p->outWidth);
+    rowBuf[0] = malloc(sizeof(uint32_t) * p->outWidth);
+    rowBuf[1] = malloc(sizeof(uint32_t) * p->outWidth);
+    if ((xIdx0 == NULL) || (xIdx1 == NULL) || (xFrac == NULL) || (rowBuf[0] == NULL) || (rowBuf[1] == NULL)) {
+        free(xIdx0);
+        free(xIdx1);
+        free(xFrac);
+        free(rowBuf[0]);
+        free(rowBuf[1]);
+        return -2;
+    }
+    for (x = 0; x < p->outWidth; x++) {
+        psLinearTaps(psSourcePos(psScaledColumn(p, x), srcWidth, p->scaledWidth, 0), srcWidth, &xIdx0[x], &xIdx1[x], &xFrac[x]);
+    }
+
+    for (y = 0; y < p->outHeight; y++) {
+        uint32_t *pDstRow = PS_ROW(dst, dstStride, y);
+
+        psLinearTaps(psSourcePos(p->outY + y, srcHeight, p->scaledHeight, p->shiftY), srcHeight, &sy0, &sy1, &fy);
+
+        // Horizontally scaled source rows are kept for the next output row, which usually needs one or both again
+        slotA = (cacheSy[0] == sy0) ? 0 : ((cacheSy[1] == sy0) ? 1 : -1);
+        if (slotA < 0) {
+            slotA = (cacheSy[0] == sy1) ? 1 : 0;
+            if (identity) {
+                memcpy(rowBuf[slotA], PS_ROW(src, srcStride, sy0) + p->outX, (size_t)p->outWidth * 4);
+            } else {
+                psBilinearRowH(rowBuf[slotA], PS_ROW(src, srcStride, sy0), xIdx0, xIdx1, xFrac, p->outWidth);
+            }
+            cacheSy[slotA] = sy0;
+        }
+        if (fy == 0) {
+            memcpy(pDstRow, rowBuf[slotA], (size_t)p->outWidth * 4);
+            continue;
+        }
+        slotB = 1 - slotA;
+        if (cacheSy[slotB] != sy1) {
+            if (identity) {
+                memcpy(rowBuf[slotB], PS_ROW(src, srcStride, sy1) + p->outX, (size_t)p->outWidth * 4);
+            } else {
+                psBilinearRowH(rowBuf[slotB], PS_ROW(src, srcStride, sy1), xIdx0, xIdx1, xFrac, p->outWidth);
+            }
+            cacheSy[slotB] = sy1;
+        }
+        psBlendRows(pDstRow, rowBuf[slotA], rowBuf[slotB], p->outWidth, fy);
+    }
+
+    free(xIdx0);
+    free(xIdx1);
+    free(xFrac);
+    free(rowBuf[0]);
+    free(rowBuf[1]);
+    return 0;
+}
+
+// Source span [*pStart, *pEnd) covered by scaled pixel index, at least one pixel
+static inline void psAreaSpan(int index, int srcSize, int scaledSize, int *pStart, int *pEnd) {
+    *pStart = (int)((int64_t)index * srcSize / scaledSize);
+    *pEnd = (int)(((int64_t)index + 1) * srcSize / scaledSize);
+    if (*pEnd <= *pStart) {
+        *pEnd = *pStart + 1;
+    }
+}
+
+static int psScaleArea(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride, const psScaleParams *p) {
+    int *xStart, *xEnd;
+    uint32_t *colSum;
+    uint32_t sum[4];
+    uint64_t *recip;
+    int colFirst, colLast;
+    int maxSpanX = 1;
+    int spanY = 0;
+    int sy0, sy1;
+    int x, y, sx, sy, c;
+
+    xStart = malloc(sizeof(int) * p->outWidth);
+    xEnd = malloc(sizeof(int) * p->outWidth);
+    colSum = malloc(sizeof(uint32_t) * 4 * srcWidth);
+    if ((xStart == NULL) || (xEnd == NULL) || (colSum == NULL)) {
+        free(xStart);
+        free(xEnd);
+        free(colSum);
+        return -2;
+    }
+    colFirst = srcWidth;
+    colLast = 0;
+    for (x = 0; x < p->outWidth; x++) {
+        psAreaSpan(psScaledColumn(p, x), srcWidth, p->scaledWidth, &xStart[x], &xEnd[x]);
+        if (xStart[x] < colFirst) colFirst = xStart[x];
+        if (xEnd[x] > colLast) colLast = xEnd[x];
+        if (xEnd[x] - xStart[x] > maxSpanX) maxSpanX = xEnd[x] - xStart[x];
+    }
+    // Division by the pixel count as a 24 bit reciprocal multiply, one reciprocal per column span width
+    recip = malloc(sizeof(uint64_t) * (maxSpanX + 1));
+    if (recip == NULL) {
+        free(xStart);
+        free(xEnd);
+        free(colSum);
+        return -2;
+    }
+
+    for (y = 0; y < p->outHeight; y++) {
+        uint8_t *pDstRow = (uint8_t *)PS_ROW(dst, dstStride, y);
+
+        // Column sums over the rows this output row covers, only for the columns the output reads
+        psAreaSpan(p->outY + y, srcHeight, p->scaledHeight, &sy0, &sy1);
+        if (sy1 - sy0 != spanY) {
+            spanY = sy1 - sy0;
+            for (sx = 1; sx <= maxSpanX; sx++) {
+                recip[sx] = ((1ULL << 24) + (uint64_t)sx * spanY / 2) / ((uint64_t)sx * spanY);
+            }
+        }
+        memset(colSum + (size_t)colFirst * 4, 0, sizeof(uint32_t) * 4 * (colLast - colFirst));
+        for (sy = sy0; sy < sy1; sy++) {
+            psAccumulateRow(colSum + (size_t)colFirst * 4, PS_ROW(src, srcStride, sy) + colFirst, colLast - colFirst);
+        }
+
+        for (x = 0; x < p->outWidth; x++) {
+#if defined(PS_USE_NEON)
+            uint32x4_t vSum = vdupq_n_u32(0);
+            for (sx = xStart[x]; sx < xEnd[x]; sx++) {
+                vSum = vaddq_u32(vSum, vld1q_u32(colSum + (size_t)sx * 4));
+            }
+            vst1q_u32(sum, vSum);
+#elif defined(PS_USE_SSE2)
+            __m128i vSum = _mm_setzero_si128();
+            for (sx = xStart[x]; sx < xEnd[x]; sx++) {
+                vSum = _mm_add_epi32(vSum, _mm_loadu_si128((const __m128i *)(colSum + (size_t)sx * 4)));
+            }
+            _mm_storeu_si128((__m128i *)sum, vSum);
+#else
+            sum[0] = sum[1] = sum[2] = sum[3] = 0;
+            for (sx = xStart[x]; sx < xEnd[x]; sx++) {
+                sum[0] += colSum[sx * 4];
+                sum[1] += colSum[sx * 4 + 1];
+                sum[2] += colSum[sx * 4 + 2];
+                sum[3] += colSum[sx * 4 + 3];
+            }
+#endif
+            for (c = 0; c < 4; c++) {
+                uint64_t v = (sum[c] * recip[xEnd[x] - xStart[x]] + (1u << 23)) >> 24;
+                pDstRow[x * 4 + c] = (v > 255) ? 255 : (uint8_t)v;
+            }
+        }
+    }
+
+    free(xStart);
+    free(xEnd);
+    free(colSum);
+    free(recip);
+    return 0;
+}
+
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+ePsFilters psAutoFilter(int srcWidth, int srcHeight, int scaledWidth, int scaledHeight) {
+    if ((scaledWidth * 2 <= srcWidth) && (scaledHeight * 2 <= srcHeight)) {
+        return ePsFilter_AREA;
+    }
+    return ePsFilter_BILINEAR;
+}
+
+const char *psFilterName(ePsFilters filter) {
+    switch (filter) {
+        case ePsFilter_NEAREST:
+            return "nearest";
+        case ePsFilter_BILINEAR:
+            return "bilinear";
+        case ePsFilter_AREA:
+            return "area";
+        default:
+            return "unknown";
+    }
+}
+
+int psScaleRgbx(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride, const psScaleParams *pParams) {
+    if ((src == NULL) || (dst == NULL) || (srcWidth <= 0) || (srcHeight <= 0) ||
+        (pParams->scaledWidth <= 0) || (pParams->scaledHeight <= 0) || (pParams->outWidth <= 0) || (pParams->outHeight <= 0) ||
+        (pParams->outX < 0) || (pParams->outY < 0) ||
+        (pParams->outX + pParams->outWidth > pParams->scaledWidth) || (pParams->outY + pParams->outHeight > pParams->scaledHeight)) {
+        return -1;
+    }
+
+    switch (pParams->filter) {
+        case ePsFilter_NEAREST:
+            return psScaleNearest(src, srcWidth, srcHeight, srcStride, dst, dstStride, pParams);
+        case ePsFilter_BILINEAR:
+            return psScaleBilinear(src, srcWidth, srcHeight, srcStride, dst, dstStride, pParams);
+        case ePsFilter_AREA:
+            return psScaleArea(src, srcWidth, srcHeight, srcStride, dst, dstStride, pParams);
+        default:
+            return -1;
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * PixScale.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Software image scaler for RGBX8888 images: nearest, bilinear and area averaging,
+ *  with an optional left-right mirror and a vertical sub-row sampling shift.
+ *  Used when the backend's blit scaling is slow, unavailable, or cannot do what
+ *  the scale/mirror mode asks for. Vertical passes have NEON/SSE2 variants, the
+ *  nearest gather an AVX2 one, selected at compile time like PixKernels.
+ */
+
+#ifndef SRC_PIXSCALE_H_
+#define SRC_PIXSCALE_H_
+
+#include <stdint.h>
+
+typedef enum {
+  ePsFilter_NEAREST = 0,
+  ePsFilter_BILINEAR,
+  ePsFilter_AREA               /* Box average of all covered source pixels, for heavy downscaling */
+} ePsFilters;
+
+typedef struct {
+  int scaledWidth;             /* Size of the whole scaled image */
+  int scaledHeight;
+  int outX, outY;              /* Part of the scaled image written to dst, which is outWidth x outHeight */
+  int outWidth, outHeight;
+  int mirror;                  /* Non-zero: flipped left to right */
+  int shiftY;                  /* Sampling offset in 1/256 of a scaled row, positive moves the image up. Not used by AREA */
+  ePsFilters filter;
+} psScaleParams;
+
+/* Filter for a given scale: AREA when shrinking to half or less on both axes, else BILINEAR. */
+ePsFilters psAutoFilter(int srcWidth, int srcHeight, int scaledWidth, int scaledHeight);
+
+/* Scales the srcWidth x srcHeight image in src into dst as pParams describes. Strides are in bytes.
+ * Returns 0, -1 on invalid parameters, -2 if out of memory. */
+int psScaleRgbx(const void *src, int srcWidth, int srcHeight, int srcStride, void *dst, int dstStride, const psScaleParams *pParams);
+
+const char *psFilterName(ePsFilters filter);
+
+#endif /* SRC_PIXSCALE_H_ */
@@ -0,0 +1,319 @@
+/*
+ * Trace.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file Trace.c
+ *
+ *  @brief Timing spans with Chrome trace_event JSON export.
+ *
+ *  Spans are appended to a preallocated array with one atomic increment; the name is
+ *  stored last, so a dump running concurrently (from a signal handler) skips entries
+ *  still being filled. The dump only uses write() and its own number formatting.
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "Trace.h"
+
+
+/******************************************************************************
+  Macro Definitions
+ ******************************************************************************/
+#define TRC_MAX_THREADS     32
+#define TRC_DUMP_CHUNK      4096
+
+/******************************************************************************
+  Type Definitions
+ ******************************************************************************/
+typedef struct {
+  _Atomic(const char *) name;   /* NULL until the entry is complete */
+  uint64_t start;               /* ns */
+  uint64_t duration;            /* ns */
+  int tid;
+  char phase;                   /* 'X' span, 'i' instant */
+} trcEvent;
+
+typedef struct {
+  int fd;
+  size_t fill;
+  char data[TRC_DUMP_CHUNK];
+} trcOut;
+
+/******************************************************************************
+  File Scope Variables
+ ******************************************************************************/
+static trcEvent *trcEvents = NULL;
+static atomic_uint trcEventCount;
+static atomic_uint trcDropped;
+static atomic_int trcNextTid = 1;
+static _Thread_local int trcTid = 0;
+static const char *trcThreadNames[TRC_MAX_THREADS];
+static char trcFileName[256];
+static volatile sig_atomic_t trcDumping = 0;
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+static int trcThreadId(void) {
+  if (trcTid == 0) {
+    trcTid = atomic_fetch_add(&trcNextTid, 1);
+  }
+  return trcTid;
+}
+
+static void trcAdd(const char *name, char phase, uint64_t start, uint64_t duration) {
+  unsigned int index;
+
+  index = atomic_fetch_add_explicit(&trcEventCount, 1, memory_order_relaxed);
+  if (index >= TRC_MAX_EVENTS) {
+    atomic_store_explicit(&trcEventCount, TRC_MAX_EVENTS, memory_order_relaxed);
+    atomic_fetch_add_explicit(&trcDropped, 1, memory_order_relaxed);
+    return;
+  }
+  trcEvents[index].start = start;
+  trcEvents[index].duration = duration;
+  trcEvents[index].tid = trcThreadId();
+  trcEvents[index].phase = phase;
+  atomic_store_explicit(&(trcEvents[index].name), name, memory_order_release);
+}
+
+static void trcFlush(trcOut *pOut) {
+  size_t done = 0;
+  ssize_t written;
+
+  while (done < pOut->fill) {
+    written = write(pOut->fd, pOut->data + done, pOut->fill - done);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    done += (size_t)written;
+  }
+  pOut->fill = 0;
+}
+
+static void trcPutChar(trcOut *pOut, char c) {
+  if (pOut->fill >= sizeof(pOut->data)) {
+    trcFlush(pOut);
+  }
+  pOut->data[pOut->fill++] = c;
+}
+
+static void trcPutRaw(trcOut *pOut, const char *str) {
+  for (; *str != 0; str++) {
+    trcPutChar(pOut, *str);
+  }
+}
+
+// JSON string body: names are literals, but quotes and control characters are escaped anyway
+static void trcPutStr(trcOut *pOut, const char *str) {
+  for (; *str != 0; str++) {
+    if ((*str == '"') || (*str == '\\')) {
+      trcPutChar(pOut, '\\');
+      trcPutChar(pOut, *str);
+    } else if ((unsigned char)*str < 0x20) {
+      trcPutChar(pOut, ' ');
+    } else {
+      trcPutChar(pOut, *str);
+    }
+  }
+}
+
+static void trcPutU64(trcOut *pOut, uint64_t value) {
+  char digits[20];
+  int count = 0;
+
+  do {
+    digits[count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  while (count > 0) {
+    trcPutChar(pOut, digits[--count]);
+  }
+}
+
+// Chrome timestamps are in microseconds; the fraction keeps the ns
+static void trcPutUs(trcOut *pOut, uint64_t ns) {
+  uint64_t frac = ns % 1000;
+
+  trcPutU64(pOut, ns / 1000);
+  trcPutChar(pOut, '.');
+  trcPutChar(pOut, (char)('0' + frac / 100));
+  trcPutChar(pOut, (char)('0' + (frac / 10) % 10));
+  trcPutChar(pOut, (char)('0' + frac % 10));
+}
+
+static void trcPutEventHead(trcOut *pOut, int *pFirst, const char *name, char phase, int tid) {
+  if (!*pFirst) {
+    trcPutChar(pOut, ',');
+  }
+  *pFirst = 0;
+  trcPutRaw(pOut, "\n{\"name\":\"");
+  trcPutStr(pOut, name);
+  trcPutRaw(pOut, "\",\"ph\":\"");
+  trcPutChar(pOut, phase);
+  trcPutRaw(pOut, "\",\"pid\":1,\"tid\":");
+  trcPutU64(pOut, (uint64_t)tid);
+}
+
+static void trcSignalDump(int sig) {
+  int savedErrno = errno;
+
+  trcDump();
+  if (sig != SIGUSR1) {
+    //Dumped; now terminate as the signal would have
+    signal(sig, SIG_DFL);
+    raise(sig);
+  }
+  errno = savedErrno;
+}
+
+static void trcExitDump(void) {
+  trcDump();
+}
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+int trcStart(const char *fileName) {
+  struct sigaction action;
+
+  if (trcEvents != NULL) {
+    return 0;
+  }
+  strncpy(trcFileName, fileName, sizeof(trcFileName) - 1);
+  trcFileName[sizeof(trcFileName) - 1] = 0;
+  trcEvents = calloc(TRC_MAX_EVENTS, sizeof(trcEvent));
+  if (trcEvents == NULL) {
+    log_message(LOG_ERROR, "trcStart: no memory for %d trace events", TRC_MAX_EVENTS);
+    return -1;
+  }
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = trcSignalDump;
+  sigemptyset(&(action.sa_mask));
+  action.sa_flags = SA_RESTART;
+  if ((sigaction(SIGUSR1, &action, NULL) != 0) || (sigaction(SIGTERM, &action, NULL) != 0) || (sigaction(SIGINT, &action, NULL) != 0)) {
+    log_message(LOG_WARNING, "trcStart: sigaction() failed, the trace is only written at exit");
+  }
+  atexit(trcExitDump);
+  log_message(LOG_INFO, "Tracing into %s (kill -USR1 %d writes it without stopping)", trcFileName, (int)getpid());
+
+  return 0;
+}
+
+uint64_t trcNow(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+uint64_t trcBegin(void) {
+  return (trcEvents != NULL) ? trcNow() : 0;
+}
+
+void trcEnd(const char *name, uint64_t start) {
+  if ((trcEvents != NULL) && (start != 0)) {
+    trcAdd(name, 'X', start, trcNow() - start);
+  }
+}
+
+void trcSpan(const char *name, uint64_t start, uint64_t end) {
+  if ((trcEvents != NULL) && (start != 0) && (end >= start)) {
+    trcAdd(name, 'X', start, end - start);
+  }
+}
+
+void trcInstant(const char *name) {
+  if (trcEvents != NULL) {
+    trcAdd(name, 'i', trcNow(), 0);
+  }
+}
+
+void trcThreadName(const char *name) {
+  int tid;
+
+  if (trcEvents != NULL) {
+    tid = trcThreadId();
+    if (tid < TRC_MAX_THREADS) {
+      trcThreadNames[tid] = name;
+    }
+  }
+}
+
+int trcDump(void) {
+  static trcOut out;
+  unsigned int count;
+  unsigned int i;
+  const char *name;
+  int first = 1;
+
+  if ((trcEvents == NULL) || trcDumping) {
+    return -1;
+  }
+  trcDumping = 1;
+  out.fd = open(trcFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (out.fd < 0) {
+    trcDumping = 0;
+    return -2;
+  }
+  out.fill = 0;
+
+  trcPutRaw(&out, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":");
+  trcPutU64(&out, atomic_load_explicit(&trcDropped, memory_order_relaxed));
+  trcPutRaw(&out, "},\"traceEvents\":[");
+  for (i = 1; i < TRC_MAX_THREADS; i++) {
+    if (trcThreadNames[i] != NULL) {
+      trcPutEventHead(&out, &first, "thread_name", 'M', (int)i);
+      trcPutRaw(&out, ",\"args\":{\"name\":\"");
+      trcPutStr(&out, trcThreadNames[i]);
+      trcPutRaw(&out, "\"}}");
+    }
+  }
+  count = atomic_load_explicit(&trcEventCount, memory_order_relaxed);
+  if (count > TRC_MAX_EVENTS) {
+    count = TRC_MAX_EVENTS;
+  }
+  for (i = 0; i < count; i++) {
+    name = atomic_load_explicit(&(trcEvents[i].name), memory_order_acquire);
+    if (name == NULL) {
+      continue;
+    }
+    trcPutEventHead(&out, &first, name, trcEvents[i].phase, trcEvents[i].tid);
+    trcPutRaw(&out, ",\"ts\":");
+    trcPutUs(&out, trcEvents[i].start);
+    if (trcEvents[i].phase == 'X') {
+      trcPutRaw(&out, ",\"dur\":");
+      trcPutUs(&out, trcEvents[i].duration);
+    } else {
+      trcPutRaw(&out, ",\"s\":\"p\"");
+    }
+    trcPutChar(&out, '}');
+  }
+  trcPutRaw(&out, "\n]}\n");
+  trcFlush(&out);
+  close(out.fd);
+  trcDumping = 0;
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * Trace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Timing spans for -trace=file.json. Each span is one entry in a buffer allocated by
+ *  trcStart(); nothing is allocated or written while tracing. The buffer is written
+ *  out as Chrome trace_event JSON (chrome://tracing, ui.perfetto.dev) at exit, on
+ *  SIGINT/SIGTERM, and on SIGUSR1 without stopping. Without trcStart() every call
+ *  returns at its first compare.
+ *
+ *    uint64_t start = trcBegin();
+ *    ...
+ *    trcEnd("bgrBlitImagePixmap", start);
+ */
+
+#ifndef SRC_TRACE_H_
+#define SRC_TRACE_H_
+
+#include <stdint.h>
+
+#define TRC_MAX_EVENTS  16384     /* Spans past this are counted, not stored */
+
+/* Allocates the span buffer and installs the dump on exit and on the signals. Returns 0 on success. */
+int trcStart(const char *fileName);
+
+/* CLOCK_MONOTONIC in ns, 0 when tracing is off. */
+uint64_t trcBegin(void);
+
+/* Records a span from start to now. name must stay valid, i.e. a string literal. */
+void trcEnd(const char *name, uint64_t start);
+
+/* Records a span from start to end, both from trcNow(). */
+void trcSpan(const char *name, uint64_t start, uint64_t end);
+
+/* Records a point in time, i.e. a startup stage. */
+void trcInstant(const char *name);
+
+/* Names the calling thread in the trace. */
+void trcThreadName(const char *name);
+
+/* CLOCK_MONOTONIC in ns. */
+uint64_t trcNow(void);
+
+/* Writes the spans recorded so far to the trace file. Async-signal-safe. */
+int trcDump(void);
+
+#endif /* SRC_TRACE_H_ */
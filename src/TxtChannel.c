@@ -0,0 +1,240 @@
+/*
+ * TxtChannel.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  @file TxtChannel.c
+ *
+ *  @brief Blocking text update channel over a UNIX domain socket.
+ *
+ *
+ ******************************************************************************
+*/
+
+/******************************************************************************
+  Depends
+ ******************************************************************************/
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "logger.h"
+#include "TxtChannel.h"
+
+
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+static void tcDropClient(tcChannel *pChannel, int slot) {
+  close(pChannel->clientFd[slot]);
+  pChannel->clientFd[slot] = -1;
+  pChannel->rxLen[slot] = 0;
+}
+
+static void tcAcceptClient(tcChannel *pChannel) {
+  int fd;
+  int slot;
+
+  fd = accept(pChannel->listenFd, NULL, NULL);
+  if (fd < 0) {
+    log_message(LOG_WARNING, "tcAcceptClient::accept() failed: %s", strerror(errno));
+    return;
+  }
+  for (slot = 0; slot < TC_MAX_CLIENTS; slot++) {
+    if (pChannel->clientFd[slot] < 0) {
+      pChannel->clientFd[slot] = fd;
+      pChannel->rxLen[slot] = 0;
+      log_message(LOG_DEBUG, "tcAcceptClient: client %d connected", slot);
+      return;
+    }
+  }
+  log_message(LOG_WARNING, "tcAcceptClient: more than %d clients, connection refused", TC_MAX_CLIENTS);
+  close(fd);
+}
+
+// Answers a query line on the client's socket. A client that has gone away is dropped.
+static void tcAnswerQuery(tcChannel *pChannel, int slot, const char *query) {
+  char reply[TC_MAX_REPLY];
+  int replyLength;
+  int done = 0;
+  ssize_t written;
+
+  replyLength = pChannel->queryHandler(query, reply, sizeof(reply));
+  while (done < replyLength) {
+    written = write(pChannel->clientFd[slot], reply + done, replyLength - done);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      log_message(LOG_WARNING, "tcAnswerQuery::write() to client %d failed: %s", slot, strerror(errno));
+      tcDropClient(pChannel, slot);
+      return;
+    }
+    done += (int)written;
+  }
+}
+
+// Reads what the client sent. Returns 1 if at least one complete line was stored in txtStr.
+static int tcReadClient(tcChannel *pChannel, int slot, char *txtStr, int maxTxtSize) {
+  char rxBuf[TC_MAX_LINE];
+  int gotLine = 0;
+  ssize_t rxBytes;
+  ssize_t i;
+
+  rxBytes = read(pChannel->clientFd[slot], rxBuf, sizeof(rxBuf));
+  if (rxBytes <= 0) {
+    if ((rxBytes < 0) && (errno == EINTR)) {
+      return 0;
+    }
+    log_message(LOG_DEBUG, "tcReadClient: client %d disconnected", slot);
+    tcDropClient(pChannel, slot);
+    return 0;
+  }
+
+  for (i = 0; i < rxBytes; i++) {
+    if (rxBuf[i] == '\n') {
+      // Only the most recent line matters, earlier ones are overwritten
+      if ((pChannel->rxLen[slot] > 0) && (pChannel->rxLine[slot][pChannel->rxLen[slot] - 1] == '\r')) {
+        pChannel->rxLen[slot]--;
+      }
+      pChannel->rxLine[slot][pChannel->rxLen[slot]] = 0;
+      pChannel->rxLen[slot] = 0;
+      if ((pChannel->queryHandler != NULL) && (pChannel->rxLine[slot][0] == TC_QUERY_PREFIX)) {
+        tcAnswerQuery(pChannel, slot, pChannel->rxLine[slot]);
+        if (pChannel->clientFd[slot] < 0) {
+          return gotLine;
+        }
+        continue;
+      }
+      strncpy(txtStr, pChannel->rxLine[slot], maxTxtSize - 1);
+      txtStr[maxTxtSize - 1] = 0;
+      gotLine = 1;
+    } else if (pChannel->rxLen[slot] < TC_MAX_LINE - 1) {
+      pChannel->rxLine[slot][pChannel->rxLen[slot]++] = rxBuf[i];
+    }
+    // Overlong lines are truncated
+  }
+
+  return gotLine;
+}
+
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+int tcOpen(tcChannel *pChannel, const char *path) {
+  struct sockaddr_un addr;
+  int slot;
+
+  memset(pChannel, 0, sizeof(tcChannel));
+  pChannel->listenFd = -1;
+  for (slot = 0; slot < TC_MAX_CLIENTS; slot++) {
+    pChannel->clientFd[slot] = -1;
+  }
+
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    log_message(LOG_ERROR, "tcOpen: socket path too long: %s", path);
+    return -1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, path, strlen(path) + 1);
+  strncpy(pChannel->path, path, sizeof(pChannel->path) - 1);
+
+  pChannel->listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (pChannel->listenFd < 0) {
+    log_message(LOG_ERROR, "tcOpen::socket() failed: %s", strerror(errno));
+    return -1;
+  }
+  // A client closing before its query is answered must fail the write(), not end the process
+  signal(SIGPIPE, SIG_IGN);
+  // A stale socket file from a previous run would make bind() fail
+  unlink(path);
+  if (bind(pChannel->listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    log_message(LOG_ERROR, "tcOpen::bind(%s) failed: %s", path, strerror(errno));
+    close(pChannel->listenFd);
+    pChannel->listenFd = -1;
+    return -2;
+  }
+  if (listen(pChannel->listenFd, TC_MAX_CLIENTS) != 0) {
+    log_message(LOG_ERROR, "tcOpen::listen() failed: %s", strerror(errno));
+    tcClose(pChannel);
+    return -3;
+  }
+
+  log_message(LOG_INFO, "tcOpen: listening for text updates on %s", path);
+  return 0;
+}
+
+void tcSetQueryHandler(tcChannel *pChannel, tcQueryHandler handler) {
+  pChannel->queryHandler = handler;
+}
+
+// Blocks until a complete text line arrives. Returns 0 with the new text in txtStr,
+// 1 if interrupted by a signal, or negative on error.
+int tcWaitText(tcChannel *pChannel, char *txtStr, int maxTxtSize) {
+  struct pollfd fds[TC_MAX_CLIENTS + 1];
+  int slotOfFd[TC_MAX_CLIENTS + 1];
+  int fdCount;
+  int gotLine = 0;
+  int slot;
+  int i;
+
+  while (!gotLine) {
+    fds[0].fd = pChannel->listenFd;
+    fds[0].events = POLLIN;
+    fdCount = 1;
+    for (slot = 0; slot < TC_MAX_CLIENTS; slot++) {
+      if (pChannel->clientFd[slot] >= 0) {
+        fds[fdCount].fd = pChannel->clientFd[slot];
+        fds[fdCount].events = POLLIN;
+        slotOfFd[fdCount] = slot;
+        fdCount++;
+      }
+    }
+
+    if (poll(fds, fdCount, -1) < 0) {
+      if (errno == EINTR) {
+        return 1;
+      }
+      log_message(LOG_ERROR, "tcWaitText::poll() failed: %s", strerror(errno));
+      return -1;
+    }
+
+    for (i = 1; i < fdCount; i++) {
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+        if (tcReadClient(pChannel, slotOfFd[i], txtStr, maxTxtSize)) {
+          gotLine = 1;
+        }
+      }
+    }
+    if (fds[0].revents & POLLIN) {
+      tcAcceptClient(pChannel);
+    }
+  }
+
+  return 0;
+}
+
+void tcClose(tcChannel *pChannel) {
+  int slot;
+
+  for (slot = 0; slot < TC_MAX_CLIENTS; slot++) {
+    if (pChannel->clientFd[slot] >= 0) {
+      tcDropClient(pChannel, slot);
+    }
+  }
+  if (pChannel->listenFd >= 0) {
+    close(pChannel->listenFd);
+    pChannel->listenFd = -1;
+    unlink(pChannel->path);
+  }
+}
@@ -0,0 +1,39 @@
+/*
+ * TxtChannel.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Text update channel: a UNIX domain stream socket. Clients connect and write
+ *  newline terminated text; every complete line replaces the displayed text.
+ *  With a query handler set, lines starting with TC_QUERY_PREFIX are not text: the
+ *  handler's reply is written back to the client that sent them.
+ *  Plain POSIX, so it runs the same on QNX and Linux.
+ */
+
+#ifndef SRC_TXTCHANNEL_H_
+#define SRC_TXTCHANNEL_H_
+
+#define TC_MAX_CLIENTS  4
+#define TC_MAX_LINE     256
+#define TC_QUERY_PREFIX '?'
+#define TC_MAX_REPLY    2048
+
+/* Fills reply (0 terminated) for the query line. Returns the reply length. */
+typedef int (*tcQueryHandler)(const char *query, char *reply, int maxReplySize);
+
+typedef struct {
+  int listenFd;
+  int clientFd[TC_MAX_CLIENTS];
+  char rxLine[TC_MAX_CLIENTS][TC_MAX_LINE];
+  int rxLen[TC_MAX_CLIENTS];
+  char path[TC_MAX_LINE];
+  tcQueryHandler queryHandler;
+} tcChannel;
+
+int tcOpen(tcChannel *pChannel, const char *path);
+void tcSetQueryHandler(tcChannel *pChannel, tcQueryHandler handler);
+int tcWaitText(tcChannel *pChannel, char *txtStr, int maxTxtSize);
+void tcClose(tcChannel *pChannel);
+
+#endif /* SRC_TXTCHANNEL_H_ */
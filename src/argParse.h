@@ -49,5 +49,6 @@ const char *get_parse_error_string(ParseResult result);
 int validate_file(const char *value);
 int validate_rotation(const char *value);
 int validate_scale(const char *value);
+int validate_scaler(const char *value);
 
 #endif // ARGPARSE_H
@@ -5,6 +5,14 @@
  *
  *  @brief Implementation of simple logging for console Linux/UNIX/QNX system.
  *
+ *  Messages above the verbosity never get here: log_message() compares the level
+ *  first. Accepted lines are formatted once into a single buffer and written with
+ *  one write(): by the caller, or, after log_async_start(), by a background thread
+ *  draining a lock-free queue, so a slow console never stalls the render loop.
+ *
+ *  After log_binary_start() messages are not formatted at all: a record holds the
+ *  format id, a timestamp and the raw arguments (see BgrLog.h), and tools/bgrLogDecode
+ *  turns the file back into text. Errors are still written as text to stderr too.
  *
  ******************************************************************************
 */
@@ -12,16 +20,72 @@
 /******************************************************************************
   Depends
  ******************************************************************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
 #include "logger.h"
+#include "BgrLog.h"
 
 
 /******************************************************************************
   Macro Definitions
  ******************************************************************************/
+#define LOG_QUEUE_SLOTS     256           /* Power of two */
+#define LOG_LINE_MAX        256           /* Longer lines are truncated */
+#define LOG_WRITE_CHUNK     4096          /* The writer batches lines into writes of up to this size */
+#define LOG_BLOCK_WAIT_NS   100000        /* LOG_OVERFLOW_BLOCK: poll interval while the queue is full */
+#define LOG_STOP_WAIT_POLLS 1000          /* log_async_stop(): at most this many LOG_BLOCK_WAIT_NS for claimed lines to be published */
+#define LOG_BIN_FORMATS     1024          /* Power of two. Formats past it are logged as text records */
+#define LOG_BIN_MAX_ARGS    16
 
 /******************************************************************************
   Type Definitions
  ******************************************************************************/
+// One queued line. seq is the slot's turn: equal to the enqueue position when free,
+// position + 1 once the line is written, position + LOG_QUEUE_SLOTS once it is drained.
+typedef struct {
+    atomic_uint seq;
+    int level;
+    int binary;                           /* text holds a BgrLog.h record */
+    int length;
+    char text[LOG_LINE_MAX];
+} logSlot;
+
+// How log_write() reads an argument off the va_list
+typedef enum {
+    eLogArg_INT = 0,
+    eLogArg_LONG,
+    eLogArg_ULONG,
+    eLogArg_LLONG,
+    eLogArg_SIZE,
+    eLogArg_SSIZE,
+    eLogArg_INTMAX,
+    eLogArg_PTRDIFF,
+    eLogArg_PTR,
+    eLogArg_DOUBLE,
+    eLogArg_LDOUBLE,
+    eLogArg_STRING
+} eLogArgKinds;
+
+// A format string seen by the binary logger, keyed by its address. ready: 0 while it is being
+// parsed, 1 when its DEFINE record is out, -1 if it can not be logged by id.
+typedef struct {
+    _Atomic(const char *) format;
+    atomic_int ready;
+    uint16_t id;
+    uint8_t argCount;
+    uint8_t argKinds[LOG_BIN_MAX_ARGS];
+} logBinFormat;
 
 /******************************************************************************
   Constant Definitions
@@ -38,79 +102,708 @@ const char *level_strings[LOG_UBOUND] = {
 /******************************************************************************
   File Scope Variables
  ******************************************************************************/
-log_level_t verbosity_level = LOG_UNINIT;
+int log_threshold = LOG_ERROR;
+
+static logSlot logQueue[LOG_QUEUE_SLOTS];
+static atomic_uint logEnqueuePos;
+static atomic_uint logClaimCount;          /* Callers that went for a queue slot */
+static atomic_uint logPublishCount;        /* Of those, the ones done: published, dropped or written themselves */
+static unsigned int logDequeuePos;          /* Writer thread only */
+static atomic_int logAsync;
+static atomic_int logWriterSleeping;
+static atomic_int logStopping;
+static atomic_ulong logDropped;
+static log_overflow_t logOverflow = LOG_OVERFLOW_DROP;
+static sem_t logWake;
+static pthread_t logWriter;
+static int logBinFd = -1;
+static logBinFormat logBinFormats[LOG_BIN_FORMATS];
+static atomic_uint logBinNextId = 1;
 
 /******************************************************************************
   File Scope Function Prototypes
  ******************************************************************************/
 
 
-void log_init(log_level_t set_level) {
-    if ( !((set_level == LOG_DEFAULT) || (set_level == LOG_ERROR) || (set_level == LOG_WARNING) || (set_level == LOG_INFO) || (set_level == LOG_DEBUG)) ) {
-        fprintf(stderr, "Improper use of log_init(): set_level is invalid: %d. ", set_level);
-    } else {
-    	verbosity_level = set_level;
+/******************************************************************************
+  File Scope Functions
+ ******************************************************************************/
+
+static void log_write_fd(int fd, const char *data, size_t length) {
+    ssize_t written;
+
+    while (length > 0) {
+        written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
     }
 }
 
+// Formats "[LEVEL] message\n" into line, truncated to size. Returns the length.
+static int log_format(char *line, size_t size, log_level_t message_level, const char *format, va_list args) {
+    int length = snprintf(line, size, "[%s] ", level_strings[message_level]);
+    int textLength;
 
-// Logs a message based on system Verbosity
-//
-void log_message(log_level_t message_level, const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    bool print_msg = false;
+    textLength = vsnprintf(line + length, size - length - 1, format, args);
+    if (textLength < 0) {
+        textLength = 0;
+    } else if (textLength > (int)(size - length - 2)) {
+        textLength = (int)(size - length - 2);
+    }
+    length += textLength;
+    line[length++] = '\n';
+    line[length] = 0;
 
-    if ((verbosity_level == LOG_UNINIT) || (verbosity_level >= LOG_UBOUND)) {
-    	fprintf(stderr, "Improper use of log_message(): verbosity_level is %d. Was log_init not called?", verbosity_level);
-    } else {
-        if ( !((message_level == LOG_DEFAULT) || (message_level == LOG_ERROR) || (message_level == LOG_WARNING) || (message_level == LOG_INFO) || (message_level == LOG_DEBUG)) ) {
-            fprintf(stderr, "Improper use of log_message(): message_level is incorrect: %d. ", message_level);
+    return length;
+}
+
+// Claims the next free slot. Returns NULL if the queue is full and the line is to be dropped.
+static logSlot *log_claim_slot(int mayDrop) {
+    unsigned int pos = atomic_load_explicit(&logEnqueuePos, memory_order_relaxed);
+    logSlot *pSlot;
+    int diff;
+
+    while (1) {
+        pSlot = &(logQueue[pos & (LOG_QUEUE_SLOTS - 1)]);
+        diff = (int)(atomic_load_explicit(&(pSlot->seq), memory_order_acquire) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&logEnqueuePos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                return pSlot;
+            }
+        } else if (diff < 0) {
+            //Full: the writer has not drained the slot from one lap ago yet
+            if (mayDrop && (logOverflow == LOG_OVERFLOW_DROP)) {
+                atomic_fetch_add_explicit(&logDropped, 1, memory_order_relaxed);
+                return NULL;
+            } else {
+                struct timespec wait = { 0, LOG_BLOCK_WAIT_NS };
+                if (atomic_exchange(&logWriterSleeping, 0)) {
+                    sem_post(&logWake);
+                }
+                nanosleep(&wait, NULL);
+                pos = atomic_load_explicit(&logEnqueuePos, memory_order_relaxed);
+            }
         } else {
+            pos = atomic_load_explicit(&logEnqueuePos, memory_order_relaxed);
+        }
+    }
+}
+
+// Returns 1 if the caller is to queue its line, in which case it calls log_async_leave() when done with the slot.
+// Counted before logAsync is read again, so log_async_stop() sees every caller that may still claim a slot.
+static int log_async_enter(void) {
+    if (!atomic_load_explicit(&logAsync, memory_order_relaxed)) {
+        return 0;
+    }
+    atomic_fetch_add(&logClaimCount, 1);
+    if (atomic_load(&logAsync)) {
+        return 1;
+    }
+    atomic_fetch_add_explicit(&logPublishCount, 1, memory_order_release);
+    return 0;
+}
+
+static void log_async_leave(void) {
+    atomic_fetch_add_explicit(&logPublishCount, 1, memory_order_release);
+}
+
+static void log_publish_slot(logSlot *pSlot) {
+    atomic_store_explicit(&(pSlot->seq), atomic_load_explicit(&(pSlot->seq), memory_order_relaxed) + 1, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&logWriterSleeping, memory_order_relaxed) && atomic_exchange(&logWriterSleeping, 0)) {
+        sem_post(&logWake);
+    }
+}
+
+// Formats and writes (or queues) one text line
+static void log_text(log_level_t message_level, const char *format, va_list args) {
+    logSlot *pSlot;
+    char line[LOG_LINE_MAX];
+    int length;
+
+    if (log_async_enter()) {
+        pSlot = log_claim_slot(1);
+        if (pSlot != NULL) {
+            pSlot->level = message_level;
+            pSlot->binary = 0;
+            pSlot->length = log_format(pSlot->text, sizeof(pSlot->text), message_level, format, args);
+            log_publish_slot(pSlot);
+        }
+        log_async_leave();
+    } else {
+        // Error messages go to stderr, everything else to stdout
+        length = log_format(line, sizeof(line), message_level, format, args);
+        log_write_fd((message_level == LOG_ERROR) ? STDERR_FILENO : STDOUT_FILENO, line, length);
+    }
+}
+
+// Where a binary record is built: in a queue slot, or in local for a synchronous write.
+// Returns NULL if the queue is full and the record is to be dropped.
+static char *log_bin_begin(logSlot **ppSlot, char *local, int mayDrop) {
+    *ppSlot = NULL;
+    if (log_async_enter()) {
+        *ppSlot = log_claim_slot(mayDrop);
+        if (*ppSlot == NULL) {
+            log_async_leave();
+            return NULL;
+        }
+        return (*ppSlot)->text;
+    }
+    return local;
+}
 
-        	// Error messages always go to stderr output.
-        	if (message_level == LOG_ERROR) {
-    		    fprintf(stderr, "[%s] ", level_strings[message_level]);
-    		    vfprintf(stderr, format, args);
-    	        fprintf(stderr, "\n");
-        	}
-
-        	//Print the message in stdout if message severity is on or above verbosity level
-            switch (verbosity_level) {
-            case (LOG_DEBUG):
-                //In DEBUG level any message is printed in stdout
-		        print_msg = true;
-                break;
-            case (LOG_INFO):
-            	if ((message_level == LOG_ERROR) || (message_level == LOG_WARNING) || (message_level == LOG_INFO)) {
-    		        print_msg = true;
-            	}
-                break;
-            case (LOG_WARNING):
-                if ((message_level == LOG_ERROR) || (message_level == LOG_WARNING)) {
-            	    print_msg = true;
+static void log_bin_end(logSlot *pSlot, log_level_t message_level, const char *record, int length) {
+    if (pSlot != NULL) {
+        pSlot->level = message_level;
+        pSlot->binary = 1;
+        pSlot->length = length;
+        log_publish_slot(pSlot);
+        log_async_leave();
+    } else {
+        log_write_fd(logBinFd, record, length);
+    }
+}
+
+static void log_bin_header(char *record, uint8_t type, log_level_t message_level, uint16_t id, uint16_t argCount, int length) {
+    bgr_logRecord header;
+
+    header.type = type;
+    header.level = (uint8_t)message_level;
+    header.length = (uint16_t)length;
+    header.id = id;
+    header.argCount = argCount;
+    memcpy(record, &header, sizeof(header));
+}
+
+// Reads the conversions of format into argKinds and the record types of the DEFINE record.
+// Returns the argument count, or -1 for a format the decoder could not rebuild.
+static int log_bin_parse(const char *format, uint8_t *argKinds, uint8_t *argTypes) {
+    const char *p = format;
+    int count = 0;
+    int length;
+    eLogArgKinds kind;
+
+    while ((p = strchr(p, '%')) != NULL) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+        while ((*p != 0) && (strchr("-+ #0'", *p) != NULL)) {
+            p++;
+        }
+        //'*' width and precision are int arguments of their own
+        if (*p == '*') {
+            if (count >= LOG_BIN_MAX_ARGS) {
+                return -1;
+            }
+            argKinds[count++] = eLogArg_INT;
+            p++;
+        }
+        while ((*p >= '0') && (*p <= '9')) {
+            p++;
+        }
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                if (count >= LOG_BIN_MAX_ARGS) {
+                    return -1;
                 }
-                break;
-            case (LOG_ERROR):
-                if ((message_level == LOG_ERROR)) {
-                    print_msg = true;
+                argKinds[count++] = eLogArg_INT;
+                p++;
+            }
+            while ((*p >= '0') && (*p <= '9')) {
+                p++;
+            }
+        }
+        length = 0;
+        if ((p[0] == 'h') && (p[1] == 'h')) {
+            p += 2;
+        } else if (*p == 'h') {
+            p++;
+        } else if ((p[0] == 'l') && (p[1] == 'l')) {
+            length = 'q';
+            p += 2;
+        } else if ((*p == 'l') || (*p == 'z') || (*p == 'j') || (*p == 't') || (*p == 'L')) {
+            length = *p++;
+        }
+        switch (*p) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                switch (length) {
+                    case 'l':
+                        kind = ((*p == 'd') || (*p == 'i')) ? eLogArg_LONG : eLogArg_ULONG;
+                        break;
+                    case 'q':
+                        kind = eLogArg_LLONG;
+                        break;
+                    case 'z':
+                        kind = ((*p == 'd') || (*p == 'i')) ? eLogArg_SSIZE : eLogArg_SIZE;
+                        break;
+                    case 'j':
+                        kind = eLogArg_INTMAX;
+                        break;
+                    case 't':
+                        kind = eLogArg_PTRDIFF;
+                        break;
+                    default:
+                        kind = eLogArg_INT;
+                        break;
                 }
                 break;
-            case (LOG_DEFAULT):
-				//In DEFAULT Err goes to stderr, nothing else in stdout
-                print_msg = false;
+            case 'c':
+                kind = eLogArg_INT;
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                kind = (length == 'L') ? eLogArg_LDOUBLE : eLogArg_DOUBLE;
+                break;
+            case 's':
+                kind = eLogArg_STRING;
+                break;
+            case 'p':
+                kind = eLogArg_PTR;
+                break;
+            default:
+                return -1;
+        }
+        if (count >= LOG_BIN_MAX_ARGS) {
+            return -1;
+        }
+        argKinds[count++] = kind;
+        p++;
+    }
+
+    for (length = 0; length < count; length++) {
+        switch (argKinds[length]) {
+            case eLogArg_INT:
+                argTypes[length] = eBgrLogArg_INT32;
+                break;
+            case eLogArg_LONG:
+            case eLogArg_ULONG:
+                argTypes[length] = (sizeof(long) == 8) ? eBgrLogArg_INT64 : eBgrLogArg_INT32;
+                break;
+            case eLogArg_SIZE:
+            case eLogArg_SSIZE:
+                argTypes[length] = (sizeof(size_t) == 8) ? eBgrLogArg_INT64 : eBgrLogArg_INT32;
+                break;
+            case eLogArg_PTRDIFF:
+                argTypes[length] = (sizeof(ptrdiff_t) == 8) ? eBgrLogArg_INT64 : eBgrLogArg_INT32;
+                break;
+            case eLogArg_DOUBLE:
+            case eLogArg_LDOUBLE:
+                argTypes[length] = eBgrLogArg_DOUBLE;
+                break;
+            case eLogArg_STRING:
+                argTypes[length] = eBgrLogArg_STRING;
                 break;
             default:
-                print_msg = false;
+                argTypes[length] = eBgrLogArg_INT64;
                 break;
+        }
+    }
+
+    return count;
+}
+
+// Finds format in the table, adding it and writing its DEFINE record the first time it is logged.
+// Returns NULL if it has to be logged as text: table full, or a conversion the decoder does not know.
+static logBinFormat *log_bin_lookup(const char *format) {
+    unsigned int index = (unsigned int)(((uintptr_t)format >> 2) * 2654435761u) & (LOG_BIN_FORMATS - 1);
+    uint8_t argTypes[LOG_BIN_MAX_ARGS];
+    char local[LOG_LINE_MAX];
+    logBinFormat *pFormat;
+    const char *current;
+    logSlot *pSlot;
+    char *record;
+    size_t formatLength;
+    int argCount;
+    int length;
+    int probes;
+
+    for (probes = 0; probes < LOG_BIN_FORMATS; probes++) {
+        pFormat = &(logBinFormats[index]);
+        current = atomic_load_explicit(&(pFormat->format), memory_order_acquire);
+        if (current == NULL) {
+            if (atomic_compare_exchange_strong(&(pFormat->format), &current, format)) {
+                argCount = log_bin_parse(format, pFormat->argKinds, argTypes);
+                if (argCount < 0) {
+                    atomic_store_explicit(&(pFormat->ready), -1, memory_order_release);
+                    return NULL;
+                }
+                pFormat->argCount = (uint8_t)argCount;
+                pFormat->id = (uint16_t)atomic_fetch_add(&logBinNextId, 1);
+                //Never dropped: without it none of the messages of this format could be decoded
+                record = log_bin_begin(&pSlot, local, 0);
+                length = sizeof(bgr_logRecord) + argCount;
+                formatLength = strlen(format);
+                if (formatLength > (size_t)(LOG_LINE_MAX - length)) {
+                    formatLength = LOG_LINE_MAX - length;
+                }
+                memcpy(record + sizeof(bgr_logRecord), argTypes, argCount);
+                memcpy(record + length, format, formatLength);
+                length += (int)formatLength;
+                log_bin_header(record, eBgrLog_DEFINE, LOG_DEFAULT, pFormat->id, (uint16_t)argCount, length);
+                log_bin_end(pSlot, LOG_DEFAULT, record, length);
+                atomic_store_explicit(&(pFormat->ready), 1, memory_order_release);
+                return pFormat;
+            }
+        }
+        if (current == format) {
+            //Another thread is adding it: wait for its DEFINE record to be queued first
+            while (atomic_load_explicit(&(pFormat->ready), memory_order_acquire) == 0) {
+                sched_yield();
             }
+            return (atomic_load_explicit(&(pFormat->ready), memory_order_relaxed) > 0) ? pFormat : NULL;
+        }
+        index = (index + 1) & (LOG_BIN_FORMATS - 1);
+    }
+
+    return NULL;
+}
+
+// Stores the message as its format id and raw arguments
+static void log_bin_message(log_level_t message_level, const char *format, va_list args) {
+    logBinFormat *pFormat = log_bin_lookup(format);
+    char local[LOG_LINE_MAX];
+    struct timespec now;
+    logSlot *pSlot;
+    char *record;
+    uint64_t value64;
+    uint32_t value32;
+    uint16_t stringLength;
+    const char *string;
+    double valueDouble;
+    int length = sizeof(bgr_logRecord) + sizeof(uint64_t);
+    int room;
+    int i;
+
+    record = log_bin_begin(&pSlot, local, 1);
+    if (record == NULL) {
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    value64 = (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+    memcpy(record + sizeof(bgr_logRecord), &value64, sizeof(value64));
+
+    if (pFormat == NULL) {
+        //Logged as text: one string argument of the predefined "%s" format
+        room = LOG_LINE_MAX - length - (int)sizeof(uint16_t);
+        i = vsnprintf(record + length + sizeof(uint16_t), room, format, args);
+        stringLength = (uint16_t)((i < 0) ? 0 : ((i >= room) ? room - 1 : i));
+        memcpy(record + length, &stringLength, sizeof(stringLength));
+        length += sizeof(uint16_t) + stringLength;
+        log_bin_header(record, eBgrLog_MESSAGE, message_level, BGR_LOG_ID_TEXT, 1, length);
+        log_bin_end(pSlot, message_level, record, length);
+        return;
+    }
+
+    for (i = 0; i < pFormat->argCount; i++) {
+        switch (pFormat->argKinds[i]) {
+            case eLogArg_INT:
+                value32 = (uint32_t)va_arg(args, int);
+                break;
+            case eLogArg_LONG:
+                value64 = (uint64_t)(int64_t)va_arg(args, long);
+                value32 = (uint32_t)value64;
+                break;
+            case eLogArg_ULONG:
+                value64 = (uint64_t)va_arg(args, unsigned long);
+                value32 = (uint32_t)value64;
+                break;
+            case eLogArg_LLONG:
+                value64 = (uint64_t)va_arg(args, unsigned long long);
+                break;
+            case eLogArg_SIZE:
+            case eLogArg_SSIZE:
+                value64 = (uint64_t)va_arg(args, size_t);
+                value32 = (uint32_t)value64;
+                break;
+            case eLogArg_INTMAX:
+                value64 = (uint64_t)va_arg(args, intmax_t);
+                break;
+            case eLogArg_PTRDIFF:
+                value64 = (uint64_t)(int64_t)va_arg(args, ptrdiff_t);
+                value32 = (uint32_t)value64;
+                break;
+            case eLogArg_PTR:
+                value64 = (uint64_t)(uintptr_t)va_arg(args, void *);
+                break;
+            case eLogArg_DOUBLE:
+                valueDouble = va_arg(args, double);
+                break;
+            case eLogArg_LDOUBLE:
+                valueDouble = (double)va_arg(args, long double);
+                break;
+            default:
+                string = va_arg(args, const char *);
+                break;
+        }
+        //Truncated records end early; the decoder prints what is missing as <?>
+        if (length + 8 > LOG_LINE_MAX) {
+            break;
+        }
+        switch (pFormat->argKinds[i]) {
+            case eLogArg_INT:
+                memcpy(record + length, &value32, sizeof(value32));
+                length += sizeof(value32);
+                break;
+            case eLogArg_DOUBLE:
+            case eLogArg_LDOUBLE:
+                memcpy(record + length, &valueDouble, sizeof(valueDouble));
+                length += sizeof(valueDouble);
+                break;
+            case eLogArg_STRING:
+                if (string == NULL) {
+                    string = "(null)";
+                }
+                //Leave room for the arguments after it
+                room = LOG_LINE_MAX - length - (int)sizeof(uint16_t) - 8 * (pFormat->argCount - i - 1);
+                stringLength = (uint16_t)strnlen(string, (room > 0) ? room : 0);
+                memcpy(record + length, &stringLength, sizeof(stringLength));
+                memcpy(record + length + sizeof(uint16_t), string, stringLength);
+                length += sizeof(uint16_t) + stringLength;
+                break;
+            case eLogArg_LONG:
+            case eLogArg_ULONG:
+            case eLogArg_SIZE:
+            case eLogArg_SSIZE:
+            case eLogArg_PTRDIFF:
+                if (sizeof(long) == 8) {
+                    memcpy(record + length, &value64, sizeof(value64));
+                    length += sizeof(value64);
+                } else {
+                    memcpy(record + length, &value32, sizeof(value32));
+                    length += sizeof(value32);
+                }
+                break;
+            default:
+                memcpy(record + length, &value64, sizeof(value64));
+                length += sizeof(value64);
+                break;
+        }
+    }
+    log_bin_header(record, eBgrLog_MESSAGE, message_level, pFormat->id, pFormat->argCount, length);
+    log_bin_end(pSlot, message_level, record, length);
+}
+
+// Appends the drained lines to the batch for their stream, writing a batch out when it is full.
+static void log_batch(char *batch, size_t *pFill, int fd, const char *text, int length) {
+    if (*pFill + length > LOG_WRITE_CHUNK) {
+        log_write_fd(fd, batch, *pFill);
+        *pFill = 0;
+    }
+    memcpy(batch + *pFill, text, length);
+    *pFill += length;
+}
+
+// Writes out every line queued so far. Returns how many there were.
+static int log_drain(void) {
+    static char outBatch[LOG_WRITE_CHUNK];
+    static char errBatch[LOG_WRITE_CHUNK];
+    static char binBatch[LOG_WRITE_CHUNK];
+    static unsigned long reportedDropped = 0;
+    size_t outFill = 0, errFill = 0, binFill = 0;
+    unsigned long dropped;
+    logSlot *pSlot;
+    int count = 0;
+
+    while (1) {
+        pSlot = &(logQueue[logDequeuePos & (LOG_QUEUE_SLOTS - 1)]);
+        if (atomic_load_explicit(&(pSlot->seq), memory_order_acquire) != logDequeuePos + 1) {
+            break;
+        }
+        if (pSlot->binary) {
+            log_batch(binBatch, &binFill, logBinFd, pSlot->text, pSlot->length);
+        } else if (pSlot->level == LOG_ERROR) {
+            log_batch(errBatch, &errFill, STDERR_FILENO, pSlot->text, pSlot->length);
+        } else {
+            log_batch(outBatch, &outFill, STDOUT_FILENO, pSlot->text, pSlot->length);
+        }
+        atomic_store_explicit(&(pSlot->seq), logDequeuePos + LOG_QUEUE_SLOTS, memory_order_release);
+        logDequeuePos++;
+        count++;
+    }
+
+    dropped = atomic_load_explicit(&logDropped, memory_order_relaxed);
+    if (dropped != reportedDropped) {
+        char line[LOG_LINE_MAX];
+        int length;
+
+        if (logBinFd >= 0) {
+            uint32_t count = (uint32_t)(dropped - reportedDropped);
+
+            length = sizeof(bgr_logRecord) + sizeof(count);
+            log_bin_header(line, eBgrLog_DROPPED, LOG_WARNING, 0, 0, length);
+            memcpy(line + sizeof(bgr_logRecord), &count, sizeof(count));
+            log_batch(binBatch, &binFill, logBinFd, line, length);
+        } else {
+            length = snprintf(line, sizeof(line), "[%s] %lu log lines dropped, queue full\n", level_strings[LOG_WARNING], dropped - reportedDropped);
+            log_batch(outBatch, &outFill, STDOUT_FILENO, line, length);
+        }
+        reportedDropped = dropped;
+    }
+    if (errFill > 0) {
+        log_write_fd(STDERR_FILENO, errBatch, errFill);
+    }
+    if (outFill > 0) {
+        log_write_fd(STDOUT_FILENO, outBatch, outFill);
+    }
+    if (binFill > 0) {
+        log_write_fd(logBinFd, binBatch, binFill);
+    }
+
+    return count;
+}
+
+static int log_queue_empty(void) {
+    logSlot *pSlot = &(logQueue[logDequeuePos & (LOG_QUEUE_SLOTS - 1)]);
+    return atomic_load(&(pSlot->seq)) != logDequeuePos + 1;
+}
 
-            if (print_msg == true) {
-                fprintf(stdout, "[%s] ", level_strings[message_level]);
-		        vfprintf(stdout, format, args);
-	            fprintf(stdout, "\n");
+static void *log_writer(void *arg) {
+    while (1) {
+        if (log_drain() > 0) {
+            continue;
+        }
+        if (atomic_load(&logStopping)) {
+            //Lines published between the drain above and the stop request
+            log_drain();
+            break;
+        }
+        //Announce the sleep before the last look, so a line queued in between always posts the wake up
+        atomic_store(&logWriterSleeping, 1);
+        if (log_queue_empty() && !atomic_load(&logStopping)) {
+            while ((sem_wait(&logWake) != 0) && (errno == EINTR)) {
             }
         }
+        atomic_store(&logWriterSleeping, 0);
+    }
+    return NULL;
+}
+
+/******************************************************************************
+  Global Functions
+ ******************************************************************************/
+
+void log_init(log_level_t set_level) {
+    if ( !((set_level == LOG_DEFAULT) || (set_level == LOG_ERROR) || (set_level == LOG_WARNING) || (set_level == LOG_INFO) || (set_level == LOG_DEBUG)) ) {
+        fprintf(stderr, "Improper use of log_init(): set_level is invalid: %d. ", set_level);
+    } else {
+        //In DEFAULT errors still go to stderr, nothing else is written
+        log_threshold = (set_level == LOG_DEFAULT) ? LOG_ERROR : set_level;
+        if (set_level > LOG_COMPILE_LEVEL) {
+            log_message(LOG_WARNING, "Messages above level %d are compiled out of this build", LOG_COMPILE_LEVEL);
+        }
+    }
+}
+
+
+// Logs a message that passed the verbosity check in log_message()
+//
+void log_write(log_level_t message_level, const char *format, ...) {
+    va_list args;
+    va_list binArgs;
+
+    if ( !((message_level == LOG_DEFAULT) || (message_level == LOG_ERROR) || (message_level == LOG_WARNING) || (message_level == LOG_INFO) || (message_level == LOG_DEBUG)) ) {
+        fprintf(stderr, "Improper use of log_message(): message_level is incorrect: %d. ", message_level);
+        return;
+    }
+
+    va_start(args, format);
+    if (logBinFd >= 0) {
+        va_copy(binArgs, args);
+        log_bin_message(message_level, format, binArgs);
+        va_end(binArgs);
+        //Errors stay readable on the console
+        if (message_level == LOG_ERROR) {
+            log_text(message_level, format, args);
+        }
+    } else {
+        log_text(message_level, format, args);
     }
     va_end(args);
 }
+
+// Call before log_async_start() and before any other thread logs
+int log_binary_start(const char *fileName) {
+    bgr_logHeader header;
+    int fd;
+
+    fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        log_message(LOG_ERROR, "log_binary_start::open(%s) failed: %s", fileName, strerror(errno));
+        return -1;
+    }
+    header.magic = BGR_LOG_MAGIC;
+    header.version = BGR_LOG_VERSION;
+    log_write_fd(fd, (const char *)&header, sizeof(header));
+    logBinFd = fd;
+
+    return 0;
+}
+
+int log_async_start(log_overflow_t overflow) {
+    unsigned int i;
+
+    if (atomic_load(&logAsync)) {
+        return 0;
+    }
+    for (i = 0; i < LOG_QUEUE_SLOTS; i++) {
+        atomic_init(&(logQueue[i].seq), i);
+    }
+    atomic_init(&logEnqueuePos, 0);
+    logDequeuePos = 0;
+    logOverflow = overflow;
+    atomic_store(&logStopping, 0);
+    if (sem_init(&logWake, 0, 0) != 0) {
+        return -1;
+    }
+    if (pthread_create(&logWriter, NULL, log_writer, NULL) != 0) {
+        sem_destroy(&logWake);
+        return -2;
+    }
+    atomic_store_explicit(&logAsync, 1, memory_order_release);
+    atexit(log_async_stop);
+
+    return 0;
+}
+
+// Writes out what is queued and stops the writer. Lines logged afterwards are written by the caller.
+void log_async_stop(void) {
+    struct timespec wait = { 0, LOG_BLOCK_WAIT_NS };
+    int polls;
+
+    if (!atomic_exchange(&logAsync, 0)) {
+        return;
+    }
+    //A line claimed but not yet published would be skipped by the last drain. Bounded, so a stuck thread can not hold up exit.
+    for (polls = 0; (polls < LOG_STOP_WAIT_POLLS) &&
+                    (atomic_load_explicit(&logPublishCount, memory_order_acquire) != atomic_load(&logClaimCount)); polls++) {
+        nanosleep(&wait, NULL);
+    }
+    atomic_store(&logStopping, 1);
+    sem_post(&logWake);
+    pthread_join(logWriter, NULL);
+    sem_destroy(&logWake);
+}
+
+unsigned long log_dropped_count(void) {
+    return atomic_load_explicit(&logDropped, memory_order_relaxed);
+}
@@ -22,7 +22,39 @@ typedef enum {
 	LOG_UBOUND 		= 6
 } log_level_t;
 
+// What log_write() does when the queue of the background writer is full
+typedef enum {
+    LOG_OVERFLOW_DROP 	= 0,	// The line is dropped and counted, the caller never waits
+    LOG_OVERFLOW_BLOCK 	= 1		// The caller waits until the writer has made room
+} log_overflow_t;
+
+// Most verbose level written, set by log_init(). Errors are always written (to stderr).
+extern int log_threshold;
+
+// Messages above this level are compiled out, set per BUILD_PROFILE in the Makefile
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL       LOG_DEBUG
+#endif
+
+#define log_enabled(level)      (((level) <= LOG_COMPILE_LEVEL) && ((int)(level) <= log_threshold))
+
+// Filtered messages cost a compare, compiled out ones nothing: neither the call nor the arguments are evaluated
+#define log_message(level, ...) do { if (log_enabled(level)) { log_write((level), __VA_ARGS__); } } while (0)
+
 void log_init(log_level_t set_level);
-void log_message(log_level_t message_level, const char *format, ...);
+void log_write(log_level_t message_level, const char *format, ...);
+
+// Starts the background writer: from then on log_write() formats into a lock-free queue and returns,
+// a thread writes the lines out. Until then, and if it fails to start, lines are written by the caller.
+// The queue is drained when the process exits.
+int log_async_start(log_overflow_t overflow);
+void log_async_stop(void);
+
+// Writes messages from now on as binary records into fileName (see BgrLog.h), decoded by tools/bgrLogDecode.
+// Call before log_async_start(), while only one thread logs.
+int log_binary_start(const char *fileName);
+
+// Lines dropped so far because the queue was full
+unsigned long log_dropped_count(void);
 
 #endif // LOGGER_H
@@ -0,0 +1,226 @@
+/*
+ * bgrImgConv.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Build time tool: converts a splash image (binary PPM, i.e. from `convert splash.png splash.ppm`)
+ *  into a pre-converted .bgri image (see src/BgrImage.h), which bgr loads without any decoding.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "argParse.h"
+#include "BgrImage.h"
+
+
+int validate_file(const char *value) {
+    return (value != NULL) && (strlen(value) > 0);
+}
+
+int validate_encoding(const char *value) {
+    return (strcmp(value, "RAW") == 0) || (strcmp(value, "RLE") == 0);
+}
+
+int validate_verbosity(const char *value) {
+    int result = 1;
+
+    if (strcmp(value, "1") == 0) {
+        log_init(LOG_ERROR);
+    } else if (strcmp(value, "2") == 0) {
+        log_init(LOG_WARNING);
+    } else if (strcmp(value, "3") == 0) {
+        log_init(LOG_INFO);
+    } else if (strcmp(value, "4") == 0) {
+        log_init(LOG_DEBUG);
+    } else {
+        result = 0;
+    }
+
+    return result;
+}
+
+typedef enum {
+    PARAM_VERBOCITY,
+    PARAM_IN,
+    PARAM_ENCODING,
+    PARAM_OUT,
+    PARAM_COUNT
+} ParameterIndex;
+
+tCmdOptionParam params[] = {
+    {"-v",        "", validate_verbosity, "[-v=1..4]",             "Verbosity (optional): 1-Error, 2-Warning+, 3-Info+, 4-Debug+.",                   false, false, "1"   },
+    {"-in",       "", validate_file,      "-in=image.ppm",         "Binary 8 bit PPM to convert (required).",                                         true,  false, NULL  },
+    {"-encoding", "", validate_encoding,  "[-encoding={RAW|RLE}]", "RAW: fastest load, largest file; RLE: pixel runs, for flat images. Default: RAW", false, false, "RAW" },
+    {"-out",      "", validate_file,      "-out=splash.bgri",      "Output image file (required).",                                                   true,  false, NULL  }
+};
+
+
+// Reads one PPM header token, skipping white space and comments.
+static int readPpmToken(FILE *in, int *pValue) {
+    int c;
+
+    do {
+        c = fgetc(in);
+        if (c == '#') {
+            while ((c != '\n') && (c != EOF)) {
+                c = fgetc(in);
+            }
+        }
+    } while ((c == ' ') || (c == '\t') || (c == '\r') || (c == '\n'));
+    if ((c < '0') || (c > '9')) {
+        return -1;
+    }
+    *pValue = 0;
+    while ((c >= '0') && (c <= '9')) {
+        *pValue = *pValue * 10 + (c - '0');
+        c = fgetc(in);
+    }
+    return 0;
+}
+
+// Encodes one row into pOut (room for 2 * width words). Runs of 3 or more equal pixels become run packets.
+// Returns the number of words written.
+static size_t encodeRleRow(const uint32_t *pRow, int width, uint32_t *pOut) {
+    size_t count = 0;
+    int start, run;
+    int x = 0;
+
+    while (x < width) {
+        run = 1;
+        while ((x + run < width) && (pRow[x + run] == pRow[x])) {
+            run++;
+        }
+        if (run >= 3) {
+            pOut[count++] = BGR_IMG_RLE_RUN | (uint32_t)run;
+            pOut[count++] = pRow[x];
+            x += run;
+            continue;
+        }
+        // Literal packet up to the next run worth a packet of its own
+        start = x;
+        while (x < width) {
+            if ((x + 2 < width) && (pRow[x + 1] == pRow[x]) && (pRow[x + 2] == pRow[x])) {
+                break;
+            }
+            x++;
+        }
+        pOut[count++] = (uint32_t)(x - start);
+        memcpy(&pOut[count], &pRow[start], (size_t)(x - start) * sizeof(uint32_t));
+        count += x - start;
+    }
+
+    return count;
+}
+
+
+int main(int argc, char *argv[]) {
+    char inFile[PARAM_MAX_LENGTH];
+    char outFile[PARAM_MAX_LENGTH];
+    char tmpParamStr[PARAM_MAX_LENGTH];
+    static const uint8_t padding[BGR_IMG_DATA_ALIGN] = {0};
+    bgr_imgHeader header;
+    uint8_t *rgbRow = NULL;
+    uint32_t *pixels = NULL;
+    uint32_t *data = NULL;
+    size_t dataWords = 0;
+    int width, height, maxVal;
+    int encoding;
+    FILE *in, *out;
+    int x, y;
+
+    log_init(LOG_ERROR);
+
+    if (parse_arguments(argc, argv, PARAM_COUNT, params) != PARSE_SUCCESS) {
+        print_usage("bgrImgConv", PARAM_COUNT, params);
+        return -1;
+    }
+    getParamValueByIndex(PARAM_IN, PARAM_COUNT, params, inFile);
+    getParamValueByIndex(PARAM_OUT, PARAM_COUNT, params, outFile);
+    getParamValueByIndex(PARAM_ENCODING, PARAM_COUNT, params, tmpParamStr);
+    encoding = (strcmp(tmpParamStr, "RLE") == 0) ? eBgrImg_RLE : eBgrImg_RAW;
+
+    in = fopen(inFile, "rb");
+    if (in == NULL) {
+        log_message(LOG_ERROR, "Cannot open %s", inFile);
+        return -1;
+    }
+    if ((fgetc(in) != 'P') || (fgetc(in) != '6') ||
+        (readPpmToken(in, &width) != 0) || (readPpmToken(in, &height) != 0) || (readPpmToken(in, &maxVal) != 0) ||
+        (width <= 0) || (height <= 0) || (width > BGR_IMG_MAX_DIM) || (height > BGR_IMG_MAX_DIM) || (maxVal != 255)) {
+        log_message(LOG_ERROR, "%s is not a binary 8 bit PPM of at most %dx%d", inFile, BGR_IMG_MAX_DIM, BGR_IMG_MAX_DIM);
+        fclose(in);
+        return -1;
+    }
+
+    // Window format: one little endian word per pixel, 0xFFRRGGBB, as the decoder writes it on target
+    rgbRow = malloc((size_t)width * 3);
+    pixels = malloc((size_t)width * height * sizeof(uint32_t));
+    if ((rgbRow == NULL) || (pixels == NULL)) {
+        log_message(LOG_ERROR, "Memory allocation failed");
+        fclose(in);
+        return -1;
+    }
+    for (y = 0; y < height; y++) {
+        if (fread(rgbRow, 3, width, in) != (size_t)width) {
+            log_message(LOG_ERROR, "%s is truncated", inFile);
+            fclose(in);
+            return -1;
+        }
+        for (x = 0; x < width; x++) {
+            pixels[(size_t)y * width + x] = 0xff000000u | ((uint32_t)rgbRow[x * 3] << 16) | ((uint32_t)rgbRow[x * 3 + 1] << 8) | rgbRow[x * 3 + 2];
+        }
+    }
+    fclose(in);
+    free(rgbRow);
+
+    if (encoding == eBgrImg_RLE) {
+        data = malloc((size_t)width * height * 2 * sizeof(uint32_t));
+        if (data == NULL) {
+            log_message(LOG_ERROR, "Memory allocation failed");
+            return -1;
+        }
+        for (y = 0; y < height; y++) {
+            dataWords += encodeRleRow(&pixels[(size_t)y * width], width, &data[dataWords]);
+        }
+    } else {
+        data = pixels;
+        dataWords = (size_t)width * height;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = BGR_IMG_MAGIC;
+    header.version = BGR_IMG_VERSION;
+    header.width = width;
+    header.height = height;
+    header.format = BGR_IMG_FORMAT_RGBX;
+    header.encoding = encoding;
+    header.stride = width * 4;
+    header.dataOffset = BGR_IMG_DATA_ALIGN;
+    header.dataSize = dataWords * sizeof(uint32_t);
+
+    out = fopen(outFile, "wb");
+    if (out == NULL) {
+        log_message(LOG_ERROR, "Cannot create %s", outFile);
+        return -1;
+    }
+    if ((fwrite(&header, sizeof(header), 1, out) != 1) ||
+        (fwrite(padding, BGR_IMG_DATA_ALIGN - sizeof(header), 1, out) != 1) ||
+        (fwrite(data, sizeof(uint32_t), dataWords, out) != dataWords)) {
+        log_message(LOG_ERROR, "Writing %s failed", outFile);
+        fclose(out);
+        return -1;
+    }
+    fclose(out);
+    printf("%s: %dx%d %s, %u data bytes (raw: %u)\n", outFile, width, height, (encoding == eBgrImg_RLE) ? "RLE" : "RAW", header.dataSize, header.stride * height);
+
+    if (data != pixels) {
+        free(data);
+    }
+    free(pixels);
+    return 0;
+}
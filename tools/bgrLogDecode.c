@@ -0,0 +1,315 @@
+/*
+ * bgrLogDecode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Turns a binary log written by bgr -logBin=file.bgrl (see src/BgrLog.h) back into the
+ *  text lines the messages would have been, each prefixed with its CLOCK_MONOTONIC time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "logger.h"
+#include "argParse.h"
+#include "BgrLog.h"
+
+#define DECODE_MAX_IDS    65536
+#define DECODE_SPEC_MAX   64
+
+typedef struct {
+    char *format;
+    uint8_t argTypes[256];
+    int argCount;
+} decodeFormat;
+
+static const char *levelNames[LOG_UBOUND] = { "", "", "ERROR", "WARNING", "INFO", "DEBUG" };
+static decodeFormat formats[DECODE_MAX_IDS];
+
+
+int validate_file(const char *value) {
+    return (value != NULL) && (strlen(value) > 0);
+}
+
+typedef enum {
+    PARAM_IN,
+    PARAM_COUNT
+} ParameterIndex;
+
+tCmdOptionParam params[] = {
+    {"-in",  "", validate_file, "-in=file.bgrl", "Binary log to decode (required). Text goes to stdout.", true, false, NULL }
+};
+
+
+// Reads the next argument of the record, of type want. Returns 0 if the record has no more
+// arguments or the next one has another type.
+static int nextArg(const decodeFormat *pFormat, const uint8_t *payload, size_t size, size_t *pOffset, int *pArg,
+                   int want, uint64_t *pInt, double *pDouble, const char **pString, uint16_t *pStringLength) {
+    int type;
+    uint32_t value32;
+
+    if (*pArg >= pFormat->argCount) {
+        return 0;
+    }
+    type = pFormat->argTypes[*pArg];
+    if ((want == eBgrLogArg_INT64) && (type == eBgrLogArg_INT32)) {
+        want = eBgrLogArg_INT32;     //32 bit long/size_t on the target
+    }
+    if (type != want) {
+        return 0;
+    }
+    switch (type) {
+        case eBgrLogArg_INT32:
+            if (*pOffset + sizeof(value32) > size) {
+                return 0;
+            }
+            memcpy(&value32, payload + *pOffset, sizeof(value32));
+            *pInt = value32;
+            *pOffset += sizeof(value32);
+            break;
+        case eBgrLogArg_INT64:
+            if (*pOffset + sizeof(uint64_t) > size) {
+                return 0;
+            }
+            memcpy(pInt, payload + *pOffset, sizeof(uint64_t));
+            *pOffset += sizeof(uint64_t);
+            break;
+        case eBgrLogArg_DOUBLE:
+            if (*pOffset + sizeof(double) > size) {
+                return 0;
+            }
+            memcpy(pDouble, payload + *pOffset, sizeof(double));
+            *pOffset += sizeof(double);
+            break;
+        default:
+            if (*pOffset + sizeof(uint16_t) > size) {
+                return 0;
+            }
+            memcpy(pStringLength, payload + *pOffset, sizeof(uint16_t));
+            *pOffset += sizeof(uint16_t);
+            if (*pOffset + *pStringLength > size) {
+                return 0;
+            }
+            *pString = (const char *)payload + *pOffset;
+            *pOffset += *pStringLength;
+            break;
+    }
+    (*pArg)++;
+
+    return 1;
+}
+
+// Prints the message: the format with each conversion replaced by its argument from the record.
+static void printMessage(const decodeFormat *pFormat, const uint8_t *payload, size_t size) {
+    const char *p = pFormat->format;
+    char spec[DECODE_SPEC_MAX];
+    char stringArg[65536];
+    const char *string = NULL;
+    uint16_t stringLength = 0;
+    size_t offset = 0;
+    size_t specLength;
+    uint64_t valueInt = 0;
+    double valueDouble = 0.0;
+    int arg = 0;
+    int wide;
+    char conversion;
+
+    while (*p != 0) {
+        if (*p != '%') {
+            fputc(*p++, stdout);
+            continue;
+        }
+        if (p[1] == '%') {
+            fputc('%', stdout);
+            p += 2;
+            continue;
+        }
+        //Rebuild the conversion without its length modifier, '*' replaced by the value
+        specLength = 0;
+        spec[specLength++] = *p++;
+        while ((*p != 0) && (strchr("-+ #0'.0123456789*", *p) != NULL) && (specLength < DECODE_SPEC_MAX - 24)) {
+            if (*p == '*') {
+                if (!nextArg(pFormat, payload, size, &offset, &arg, eBgrLogArg_INT32, &valueInt, &valueDouble, &string, &stringLength)) {
+                    fputs("<?>", stdout);
+                    return;
+                }
+                specLength += snprintf(spec + specLength, DECODE_SPEC_MAX - specLength, "%d", (int)(uint32_t)valueInt);
+            } else {
+                spec[specLength++] = *p;
+            }
+            p++;
+        }
+        wide = 0;
+        while ((*p != 0) && (strchr("hlLqjzt", *p) != NULL)) {
+            wide = wide || ((*p != 'h'));
+            p++;
+        }
+        conversion = *p;
+        if (conversion == 0) {
+            break;
+        }
+        p++;
+        switch (conversion) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            case 'c':
+                if (!nextArg(pFormat, payload, size, &offset, &arg, wide ? eBgrLogArg_INT64 : eBgrLogArg_INT32,
+                             &valueInt, &valueDouble, &string, &stringLength)) {
+                    fputs("<?>", stdout);
+                    continue;
+                }
+                if (pFormat->argTypes[arg - 1] == eBgrLogArg_INT64) {
+                    spec[specLength++] = 'l';
+                    spec[specLength++] = 'l';
+                    spec[specLength++] = conversion;
+                    spec[specLength] = 0;
+                    printf(spec, (long long)valueInt);
+                } else {
+                    spec[specLength++] = conversion;
+                    spec[specLength] = 0;
+                    printf(spec, (int)(uint32_t)valueInt);
+                }
+                break;
+            case 'p':
+                if (!nextArg(pFormat, payload, size, &offset, &arg, eBgrLogArg_INT64, &valueInt, &valueDouble, &string, &stringLength)) {
+                    fputs("<?>", stdout);
+                    continue;
+                }
+                printf("0x%llx", (unsigned long long)valueInt);
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (!nextArg(pFormat, payload, size, &offset, &arg, eBgrLogArg_DOUBLE, &valueInt, &valueDouble, &string, &stringLength)) {
+                    fputs("<?>", stdout);
+                    continue;
+                }
+                spec[specLength++] = conversion;
+                spec[specLength] = 0;
+                printf(spec, valueDouble);
+                break;
+            case 's':
+                if (!nextArg(pFormat, payload, size, &offset, &arg, eBgrLogArg_STRING, &valueInt, &valueDouble, &string, &stringLength)) {
+                    fputs("<?>", stdout);
+                    continue;
+                }
+                memcpy(stringArg, string, stringLength);
+                stringArg[stringLength] = 0;
+                spec[specLength++] = 's';
+                spec[specLength] = 0;
+                printf(spec, stringArg);
+                break;
+            default:
+                fputs("<?>", stdout);
+                break;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    static const decodeFormat textFormat = { (char *)"%s", { eBgrLogArg_STRING }, 1 };
+    char inFile[PARAM_MAX_LENGTH];
+    bgr_logHeader header;
+    bgr_logRecord record;
+    uint8_t *data;
+    size_t size, offset;
+    uint64_t timeNs;
+    uint32_t dropped;
+    const decodeFormat *pFormat;
+    long fileSize;
+    FILE *in;
+
+    log_init(LOG_ERROR);
+
+    if (parse_arguments(argc, argv, PARAM_COUNT, params) != PARSE_SUCCESS) {
+        print_usage("bgrLogDecode", PARAM_COUNT, params);
+        return -1;
+    }
+    getParamValueByIndex(PARAM_IN, PARAM_COUNT, params, inFile);
+
+    in = fopen(inFile, "rb");
+    if (in == NULL) {
+        log_message(LOG_ERROR, "Cannot open %s", inFile);
+        return -1;
+    }
+    fseek(in, 0, SEEK_END);
+    fileSize = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    data = malloc((fileSize > 0) ? (size_t)fileSize : 1);
+    if ((data == NULL) || (fileSize < (long)sizeof(header)) || (fread(data, 1, (size_t)fileSize, in) != (size_t)fileSize)) {
+        log_message(LOG_ERROR, "Cannot read %s", inFile);
+        fclose(in);
+        free(data);
+        return -1;
+    }
+    fclose(in);
+    size = (size_t)fileSize;
+
+    memcpy(&header, data, sizeof(header));
+    if ((header.magic != BGR_LOG_MAGIC) || (header.version != BGR_LOG_VERSION)) {
+        log_message(LOG_ERROR, "%s is not a version %d bgr binary log", inFile, BGR_LOG_VERSION);
+        free(data);
+        return -1;
+    }
+
+    for (offset = sizeof(header); offset + sizeof(record) <= size; offset += record.length) {
+        memcpy(&record, data + offset, sizeof(record));
+        if ((record.length < sizeof(record)) || (offset + record.length > size)) {
+            log_message(LOG_ERROR, "Record at offset %zu is cut short, decoding stopped", offset);
+            break;
+        }
+        switch (record.type) {
+            case eBgrLog_DEFINE:
+                if (record.argCount > sizeof(formats[0].argTypes) || (sizeof(record) + record.argCount > record.length)) {
+                    log_message(LOG_WARNING, "Format %u at offset %zu is invalid", record.id, offset);
+                    break;
+                }
+                free(formats[record.id].format);
+                formats[record.id].argCount = record.argCount;
+                memcpy(formats[record.id].argTypes, data + offset + sizeof(record), record.argCount);
+                formats[record.id].format = strndup((const char *)data + offset + sizeof(record) + record.argCount,
+                                                    record.length - sizeof(record) - record.argCount);
+                break;
+            case eBgrLog_MESSAGE:
+                if (record.length < sizeof(record) + sizeof(timeNs)) {
+                    break;
+                }
+                pFormat = (record.id == BGR_LOG_ID_TEXT) ? &textFormat : &(formats[record.id]);
+                memcpy(&timeNs, data + offset + sizeof(record), sizeof(timeNs));
+                printf("[%6llu.%06llu] [%s] ", (unsigned long long)(timeNs / 1000000000u), (unsigned long long)((timeNs % 1000000000u) / 1000),
+                       (record.level < LOG_UBOUND) ? levelNames[record.level] : "?");
+                if (pFormat->format == NULL) {
+                    printf("<format %u not defined>", record.id);
+                } else {
+                    printMessage(pFormat, data + offset + sizeof(record) + sizeof(timeNs), record.length - sizeof(record) - sizeof(timeNs));
+                }
+                fputc('\n', stdout);
+                break;
+            case eBgrLog_DROPPED:
+                if (record.length >= sizeof(record) + sizeof(dropped)) {
+                    memcpy(&dropped, data + offset + sizeof(record), sizeof(dropped));
+                    printf("[%s] %u log messages dropped, queue full\n", levelNames[LOG_WARNING], dropped);
+                }
+                break;
+            default:
+                log_message(LOG_WARNING, "Unknown record type %u at offset %zu", record.type, offset);
+                break;
+        }
+    }
+
+    free(data);
+
+    return 0;
+}
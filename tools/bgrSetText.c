@@ -0,0 +1,83 @@
+/*
+ * bgrSetText.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Sends a new text line to a running bgr started with -ctrl=/path/to/socket.
+ *  Equivalent to: echo "text" | nc -U /path/to/socket
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "logger.h"
+#include "argParse.h"
+
+
+int validate_file(const char *value) {
+    return (value != NULL) && (strlen(value) > 0) && (strlen(value) < 100);
+}
+
+int validate_text(const char *value) {
+    return (value != NULL) && (strchr(value, '\n') == NULL);
+}
+
+typedef enum {
+    PARAM_CTRL,
+    PARAM_TEXT,
+    PARAM_COUNT
+} ParameterIndex;
+
+tCmdOptionParam params[] = {
+    {"-ctrl",   "", validate_file,  "-ctrl=/path/to/socket",  "Control socket of the running bgr (required).",  true,  false, NULL },
+    {"-text",   "", validate_text,  "-text=\"Display text\"", "New text to display (required).",              true,  false, NULL }
+};
+
+
+int main(int argc, char *argv[]) {
+    char ctrlPath[PARAM_MAX_LENGTH];
+    char txtStr[PARAM_MAX_LENGTH + 1];
+    struct sockaddr_un addr;
+    size_t txtLen;
+    int fd;
+
+    log_init(LOG_ERROR);
+
+    if (parse_arguments(argc, argv, PARAM_COUNT, params) != PARSE_SUCCESS) {
+        print_usage("bgrSetText", PARAM_COUNT, params);
+        return -1;
+    }
+    memset(ctrlPath, 0, sizeof(ctrlPath));
+    memset(txtStr, 0, sizeof(txtStr));
+    getParamValueByIndex(PARAM_CTRL, PARAM_COUNT, params, ctrlPath);
+    getParamValueByIndex(PARAM_TEXT, PARAM_COUNT, params, txtStr);
+    txtLen = strlen(txtStr);
+    txtStr[txtLen++] = '\n';
+
+    if (strlen(ctrlPath) >= sizeof(addr.sun_path)) {
+        log_message(LOG_ERROR, "Socket path too long: %s", ctrlPath);
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, ctrlPath, strlen(ctrlPath) + 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((fd < 0) || (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)) {
+        log_message(LOG_ERROR, "Cannot connect to %s", ctrlPath);
+        return -1;
+    }
+    if (write(fd, txtStr, txtLen) != (ssize_t)txtLen) {
+        log_message(LOG_ERROR, "Sending text to %s failed", ctrlPath);
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    return 0;
+}
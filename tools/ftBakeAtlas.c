@@ -0,0 +1,203 @@
+/*
+ * ftBakeAtlas.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: TBC
+ *
+ *  Build time tool: rasterizes a character set of a font at a given size and DPI
+ *  into a glyph atlas file (see src/FtAtlas.h), to be passed to bgr with -atlas=.
+ *  The DPI must match what bgr uses on the target display, or the atlas is ignored.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "logger.h"
+#include "argParse.h"
+#include "FtAtlas.h"
+
+#define MAX_ATLAS_GLYPHS 256
+
+
+int validate_file(const char *value) {
+    return (value != NULL) && (strlen(value) > 0);
+}
+
+int validate_number(const char *value) {
+    char *end = NULL;
+    long number = strtol(value, &end, 10);
+
+    return (*end == 0) && (number > 0) && (number < 10000);
+}
+
+int validate_verbosity(const char *value) {
+    int result = 1;
+
+    if (strcmp(value, "1") == 0) {
+        log_init(LOG_ERROR);
+    } else if (strcmp(value, "2") == 0) {
+        log_init(LOG_WARNING);
+    } else if (strcmp(value, "3") == 0) {
+        log_init(LOG_INFO);
+    } else if (strcmp(value, "4") == 0) {
+        log_init(LOG_DEBUG);
+    } else {
+        result = 0;
+    }
+
+    return result;
+}
+
+typedef enum {
+    PARAM_VERBOCITY,
+    PARAM_FONT,
+    PARAM_SIZE,
+    PARAM_DPI,
+    PARAM_CHARS,
+    PARAM_OUT,
+    PARAM_COUNT
+} ParameterIndex;
+
+tCmdOptionParam params[] = {
+    {"-v",      "", validate_verbosity, "[-v=1..4]",              "Verbosity (optional): 1-Error, 2-Warning+, 3-Info+, 4-Debug+.",   false, false, "1"   },
+    {"-font",   "", validate_file,      "-font=fullPathToFontFile", "Font file to bake (required).",                                 true,  false, NULL  },
+    {"-size",   "", validate_number,    "[-size=points]",         "Char size in points (optional). Default: 16, as bgr uses.",     false, false, "16"  },
+    {"-dpi",    "", validate_number,    "-dpi=dpi",               "Target display DPI (required): \"Display DPI\" in bgr -v=3.",    true,  false, NULL  },
+    {"-chars",  "", validate_file,      "[-chars=\"characters\"]", "Characters to bake (optional). Default: printable ASCII.",     false, false, NULL  },
+    {"-out",    "", validate_file,      "-out=atlasFile.fra",     "Output atlas file (required).",                                 true,  false, NULL  }
+};
+
+
+static int compareCharCode(const void *a, const void *b) {
+    unsigned long ca = *(const unsigned long *)a;
+    unsigned long cb = *(const unsigned long *)b;
+
+    return (ca > cb) - (ca < cb);
+}
+
+int main(int argc, char *argv[]) {
+    char fontFile[PARAM_MAX_LENGTH];
+    char outFile[PARAM_MAX_LENGTH];
+    char chars[PARAM_MAX_LENGTH];
+    char tmpParamStr[PARAM_MAX_LENGTH];
+    unsigned long charCodes[MAX_ATLAS_GLYPHS];
+    fr_atlasGlyph glyphs[MAX_ATLAS_GLYPHS];
+    fr_atlasHeader header;
+    unsigned char *data = NULL;
+    size_t dataSize = 0;
+    int charCount = 0;
+    int pointSize, dpi;
+    FT_Library library;
+    FT_Face face;
+    FILE *out;
+    int i, row;
+
+    log_init(LOG_ERROR);
+
+    if (parse_arguments(argc, argv, PARAM_COUNT, params) != PARSE_SUCCESS) {
+        print_usage("ftBakeAtlas", PARAM_COUNT, params);
+        return -1;
+    }
+    getParamValueByIndex(PARAM_FONT, PARAM_COUNT, params, fontFile);
+    getParamValueByIndex(PARAM_OUT, PARAM_COUNT, params, outFile);
+    getParamValueByIndex(PARAM_SIZE, PARAM_COUNT, params, tmpParamStr);
+    pointSize = atoi(tmpParamStr);
+    getParamValueByIndex(PARAM_DPI, PARAM_COUNT, params, tmpParamStr);
+    dpi = atoi(tmpParamStr);
+
+    // Character set: unique codes, sorted as the renderer binary-searches them
+    if (params[PARAM_CHARS].was_passed) {
+        getParamValueByIndex(PARAM_CHARS, PARAM_COUNT, params, chars);
+        for (i = 0; chars[i] && (charCount < MAX_ATLAS_GLYPHS); i++) {
+            charCodes[charCount++] = (unsigned char)chars[i];
+        }
+    } else {
+        for (i = 32; i < 127; i++) {
+            charCodes[charCount++] = i;
+        }
+    }
+    qsort(charCodes, charCount, sizeof(charCodes[0]), compareCharCode);
+    for (i = 1; i < charCount; i++) {
+        if (charCodes[i] == charCodes[i - 1]) {
+            memmove(&charCodes[i], &charCodes[i + 1], (charCount - i - 1) * sizeof(charCodes[0]));
+            charCount--;
+            i--;
+        }
+    }
+
+    if (FT_Init_FreeType(&library) || FT_New_Face(library, fontFile, 0, &face)) {
+        log_message(LOG_ERROR, "Cannot open font %s", fontFile);
+        return -1;
+    }
+    // Same call as ftInitFont(), so glyphs come out identical to live rendering
+    if (FT_Set_Char_Size(face, pointSize * 64, pointSize * 64, dpi, dpi)) {
+        log_message(LOG_ERROR, "FT_Set_Char_Size(%d, %d) failed", pointSize, dpi);
+        return -1;
+    }
+
+    for (i = 0; i < charCount; i++) {
+        FT_GlyphSlot slot;
+        size_t glyphSize;
+
+        if (FT_Load_Char(face, charCodes[i], FT_LOAD_RENDER)) {
+            log_message(LOG_ERROR, "FT_Load_Char(0x%lx) failed", charCodes[i]);
+            return -1;
+        }
+        slot = face->glyph;
+        glyphSize = (size_t)slot->bitmap.width * slot->bitmap.rows;
+
+        glyphs[i].charCode = charCodes[i];
+        glyphs[i].bitmapLeft = slot->bitmap_left;
+        glyphs[i].bitmapTop = slot->bitmap_top;
+        glyphs[i].width = slot->bitmap.width;
+        glyphs[i].rows = slot->bitmap.rows;
+        glyphs[i].advanceX = slot->advance.x;
+        glyphs[i].advanceY = slot->advance.y;
+        glyphs[i].offset = dataSize;
+
+        data = realloc(data, dataSize + glyphSize + 1);
+        if (data == NULL) {
+            log_message(LOG_ERROR, "Memory allocation failed");
+            return -1;
+        }
+        for (row = 0; row < slot->bitmap.rows; row++) {
+            const unsigned char *srcRow = (slot->bitmap.pitch >= 0) ? slot->bitmap.buffer + row * slot->bitmap.pitch
+                                                                    : slot->bitmap.buffer + (slot->bitmap.rows - 1 - row) * (-slot->bitmap.pitch);
+            memcpy(data + dataSize + row * slot->bitmap.width, srcRow, slot->bitmap.width);
+        }
+        dataSize += glyphSize;
+        log_message(LOG_DEBUG, "'%c': %dx%d left:%d top:%d adv:%ld", (int)charCodes[i], glyphs[i].width, glyphs[i].rows, glyphs[i].bitmapLeft, glyphs[i].bitmapTop, slot->advance.x);
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = FR_ATLAS_MAGIC;
+    header.version = FR_ATLAS_VERSION;
+    header.pointSize = pointSize;
+    header.dpi = dpi;
+    header.glyphCount = charCount;
+    header.dataOffset = sizeof(header) + charCount * sizeof(fr_atlasGlyph);
+    header.fileSize = header.dataOffset + dataSize;
+
+    out = fopen(outFile, "wb");
+    if (out == NULL) {
+        log_message(LOG_ERROR, "Cannot create %s", outFile);
+        return -1;
+    }
+    if ((fwrite(&header, sizeof(header), 1, out) != 1) ||
+        (fwrite(glyphs, sizeof(fr_atlasGlyph), charCount, out) != (size_t)charCount) ||
+        ((dataSize > 0) && (fwrite(data, dataSize, 1, out) != 1))) {
+        log_message(LOG_ERROR, "Writing %s failed", outFile);
+        fclose(out);
+        return -1;
+    }
+    fclose(out);
+    printf("%s: %d glyphs, %dpt @ %ddpi, %u bytes\n", outFile, charCount, pointSize, dpi, header.fileSize);
+
+    free(data);
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+    return 0;
+}